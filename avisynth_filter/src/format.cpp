@@ -26,6 +26,11 @@ const std::vector<Format::PixelFormat> Format::PIXEL_FORMATS {
     { .name = L"YUY2",  .mediaSubtype = MEDIASUBTYPE_YUY2,  .frameServerFormatId = VideoInfo::CS_YUY2,      .bitCount = 16, .componentsPerPixel = 2, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_YUY2 },
     { .name = L"P210",  .mediaSubtype = MEDIASUBTYPE_P210,  .frameServerFormatId = VideoInfo::CS_YUV422P10, .bitCount = 32, .componentsPerPixel = 1, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED, .resourceId = IDC_INPUT_FORMAT_P210 },
     { .name = L"P216",  .mediaSubtype = MEDIASUBTYPE_P216,  .frameServerFormatId = VideoInfo::CS_YUV422P16, .bitCount = 32, .componentsPerPixel = 1, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED, .resourceId = IDC_INPUT_FORMAT_P216 },
+    // Y210 and Y216 interleave Y and UV planes together like YUY2. Y210 has the least significant 6 bits zero-padded like P010
+    { .name = L"Y210",  .mediaSubtype = MEDIASUBTYPE_Y210,  .frameServerFormatId = VideoInfo::CS_YUV422P10, .bitCount = 32, .componentsPerPixel = 2, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_Y210 },
+    { .name = L"Y216",  .mediaSubtype = MEDIASUBTYPE_Y216,  .frameServerFormatId = VideoInfo::CS_YUV422P16, .bitCount = 32, .componentsPerPixel = 2, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_Y216 },
+    // v210 packs three 10-bit components in each 32-bit integer, with each row padded to 48 pixels. bitCount is 20 by convention, not the actual size
+    { .name = L"v210",  .mediaSubtype = MEDIASUBTYPE_v210,  .frameServerFormatId = VideoInfo::CS_YUV422P10, .bitCount = 20, .componentsPerPixel = 2, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_V210 },
 
     // 4:4:4
     { .name = L"YV24",  .mediaSubtype = MEDIASUBTYPE_YV24,  .frameServerFormatId = VideoInfo::CS_YV24,      .bitCount = 24, .componentsPerPixel = 1, .subsampleWidthRatio = 1,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_SEPARATE,           .resourceId = IDC_INPUT_FORMAT_YV24 },
@@ -36,7 +41,10 @@ const std::vector<Format::PixelFormat> Format::PIXEL_FORMATS {
     // RGB
     { .name = L"RGB24", .mediaSubtype = MEDIASUBTYPE_RGB24, .frameServerFormatId = VideoInfo::CS_BGR24,     .bitCount = 24, .componentsPerPixel = 3, .subsampleWidthRatio = -1, .subsampleHeightRatio = -1, .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_RGB24 },
     { .name = L"RGB32", .mediaSubtype = MEDIASUBTYPE_RGB32, .frameServerFormatId = VideoInfo::CS_BGR32,     .bitCount = 32, .componentsPerPixel = 4, .subsampleWidthRatio = -1, .subsampleHeightRatio = -1, .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_RGB32 },
-    // RGB48 from LAV Filters outputs R-G-B pixel order while AviSynth+ expects B-G-R
+    // RGB48 and RGB64 from LAV Filters have R-G-B pixel order while AviSynth+ packed RGB expects B-G-R
+    // Therefore, they are unpacked into planar RGB, which reorders the components for free. Like Y41x, the alpha of RGB64 is ignored
+    { .name = L"RGB48", .mediaSubtype = MEDIASUBTYPE_RGB48, .frameServerFormatId = VideoInfo::CS_RGBP16,    .bitCount = 48, .componentsPerPixel = 3, .subsampleWidthRatio = -1, .subsampleHeightRatio = -1, .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_RGB48 },
+    { .name = L"RGB64", .mediaSubtype = MEDIASUBTYPE_RGB64, .frameServerFormatId = VideoInfo::CS_RGBP16,    .bitCount = 64, .componentsPerPixel = 4, .subsampleWidthRatio = -1, .subsampleHeightRatio = -1, .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_RGB64 },
 };
 
 auto Format::GetVideoFormat(const AM_MEDIA_TYPE &mediaType, const FrameServerBase *frameServerInstance) -> VideoFormat {
@@ -54,7 +62,6 @@ auto Format::GetVideoFormat(const AM_MEDIA_TYPE &mediaType, const FrameServerBas
             .pixel_type = ret.pixelFormat->frameServerFormatId,
         },
         .bmi = *GetBitmapInfo(mediaType),
-        .outputBufferTemporalFlags = ret.pixelFormat->srcPlanesLayout == PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED && ret.videoInfo.BitsPerComponent() == 10,
     };
 
     if (SUCCEEDED(CheckVideoInfo2Type(&mediaType))) {
@@ -76,6 +83,8 @@ auto Format::GetVideoFormat(const AM_MEDIA_TYPE &mediaType, const FrameServerBas
         }
     }
 
+    ret.conversionPlan = CreateConversionPlan(ret);
+
     return ret;
 }
 
@@ -83,7 +92,9 @@ auto Format::WriteSample(const VideoFormat &videoFormat, const PVideoFrame &srcF
     const std::array srcSlices { srcFrame->GetReadPtr(PLANAR_Y), srcFrame->GetReadPtr(PLANAR_U), srcFrame->GetReadPtr(PLANAR_V) };
     const std::array srcStrides { srcFrame->GetPitch(PLANAR_Y), srcFrame->GetPitch(PLANAR_U), srcFrame->GetPitch(PLANAR_V) };
 
-    CopyToOutput(videoFormat, srcSlices, srcStrides, dstBuffer, srcFrame->GetRowSize(), srcFrame->GetHeight());
+    ASSERT(srcFrame->GetHeight() == videoFormat.conversionPlan.height);
+
+    CopyToOutput(videoFormat, srcSlices, srcStrides, dstBuffer);
 }
 
 auto Format::CreateFrame(const VideoFormat &videoFormat, const BYTE *srcBuffer) -> PVideoFrame {
@@ -92,168 +103,129 @@ auto Format::CreateFrame(const VideoFormat &videoFormat, const BYTE *srcBuffer)
     const std::array dstSlices { newFrame->GetWritePtr(PLANAR_Y), newFrame->GetWritePtr(PLANAR_U), newFrame->GetWritePtr(PLANAR_V) };
     const std::array dstStrides { newFrame->GetPitch(PLANAR_Y), newFrame->GetPitch(PLANAR_U), newFrame->GetPitch(PLANAR_V) };
 
-    CopyFromInput(videoFormat, srcBuffer, dstSlices, dstStrides, newFrame->GetRowSize(), newFrame->GetHeight());
+    CopyFromInput(videoFormat, srcBuffer, dstSlices, dstStrides);
 
     return newFrame;
 }
 
-auto Format::CopyFromInput(const VideoFormat &videoFormat, const BYTE *srcBuffer, const std::array<BYTE *, 3> &dstSlices, const std::array<int, 3> &dstStrides, int frameWidth, int height) -> void {
-    const int srcMainPlaneRowSize = frameWidth;
-    // bmi.biWidth should be "set equal to the surface stride in pixels" according to the doc of BITMAPINFOHEADER
-    int srcMainPlaneStride = videoFormat.bmi.biWidth * videoFormat.videoInfo.ComponentSize() * videoFormat.pixelFormat->componentsPerPixel;
-    ASSERT(srcMainPlaneRowSize <= srcMainPlaneStride);
-    ASSERT(height == abs(videoFormat.bmi.biHeight));
-    const int srcMainPlaneSize = srcMainPlaneStride * height;
-    const BYTE *srcMainPlane = srcBuffer;
-    const int srcUVHeight = height / videoFormat.pixelFormat->subsampleHeightRatio;
+auto Format::CreateConversionPlan(const VideoFormat &videoFormat) -> ConversionPlan {
+    const PixelFormat &pixelFormat = *videoFormat.pixelFormat;
+    const int componentSize = videoFormat.videoInfo.ComponentSize();
+
+    ConversionPlan plan {
+        .height = videoFormat.videoInfo.height,
+        .secPlaneHeightRatio = std::max(pixelFormat.subsampleHeightRatio, 1),
+    };
+    plan.bandHeight = GetBandHeight(videoFormat.bmi, plan.height, plan.secPlaneHeightRatio);
+
+    // interleaved formats store all components of a pixel in the main plane
+    const int mainPlaneBytesPerPixel = pixelFormat.srcPlanesLayout == PlanesLayout::ALL_PLANES_INTERLEAVED ? pixelFormat.bitCount / 8 : componentSize;
+    if (pixelFormat.mediaSubtype == MEDIASUBTYPE_v210) {
+        // v210 takes 16 bytes for every 6 pixels, and pads each row to 48 pixels
+        plan.mainPlaneStride = DivideRoundUp(videoFormat.bmi.biWidth, 48) * 128;
+        plan.mainPlaneRowSize = DivideRoundUp(videoFormat.videoInfo.width * 8, 3);
+    } else {
+        // bmi.biWidth should be "set equal to the surface stride in pixels" according to the doc of BITMAPINFOHEADER
+        plan.mainPlaneStride = videoFormat.bmi.biWidth * mainPlaneBytesPerPixel;
+        plan.mainPlaneRowSize = videoFormat.videoInfo.width * mainPlaneBytesPerPixel;
+    }
+    ASSERT(plan.mainPlaneRowSize <= plan.mainPlaneStride);
+    const int mainPlaneSize = plan.mainPlaneStride * plan.height;
 
     // for RGB DIB in Windows (biCompression == BI_RGB), positive biHeight is bottom-up, negative is top-down
     // AviSynth+'s conversion functions assume input DIB being bottom-up, so we invert the DIB if it's needed
     if (videoFormat.bmi.biCompression == BI_RGB && videoFormat.bmi.biHeight < 0) {
-        srcMainPlane += static_cast<size_t>(srcMainPlaneSize) - srcMainPlaneStride;
-        srcMainPlaneStride = -srcMainPlaneStride;
+        plan.mainPlaneOffset = static_cast<ptrdiff_t>(mainPlaneSize) - plan.mainPlaneStride;
+        plan.mainPlaneStride = -plan.mainPlaneStride;
     }
 
-    if ((videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::ALL_PLANES_INTERLEAVED && videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_INTERLEAVED) ||
-        (videoFormat.pixelFormat->srcPlanesLayout != PlanesLayout::ALL_PLANES_INTERLEAVED && videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_PLANAR)) {
-        AVSF_AVS_API->BitBlt(dstSlices[0], dstStrides[0], srcMainPlane, srcMainPlaneStride, srcMainPlaneRowSize, height);
-    }
+    // P010 and P210 have their bits shifted while being copied
+    const bool isBitShiftNeeded = pixelFormat.srcPlanesLayout == PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED && videoFormat.videoInfo.BitsPerComponent() == 10;
+    plan.mainPlaneInputFunc = isBitShiftNeeded ? _rightShiftFunc : GetCopyPlaneFunc(mainPlaneSize);
+    plan.mainPlaneOutputFunc = isBitShiftNeeded ? _leftShiftFunc : GetCopyPlaneFunc(mainPlaneSize);
 
-    switch (videoFormat.pixelFormat->srcPlanesLayout) {
+    switch (pixelFormat.srcPlanesLayout) {
     case PlanesLayout::ALL_PLANES_INTERLEAVED:
-        if (videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_PLANAR) {
-            const std::array yuvaSlices { dstSlices[1], dstSlices[0], dstSlices[2] };
-            const std::array yuvaStrides { dstStrides[1], dstStrides[0], dstStrides[2] };
-
-            if (videoFormat.videoInfo.BitsPerComponent() == 10) {
-                DeinterleaveY410(srcMainPlane, srcMainPlaneStride / 2, yuvaSlices, yuvaStrides, srcMainPlaneRowSize * 2, height);
+        // formats that AviSynth+ takes as interleaved are copied as is, the rest are unpacked into the Y, U and V planes, or the G, B and R planes
+        if (pixelFormat.frameServerFormatId & VideoInfo::CS_PLANAR) {
+            if (videoFormat.videoInfo.IsRGB()) {
+                // R-G-B to the G, B and R planes
+                plan.componentPlanes = { 2, 0, 1 };
+            } else if (videoFormat.videoInfo.Is422()) {
+                // the 4:2:2 formats are unpacked to the Y, U and V planes directly
+                plan.componentPlanes = { 0, 1, 2 };
             } else {
-                _deinterleaveY416Func(srcMainPlane, srcMainPlaneStride, yuvaSlices, yuvaStrides, srcMainPlaneRowSize * 4, height);
+                plan.componentPlanes = { 1, 0, 2 };
             }
-        }
-        break;
-
-    case PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED: {
-        const BYTE *srcUVStart = srcMainPlane + srcMainPlaneSize;
-        const int srcUVStride = srcMainPlaneStride * 2 / videoFormat.pixelFormat->subsampleWidthRatio;
-        const int srcUVRowSize = srcMainPlaneRowSize * 2 / videoFormat.pixelFormat->subsampleWidthRatio;
-
-        decltype(Deinterleave<0, 1, 2, 2, 1>) *deinterleaveUVFunc;
-        if (videoFormat.videoInfo.ComponentSize() == 1) {
-            deinterleaveUVFunc = _deinterleaveUVC1Func;
-        } else {
-            deinterleaveUVFunc = _deinterleaveUVC2Func;
-        }
-        deinterleaveUVFunc(srcUVStart, srcUVStride, { dstSlices[1], dstSlices[2] }, { dstStrides[1], dstStrides[2] }, srcUVRowSize, srcUVHeight);
-
-        if (videoFormat.videoInfo.BitsPerComponent() == 10) {
-            _rightShiftFunc(dstSlices[0], dstSlices[0], dstStrides[0], srcMainPlaneRowSize, height);
-            _rightShiftFunc(dstSlices[1], dstSlices[1], dstStrides[1], srcUVRowSize / 2, srcUVHeight);
-            _rightShiftFunc(dstSlices[2], dstSlices[2], dstStrides[2], srcUVRowSize / 2, srcUVHeight);
-        }
-    } break;
 
-    case PlanesLayout::ALL_PLANES_SEPARATE: {
-        const int srcUVRowSize = srcMainPlaneRowSize / videoFormat.pixelFormat->subsampleWidthRatio;
-        const int srcUVStride = srcMainPlaneStride / videoFormat.pixelFormat->subsampleWidthRatio;
-        const BYTE *srcUVPlane1 = srcMainPlane + srcMainPlaneSize;
-        const BYTE *srcUVPlane2 = srcUVPlane1 + srcMainPlaneSize / (videoFormat.pixelFormat->subsampleWidthRatio * videoFormat.pixelFormat->subsampleHeightRatio);
-
-        const BYTE *srcU;
-        const BYTE *srcV;
-        if (videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_VPlaneFirst) {
-            srcU = srcUVPlane2;
-            srcV = srcUVPlane1;
-        } else {
-            srcU = srcUVPlane1;
-            srcV = srcUVPlane2;
-        }
-
-        AVSF_AVS_API->BitBlt(dstSlices[1], dstStrides[1], srcU, srcUVStride, srcUVRowSize, srcUVHeight);
-        AVSF_AVS_API->BitBlt(dstSlices[2], dstStrides[2], srcV, srcUVStride, srcUVRowSize, srcUVHeight);
-    } break;
-    }
-}
-
-auto Format::CopyToOutput(const VideoFormat &videoFormat, const std::array<const BYTE *, 3> &srcSlices, const std::array<int, 3> &srcStrides, BYTE *dstBuffer, int frameWidth, int height) -> void {
-    const int dstMainPlaneRowSize = frameWidth;
-    int dstMainPlaneStride = videoFormat.bmi.biWidth * videoFormat.videoInfo.ComponentSize() * videoFormat.pixelFormat->componentsPerPixel;
-    ASSERT(dstMainPlaneRowSize <= dstMainPlaneStride);
-    ASSERT(height >= abs(videoFormat.bmi.biHeight));
-    const int dstMainPlaneSize = dstMainPlaneStride * height;
-    const int dstUVHeight = height / videoFormat.pixelFormat->subsampleHeightRatio;
-
-    BYTE *intermediateDstBufferBase = dstBuffer;
-    if (videoFormat.outputBufferTemporalFlags == 0b111) {
-        intermediateDstBufferBase = reinterpret_cast<BYTE *>(CoTaskMemAlloc(videoFormat.bmi.biSizeImage));
-    }
-    BYTE *dstMainPlane = intermediateDstBufferBase;
-
-    if (videoFormat.bmi.biCompression == BI_RGB && videoFormat.bmi.biHeight < 0) {
-        dstMainPlane += static_cast<size_t>(dstMainPlaneSize) - dstMainPlaneStride;
-        dstMainPlaneStride = -dstMainPlaneStride;
-    }
-
-    if ((videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::ALL_PLANES_INTERLEAVED && videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_INTERLEAVED) ||
-        (videoFormat.pixelFormat->srcPlanesLayout != PlanesLayout::ALL_PLANES_INTERLEAVED && videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_PLANAR)) {
-        AVSF_AVS_API->BitBlt(dstMainPlane, dstMainPlaneStride, srcSlices[0], srcStrides[0], dstMainPlaneRowSize, height);
-    }
-
-    switch (videoFormat.pixelFormat->srcPlanesLayout) {
-    case PlanesLayout::ALL_PLANES_INTERLEAVED:
-        if (videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_PLANAR) {
-            const std::array yuvaSlices { srcSlices[1], srcSlices[0], srcSlices[2] };
-            const std::array yuvaStrides { srcStrides[1], srcStrides[0], srcStrides[2] };
-
-            if (videoFormat.videoInfo.BitsPerComponent() == 10) {
-                InterleaveY410(yuvaSlices, yuvaStrides, dstMainPlane, dstMainPlaneStride / 2, dstMainPlaneRowSize * 2, height);
+            if (pixelFormat.mediaSubtype == MEDIASUBTYPE_Y210) {
+                plan.deinterleaveFunc = _deinterleaveY210Func;
+                plan.interleaveThreeFunc = _interleaveY210Func;
+            } else if (pixelFormat.mediaSubtype == MEDIASUBTYPE_Y216) {
+                plan.deinterleaveFunc = _deinterleaveY216Func;
+                plan.interleaveThreeFunc = _interleaveY216Func;
+            } else if (pixelFormat.mediaSubtype == MEDIASUBTYPE_v210) {
+                plan.deinterleaveFunc = _deinterleaveV210Func;
+                plan.interleaveThreeFunc = _interleaveV210Func;
+            } else if (pixelFormat.componentsPerPixel == 3) {
+                plan.deinterleaveFunc = _deinterleaveRGB48Func;
+                plan.interleaveThreeFunc = _interleaveRGB48Func;
+            } else if (videoFormat.videoInfo.BitsPerComponent() == 10) {
+                plan.deinterleaveFunc = _deinterleaveY410Func;
+                plan.interleaveThreeFunc = _interleaveY410Func;
             } else {
-                _interleaveY416Func(yuvaSlices, yuvaStrides, dstMainPlane, dstMainPlaneStride, dstMainPlaneRowSize * 4, height);
+                plan.deinterleaveFunc = _deinterleaveY416Func;
+                plan.interleaveThreeFunc = _interleaveY416Func;
             }
         }
-        break;
 
-    case PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED: {
-        const int dstUVRowSize = dstMainPlaneRowSize * 2 / videoFormat.pixelFormat->subsampleWidthRatio;
-        BYTE *dstUVStart = dstMainPlane + dstMainPlaneSize;
-        const int dstUVStride = dstMainPlaneStride * 2 / videoFormat.pixelFormat->subsampleWidthRatio;
+        plan.copyFromInputBandFunc = CopyFromInputBand<PlanesLayout::ALL_PLANES_INTERLEAVED>;
+        plan.copyToOutputBandFunc = CopyToOutputBand<PlanesLayout::ALL_PLANES_INTERLEAVED>;
+        break;
 
-        decltype(InterleaveUV<0, 1>) *interleaveUVFunc;
-        if (videoFormat.videoInfo.ComponentSize() == 1) {
-            interleaveUVFunc = _interleaveUVC1Func;
+    case PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED:
+        plan.secPlaneStride = plan.mainPlaneStride * 2 / pixelFormat.subsampleWidthRatio;
+        plan.secPlaneRowSize = plan.mainPlaneRowSize * 2 / pixelFormat.subsampleWidthRatio;
+        plan.secPlaneOffsets = { mainPlaneSize, 0 };
+
+        if (componentSize == 1) {
+            plan.deinterleaveFunc = _deinterleaveUVC1Func;
+            plan.interleaveUVFunc = _interleaveUVC1Func;
+        } else if (isBitShiftNeeded) {
+            plan.deinterleaveFunc = _deinterleaveUVC2RightShiftFunc;
+            plan.interleaveUVFunc = _interleaveUVC2LeftShiftFunc;
         } else {
-            interleaveUVFunc = _interleaveUVC2Func;
+            plan.deinterleaveFunc = _deinterleaveUVC2Func;
+            plan.interleaveUVFunc = _interleaveUVC2Func;
         }
-        interleaveUVFunc(srcSlices[1], srcSlices[2], srcStrides[1], srcStrides[2], dstUVStart, dstUVStride, dstUVRowSize, dstUVHeight);
 
-        if (videoFormat.videoInfo.BitsPerComponent() == 10) {
-            _leftShiftFunc(dstMainPlane, dstBuffer, dstMainPlaneStride, dstMainPlaneRowSize, height + dstUVHeight);
-            if (videoFormat.outputBufferTemporalFlags == 0b111) {
-                CoTaskMemFree(intermediateDstBufferBase);
-            }
-        }
-    } break;
+        plan.copyFromInputBandFunc = CopyFromInputBand<PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED>;
+        plan.copyToOutputBandFunc = CopyToOutputBand<PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED>;
+        break;
 
     case PlanesLayout::ALL_PLANES_SEPARATE: {
-        const int dstUVRowSize = dstMainPlaneRowSize / videoFormat.pixelFormat->subsampleWidthRatio;
-        BYTE *dstUVPlane1 = dstMainPlane + dstMainPlaneSize;
-        BYTE *dstUVPlane2 = dstUVPlane1 + dstMainPlaneSize / (videoFormat.pixelFormat->subsampleWidthRatio * videoFormat.pixelFormat->subsampleHeightRatio);
-        const int dstUVStride = dstMainPlaneStride / videoFormat.pixelFormat->subsampleWidthRatio;
-
-        BYTE *dstU;
-        BYTE *dstV;
-        if (videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_VPlaneFirst) {
-            dstU = dstUVPlane2;
-            dstV = dstUVPlane1;
+        plan.secPlaneStride = plan.mainPlaneStride / pixelFormat.subsampleWidthRatio;
+        plan.secPlaneRowSize = plan.mainPlaneRowSize / pixelFormat.subsampleWidthRatio;
+
+        const ptrdiff_t secPlane1Offset = mainPlaneSize;
+        const ptrdiff_t secPlane2Offset = secPlane1Offset + mainPlaneSize / (pixelFormat.subsampleWidthRatio * pixelFormat.subsampleHeightRatio);
+        if (pixelFormat.frameServerFormatId & VideoInfo::CS_VPlaneFirst) {
+            plan.secPlaneOffsets = { secPlane2Offset, secPlane1Offset };
         } else {
-            dstU = dstUVPlane1;
-            dstV = dstUVPlane2;
+            plan.secPlaneOffsets = { secPlane1Offset, secPlane2Offset };
         }
+        plan.secPlaneCopyFunc = GetCopyPlaneFunc(plan.secPlaneStride * (plan.height / pixelFormat.subsampleHeightRatio));
 
-        AVSF_AVS_API->BitBlt(dstU, dstUVStride, srcSlices[1], srcStrides[1], dstUVRowSize, dstUVHeight);
-        AVSF_AVS_API->BitBlt(dstV, dstUVStride, srcSlices[2], srcStrides[2], dstUVRowSize, dstUVHeight);
+        plan.copyFromInputBandFunc = CopyFromInputBand<PlanesLayout::ALL_PLANES_SEPARATE>;
+        plan.copyToOutputBandFunc = CopyToOutputBand<PlanesLayout::ALL_PLANES_SEPARATE>;
     } break;
     }
+
+    return plan;
+}
+
+auto Format::CopyPlane(const BYTE *src, BYTE *dst, int srcStride, int dstStride, int rowSize, int height) -> void {
+    AVSF_AVS_API->BitBlt(dst, dstStride, src, srcStride, rowSize, height);
 }
 
 }
\ No newline at end of file
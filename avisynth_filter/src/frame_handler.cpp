@@ -11,50 +11,59 @@ namespace SynthFilter {
 auto FrameHandler::AddInputSample(IMediaSample *inputSample) -> HRESULT {
     HRESULT hr;
 
-    _addInputSampleCv.wait(_filter.m_csReceive, [this]() -> bool {
+    const std::chrono::steady_clock::time_point waitStartTime = std::chrono::steady_clock::now();
+    if (_lastInputSampleReturnTime.time_since_epoch().count() != 0) {
+        _sourceBufferController.RecordDecoderLatency(waitStartTime - _lastInputSampleReturnTime);
+    }
+
+    _sourceFrames.WaitUntil(_filter.m_csReceive, [this]() -> bool {
         if (_isFlushing) {
             return true;
         }
 
-        if (_nextSourceFrameNb <= Environment::GetInstance().GetInitialSrcBuffer()) {
+        if (GetNumInFlightSourceFrames() >= static_cast<int>(SOURCE_FRAME_RING_CAPACITY)) {
+            return false;
+        }
+
+        if (_nextSourceFrameNb - _firstSourceFrameNb <= Environment::GetInstance().GetInitialSrcBuffer()) {
             return true;
         }
 
         UpdateExtraSrcBuffer();
 
         // at least NUM_SRC_FRAMES_PER_PROCESSING source frames are needed in queue for stop time calculation
-        if (static_cast<int>(_sourceFrames.size()) < NUM_SRC_FRAMES_PER_PROCESSING + _extraSrcBuffer) {
+        if (GetNumInFlightSourceFrames() < NUM_SRC_FRAMES_PER_PROCESSING + _extraSrcBuffer) {
             return true;
         }
 
         return _nextSourceFrameNb <= _maxRequestedFrameNb;
     });
+    RecordStageLatency(PipelineStage::UpstreamWait, waitStartTime);
 
     if (_isFlushing || _isStopping) {
-        Environment::GetInstance().Log(L"Reject input sample due to flush or stop");
+        Environment::GetInstance().Log<LogLevel::Trace>(L"Reject input sample due to flush or stop");
         return S_FALSE;
     }
 
-    if ((_filter._isInputMediaTypeChanged || _filter._needReloadScript) && !ChangeOutputFormat()) {
-        return S_FALSE;
+    if (_filter._isInputMediaTypeChanged || _filter._needReloadScript) {
+        // the queued samples are converted with the current format and script
+        WaitForInputConversion();
+
+        if (!ChangeOutputFormat()) {
+            return S_FALSE;
+        }
     }
 
     REFERENCE_TIME inputSampleStartTime;
     REFERENCE_TIME inputSampleStopTime = 0;
     if (inputSample->GetTime(&inputSampleStartTime, &inputSampleStopTime) == VFW_E_SAMPLE_TIME_NOT_SET) {
         // for samples without start time, always treat as fixed frame rate
-        inputSampleStartTime = _nextSourceFrameNb * MainFrameServer::GetInstance().GetSourceAvgFrameDuration();
+        inputSampleStartTime = (_nextSourceFrameNb - _firstSourceFrameNb) * MainFrameServer::GetInstance().GetSourceAvgFrameDuration();
     }
 
-    {
-        const std::shared_lock sharedSourceLock(_sourceMutex);
-
-        // since the key of _sourceFrames is frame number, which only strictly increases, rbegin() returns the last emplaced frame
-        if (const REFERENCE_TIME lastSampleStartTime = _sourceFrames.empty() ? -1 : _sourceFrames.rbegin()->second.startTime;
-            inputSampleStartTime <= lastSampleStartTime) {
-            Environment::GetInstance().Log(L"Reject input sample due to start time going backward: curr %10lld last %10lld", inputSampleStartTime, lastSampleStartTime);
-            return S_FALSE;
-        }
+    if (inputSampleStartTime <= _lastInputSampleStartTime) {
+        Environment::GetInstance().Log<LogLevel::Error>(L"Reject input sample due to start time going backward: curr %10lld last %10lld", inputSampleStartTime, _lastInputSampleStartTime);
+        return S_FALSE;
     }
 
     RefreshInputFrameRates(_nextSourceFrameNb);
@@ -65,12 +74,39 @@ auto FrameHandler::AddInputSample(IMediaSample *inputSample) -> HRESULT {
         return S_FALSE;
     }
 
-    PVideoFrame frame = Format::CreateFrame(_filter._inputVideoFormat, sampleBuffer);
+    {
+        const std::unique_lock inputQueueLock(_inputQueueMutex);
+
+        // the queue holds a reference to the sample, so that the upstream does not reuse its buffer until it is converted
+        _queuedInputSamples.emplace_back(inputSample,
+                                         sampleBuffer,
+                                         _nextSourceFrameNb,
+                                         inputSampleStartTime,
+                                         inputSampleStopTime,
+                                         _filter.m_pInput->SampleProps()->dwTypeSpecificFlags,
+                                         std::chrono::steady_clock::now());
+    }
+    _inputQueueCv.notify_all();
+
+    _lastInputSampleStartTime = inputSampleStartTime;
+    _nextSourceFrameNb += 1;
+    _lastInputSampleReturnTime = std::chrono::steady_clock::now();
+
+    return S_OK;
+}
+
+auto FrameHandler::ConvertInputSample(const QueuedInputSample &queuedSample) -> void {
+    Environment::GetInstance().TraceAsync("Conversion queue", queuedSample.frameNb, queuedSample.receiveTime);
+
+    const std::chrono::steady_clock::time_point createFrameStartTime = std::chrono::steady_clock::now();
+    PVideoFrame frame = Format::CreateFrame(_filter._inputVideoFormat, queuedSample.buffer);
+    RecordStageLatency(PipelineStage::CreateFrame, createFrameStartTime);
+    Environment::GetInstance().TraceComplete("CreateFrame", queuedSample.frameNb, createFrameStartTime);
 
     if (FrameServerCommon::GetInstance().IsFramePropsSupported()) {
         AVSMap *frameProps = AVSF_AVS_API->getFramePropsRW(frame);
 
-        AVSF_AVS_API->propSetFloat(frameProps, FRAME_PROP_NAME_ABS_TIME, inputSampleStartTime / static_cast<double>(UNITS), PROPAPPENDMODE_REPLACE);
+        AVSF_AVS_API->propSetFloat(frameProps, FRAME_PROP_NAME_ABS_TIME, queuedSample.startTime / static_cast<double>(UNITS), PROPAPPENDMODE_REPLACE);
         AVSF_AVS_API->propSetInt(frameProps, "_SARNum", _filter._inputVideoFormat.pixelAspectRatioNum, PROPAPPENDMODE_REPLACE);
         AVSF_AVS_API->propSetInt(frameProps, "_SARDen", _filter._inputVideoFormat.pixelAspectRatioDen, PROPAPPENDMODE_REPLACE);
 
@@ -81,12 +117,11 @@ auto FrameHandler::AddInputSample(IMediaSample *inputSample) -> HRESULT {
         AVSF_AVS_API->propSetInt(frameProps, "_Matrix", _filter._inputVideoFormat.colorSpaceInfo.matrix, PROPAPPENDMODE_REPLACE);
         AVSF_AVS_API->propSetInt(frameProps, "_Transfer", _filter._inputVideoFormat.colorSpaceInfo.transfer, PROPAPPENDMODE_REPLACE);
 
-        const DWORD typeSpecificFlags = _filter.m_pInput->SampleProps()->dwTypeSpecificFlags;
         // C++ lacks if-expression, so use IIFE to simulate
         const int rfpFieldBased = [&]() {
-            if (typeSpecificFlags & AM_VIDEO_FLAG_WEAVE) {
+            if (queuedSample.typeSpecificFlags & AM_VIDEO_FLAG_WEAVE) {
                 return VSFieldBased::VSC_FIELD_PROGRESSIVE;
-            } else if (typeSpecificFlags & AM_VIDEO_FLAG_FIELD1FIRST) {
+            } else if (queuedSample.typeSpecificFlags & AM_VIDEO_FLAG_FIELD1FIRST) {
                 return VSFieldBased::VSC_FIELD_TOP;
             } else {
                 return VSFieldBased::VSC_FIELD_BOTTOM;
@@ -97,7 +132,7 @@ auto FrameHandler::AddInputSample(IMediaSample *inputSample) -> HRESULT {
 
     std::unique_ptr<HDRSideData> hdrSideData = std::make_unique<HDRSideData>();
     {
-        if (const ATL::CComQIPtr<IMediaSideData> inputSampleSideData(inputSample); inputSampleSideData != nullptr) {
+        if (const ATL::CComQIPtr<IMediaSideData> inputSampleSideData(queuedSample.sample); inputSampleSideData != nullptr) {
             hdrSideData->ReadFrom(inputSampleSideData);
 
             if (const std::optional<const BYTE *> optHdr = hdrSideData->GetHDRData()) {
@@ -112,63 +147,54 @@ auto FrameHandler::AddInputSample(IMediaSample *inputSample) -> HRESULT {
         }
     }
 
-    {
-        const std::unique_lock uniqueSourceLock(_sourceMutex);
-
-        _sourceFrames.emplace(std::piecewise_construct,
-                              std::forward_as_tuple(_nextSourceFrameNb),
-                              std::forward_as_tuple(frame, inputSampleStartTime, _filter.m_pInput->SampleProps()->dwTypeSpecificFlags, std::move(hdrSideData)));
-        Environment::GetInstance().Log(L"Store source frame: %6d at %10lld ~ %10lld duration(literal) %10lld max_requested %6d extra_buffer %6d",
-                                       _nextSourceFrameNb,
-                                       inputSampleStartTime,
-                                       inputSampleStopTime,
-                                       inputSampleStopTime - inputSampleStartTime,
-                                       _maxRequestedFrameNb.load(),
-                                       _extraSrcBuffer);
-        _nextSourceFrameNb += 1;
-    }
-
-    // delay activating the main frameserver until we have enough pre-buffered frames in store
-    if (_nextSourceFrameNb == Environment::GetInstance().GetInitialSrcBuffer()) {
-        MainFrameServer::GetInstance().ReloadScript(_filter.m_pInput->CurrentMediaType(), true);
+    ASSERT(_sourceFrames.GetTailFrameNb() == queuedSample.frameNb);
+    _sourceFrames.Push(frame, queuedSample.startTime, queuedSample.typeSpecificFlags, std::move(hdrSideData));
+    if (Environment::GetInstance().IsLogEnabled<LogLevel::Trace>()) {
+        Environment::GetInstance().Log<LogLevel::Trace>(L"Store source frame: %6d at %10lld ~ %10lld duration(literal) %10lld max_requested %6d extra_buffer %6d",
+                                                        queuedSample.frameNb,
+                                                        queuedSample.startTime,
+                                                        queuedSample.stopTime,
+                                                        queuedSample.stopTime - queuedSample.startTime,
+                                                        _maxRequestedFrameNb.load(),
+                                                        _extraSrcBuffer);
     }
-
-    _newSourceFrameCv.notify_all();
-
-    return S_OK;
 }
 
 auto FrameHandler::GetSourceFrame(int frameNb) -> PVideoFrame {
-    Environment::GetInstance().Log(L"Get source frame: frameNb %6d input queue size %2zd", frameNb, _sourceFrames.size());
-
-    std::shared_lock sharedSourceLock(_sourceMutex);
+    if (Environment::GetInstance().IsLogEnabled<LogLevel::Trace>()) {
+        Environment::GetInstance().Log<LogLevel::Trace>(L"Get source frame: frameNb %6d input queue size %2d", frameNb, _sourceFrames.GetSize());
+    }
 
     _maxRequestedFrameNb = std::max(frameNb, _maxRequestedFrameNb.load());
-    _addInputSampleCv.notify_all();
+    _sourceFrames.NotifyAll();
 
-    decltype(_sourceFrames)::const_iterator iter;
-    _newSourceFrameCv.wait(sharedSourceLock, [this, &iter, frameNb]() -> bool {
+    const std::chrono::steady_clock::time_point waitStartTime = std::chrono::steady_clock::now();
+    PVideoFrame sourceFrame;
+    _sourceFrames.WaitUntil([this, &sourceFrame, frameNb]() -> bool {
         if (_isFlushing) {
             return true;
         }
 
-        // use map.lower_bound() in case the exact frame is removed by the script
-        iter = _sourceFrames.lower_bound(frameNb);
-        return iter != _sourceFrames.end();
+        // use lower bound in case the exact frame is removed by the script
+        return _sourceFrames.ReadLowerBound(frameNb, [&sourceFrame](int, const SourceFrameInfo &foundFrame) -> bool {
+            sourceFrame = foundFrame.frame;
+            return true;
+        });
     });
+    Environment::GetInstance().TraceComplete("GetSourceFrame wait", frameNb, waitStartTime);
 
-    if (_isFlushing || iter->second.frame == nullptr) {
+    if (_isFlushing || sourceFrame == nullptr) {
         if (_isFlushing) {
-            Environment::GetInstance().Log(L"Drain for frame %6d", frameNb);
+            Environment::GetInstance().Log<LogLevel::Trace>(L"Drain for frame %6d", frameNb);
         } else {
-            Environment::GetInstance().Log(L"Bad frame %6d", frameNb);
+            Environment::GetInstance().Log<LogLevel::Error>(L"Bad frame %6d", frameNb);
         }
 
         return MainFrameServer::GetInstance().CreateSourceDummyFrame();
     }
 
-    Environment::GetInstance().Log(L"Return source frame %6d", frameNb);
-    return iter->second.frame;
+    Environment::GetInstance().Log<LogLevel::Trace>(L"Return source frame %6d", frameNb);
+    return sourceFrame;
 }
 
 auto FrameHandler::BeginFlush() -> void {
@@ -180,8 +206,13 @@ auto FrameHandler::BeginFlush() -> void {
     _isFlushing.wait(true);
     _isFlushing = true;
 
-    _addInputSampleCv.notify_all();
-    _newSourceFrameCv.notify_all();
+    _sourceFrames.NotifyAll();
+
+    {
+        // pairs with the predicate checks of the waiters, so that they either see the flag or receive the notification
+        const std::unique_lock inputQueueLock(_inputQueueMutex);
+    }
+    _inputQueueCv.notify_all();
 
     Environment::GetInstance().Log(L"FrameHandler finish BeginFlush()");
 }
@@ -189,7 +220,9 @@ auto FrameHandler::BeginFlush() -> void {
 auto FrameHandler::EndFlush() -> void {
     Environment::GetInstance().Log(L"FrameHandler start EndFlush()");
 
+    ResetFrameNumbers();
     ResetInput();
+    StartScriptLoad();
 
     _isFlushing = false;
     _isFlushing.notify_all();
@@ -198,19 +231,30 @@ auto FrameHandler::EndFlush() -> void {
 }
 
 auto FrameHandler::ResetInput() -> void {
-    _sourceFrames.clear();
+    {
+        const std::unique_lock inputQueueLock(_inputQueueMutex);
 
-    _nextSourceFrameNb = 0;
-    _maxRequestedFrameNb = 0;
+        _queuedInputSamples.clear();
+    }
+    _sourceFrames.Clear(_firstSourceFrameNb);
+
+    _nextSourceFrameNb = _firstSourceFrameNb;
+    _lastInputSampleStartTime = -1;
+    _lastInputSampleReturnTime = {};
+    _maxRequestedFrameNb = _firstSourceFrameNb;
     _notifyChangedOutputMediaType = false;
     _extraSrcBuffer = 0;
 
-    _frameRateCheckpointInputSampleNb = 0;
+    _frameRateCheckpointInputSampleNb = _firstSourceFrameNb;
     _currentInputFrameRate = 0;
 }
 
 auto FrameHandler::PrepareOutputSample(ATL::CComPtr<IMediaSample> &outSample, REFERENCE_TIME startTime, REFERENCE_TIME stopTime, DWORD sourceTypeSpecificFlags) -> bool {
-    if (FAILED(_filter.m_pOutput->GetDeliveryBuffer(&outSample, &startTime, &stopTime, 0))) {
+    const std::chrono::steady_clock::time_point getDeliveryBufferStartTime = std::chrono::steady_clock::now();
+    const HRESULT hr = _filter.m_pOutput->GetDeliveryBuffer(&outSample, &startTime, &stopTime, 0);
+    RecordStageLatency(PipelineStage::GetDeliveryBuffer, getDeliveryBufferStartTime);
+
+    if (FAILED(hr)) {
         // avoid releasing the invalid pointer in case the function change it to some random invalid address
         outSample.Detach();
         return false;
@@ -240,7 +284,7 @@ auto FrameHandler::PrepareOutputSample(ATL::CComPtr<IMediaSample> &outSample, RE
         return false;
     }
 
-    if (_nextOutputFrameNb == 0 && FAILED(outSample->SetDiscontinuity(TRUE))) {
+    if (_nextOutputFrameNb == _firstOutputFrameNb && FAILED(outSample->SetDiscontinuity(TRUE))) {
         return false;
     }
 
@@ -248,14 +292,14 @@ auto FrameHandler::PrepareOutputSample(ATL::CComPtr<IMediaSample> &outSample, RE
         return false;
     } else {
         try {
-            if ((_filter._outputVideoFormat.outputBufferTemporalFlags & 0b11) == 0b01) {
-                MEMORY_BASIC_INFORMATION dstBufferInfo;
-                VirtualQuery(outputBuffer, &dstBufferInfo, sizeof(dstBufferInfo));
-                _filter._outputVideoFormat.outputBufferTemporalFlags |= (((dstBufferInfo.Protect & PAGE_WRITECOMBINE) != 0) << 2) + 0b10;
-            }
+            const std::chrono::steady_clock::time_point getFrameStartTime = std::chrono::steady_clock::now();
+            const PVideoFrame outputFrame = GetOutputFrame(_nextOutputFrameNb);
+            RecordStageLatency(PipelineStage::GetFrame, getFrameStartTime);
+            Environment::GetInstance().TraceComplete("GetFrame", _nextOutputFrameNb, getFrameStartTime);
 
-            // some AviSynth internal filter (e.g. Subtitle) can't tolerate multi-thread access
-            const PVideoFrame outputFrame = MainFrameServer::GetInstance().GetFrame(_nextOutputFrameNb);
+            if (outputFrame == nullptr) {
+                return false;
+            }
 
             if (const ATL::CComQIPtr<IMediaSample2> outSample2(outSample); outSample2 != nullptr) {
                 if (AM_SAMPLE2_PROPERTIES sampleProps; SUCCEEDED(outSample2->GetProperties(SAMPLE2_TYPE_SPECIFIC_FLAGS_SIZE, reinterpret_cast<BYTE *>(&sampleProps)))) {
@@ -286,7 +330,10 @@ auto FrameHandler::PrepareOutputSample(ATL::CComPtr<IMediaSample> &outSample, RE
                 }
             }
 
+            const std::chrono::steady_clock::time_point writeSampleStartTime = std::chrono::steady_clock::now();
             Format::WriteSample(_filter._outputVideoFormat, outputFrame, outputBuffer);
+            RecordStageLatency(PipelineStage::WriteSample, writeSampleStartTime);
+            Environment::GetInstance().TraceComplete("WriteSample", _nextOutputFrameNb, writeSampleStartTime);
         } catch (AvisynthError) {
             return false;
         }
@@ -297,11 +344,11 @@ auto FrameHandler::PrepareOutputSample(ATL::CComPtr<IMediaSample> &outSample, RE
 
 auto FrameHandler::WorkerProc() -> void {
     const auto ResetOutput = [this]() -> void {
-        _nextOutputFrameNb = 0;
+        _nextOutputFrameNb = _firstOutputFrameNb;
 
-        _frameRateCheckpointOutputFrameNb = 0;
+        _frameRateCheckpointOutputFrameNb = _firstOutputFrameNb;
         _currentOutputFrameRate = 0;
-        _frameRateCheckpointDeliveryFrameNb = 0;
+        _frameRateCheckpointDeliveryFrameNb = _firstOutputFrameNb;
         _currentDeliveryFrameRate = 0;
     };
 
@@ -314,8 +361,18 @@ auto FrameHandler::WorkerProc() -> void {
     ResetOutput();
     _isWorkerLatched = false;
 
+    _isPrefetchStopping = false;
+    if (const int outputPrefetch = Environment::GetInstance().GetOutputPrefetch(); outputPrefetch > 1) {
+        for (int i = 0; i < outputPrefetch; ++i) {
+            _prefetchThreads.emplace_back(&FrameHandler::PrefetchProc, this);
+        }
+    }
+
     while (true) {
         if (_isFlushing) {
+            // the script must not be used by any prefetch when it is released after the latch
+            WaitForPrefetches();
+
             _isWorkerLatched = true;
             _isWorkerLatched.notify_all();
             _isFlushing.wait(true);
@@ -333,96 +390,219 @@ auto FrameHandler::WorkerProc() -> void {
          * Therefore instead of directly using the stop time from the current sample, we use the start time of the next sample.
          */
 
-        std::array<decltype(_sourceFrames)::iterator, NUM_SRC_FRAMES_PER_PROCESSING> processSourceFrameIters;
-        std::array<REFERENCE_TIME, NUM_SRC_FRAMES_PER_PROCESSING - 1> outputFrameDurations;
+        _sourceFrames.WaitUntil([this]() -> bool {
+            if (_isFlushing) {
+                return true;
+            }
 
-        {
-            std::shared_lock sharedSourceLock(_sourceMutex);
+            if (_sourceFrames.GetTailFrameNb() - _firstSourceFrameNb <= Environment::GetInstance().GetInitialSrcBuffer()) {
+                return false;
+            }
 
-            _newSourceFrameCv.wait(sharedSourceLock, [&]() -> bool {
-                if (_isFlushing) {
-                    return true;
-                }
+            if (!_isScriptReady) {
+                return false;
+            }
 
-                if (_nextSourceFrameNb <= Environment::GetInstance().GetInitialSrcBuffer()) {
-                    return false;
-                }
+            return _sourceFrames.GetSize() >= NUM_SRC_FRAMES_PER_PROCESSING;
+        });
 
-                return _sourceFrames.size() >= NUM_SRC_FRAMES_PER_PROCESSING;
-            });
+        if (_isFlushing) {
+            continue;
+        }
 
-            if (_isFlushing) {
-                continue;
-            }
+        if (_isStandbyScriptReady) {
+            // the frames prefetched from the previous script are dropped, so that every frame after the swap is from the new script
+            WaitForPrefetches();
+            SwapScript(_nextOutputFrameNb);
+        }
 
-            processSourceFrameIters[0] = _sourceFrames.begin();
+        // the worker is the only thread erasing source frames, so these stay valid until GarbageCollect()
+        const int processSourceFrameNb = _sourceFrames.GetHeadFrameNb();
+        std::array<SourceFrameInfo *, NUM_SRC_FRAMES_PER_PROCESSING> processSourceFrames;
+        std::array<REFERENCE_TIME, NUM_SRC_FRAMES_PER_PROCESSING - 1> outputFrameDurations;
 
-            for (int i = 1; i < NUM_SRC_FRAMES_PER_PROCESSING; ++i) {
-                processSourceFrameIters[i] = processSourceFrameIters[i - 1];
-                ++processSourceFrameIters[i];
+        processSourceFrames[0] = &_sourceFrames.At(processSourceFrameNb);
 
-                outputFrameDurations[i - 1] = llMulDiv(processSourceFrameIters[i]->second.startTime - processSourceFrameIters[i - 1]->second.startTime,
-                                                       MainFrameServer::GetInstance().GetScriptAvgFrameDuration(),
-                                                       MainFrameServer::GetInstance().GetSourceAvgFrameDuration(),
-                                                       0);
-            }
+        for (int i = 1; i < NUM_SRC_FRAMES_PER_PROCESSING; ++i) {
+            processSourceFrames[i] = &_sourceFrames.At(processSourceFrameNb + i);
+
+            outputFrameDurations[i - 1] = llMulDiv(processSourceFrames[i]->startTime - processSourceFrames[i - 1]->startTime,
+                                                   MainFrameServer::GetInstance().GetScriptAvgFrameDuration(),
+                                                   MainFrameServer::GetInstance().GetSourceAvgFrameDuration(),
+                                                   0);
         }
 
-        if (processSourceFrameIters[0]->first == 0) {
-            _nextOutputFrameStartTime = processSourceFrameIters[0]->second.startTime;
+        if (processSourceFrameNb == _firstSourceFrameNb) {
+            _nextOutputFrameStartTime = processSourceFrames[0]->startTime;
         }
 
         while (!_isFlushing) {
-            const REFERENCE_TIME outputFrameDurationBeforeEdgePortion = std::min(processSourceFrameIters[1]->second.startTime - _nextOutputFrameStartTime, outputFrameDurations[0]);
+            const REFERENCE_TIME outputFrameDurationBeforeEdgePortion = std::min(processSourceFrames[1]->startTime - _nextOutputFrameStartTime, outputFrameDurations[0]);
             if (outputFrameDurationBeforeEdgePortion <= 0) {
-                Environment::GetInstance().Log(L"Frame time drift: %10lld", -outputFrameDurationBeforeEdgePortion);
+                Environment::GetInstance().Log<LogLevel::Trace>(L"Frame time drift: %10lld", -outputFrameDurationBeforeEdgePortion);
                 break;
             }
             const REFERENCE_TIME outputFrameDurationAfterEdgePortion = outputFrameDurations[1] - llMulDiv(outputFrameDurations[1], outputFrameDurationBeforeEdgePortion, outputFrameDurations[0], 0);
 
             const REFERENCE_TIME outputStartTime = _nextOutputFrameStartTime;
             REFERENCE_TIME outputStopTime = outputStartTime + outputFrameDurationBeforeEdgePortion + outputFrameDurationAfterEdgePortion;
-            if (outputStopTime < processSourceFrameIters[1]->second.startTime && outputStopTime >= processSourceFrameIters[1]->second.startTime - MAX_OUTPUT_FRAME_DURATION_PADDING) {
-                outputStopTime = processSourceFrameIters[1]->second.startTime;
+            if (outputStopTime < processSourceFrames[1]->startTime && outputStopTime >= processSourceFrames[1]->startTime - MAX_OUTPUT_FRAME_DURATION_PADDING) {
+                outputStopTime = processSourceFrames[1]->startTime;
             }
             _nextOutputFrameStartTime = outputStopTime;
 
             if (FrameServerCommon::GetInstance().IsFramePropsSupported()) {
-                AVSMap *frameProps = AVSF_AVS_API->getFramePropsRW(processSourceFrameIters[0]->second.frame);
-                REFERENCE_TIME frameDurationNum = processSourceFrameIters[1]->second.startTime - processSourceFrameIters[0]->second.startTime;
+                AVSMap *frameProps = AVSF_AVS_API->getFramePropsRW(processSourceFrames[0]->frame);
+                REFERENCE_TIME frameDurationNum = processSourceFrames[1]->startTime - processSourceFrames[0]->startTime;
                 REFERENCE_TIME frameDurationDen = UNITS;
                 CoprimeIntegers(frameDurationNum, frameDurationDen);
                 AVSF_AVS_API->propSetInt(frameProps, FRAME_PROP_NAME_DURATION_NUM, frameDurationNum, PROPAPPENDMODE_REPLACE);
                 AVSF_AVS_API->propSetInt(frameProps, FRAME_PROP_NAME_DURATION_DEN, frameDurationDen, PROPAPPENDMODE_REPLACE);
             }
 
-            Environment::GetInstance().Log(L"Processing output frame %6d for source frame %6d at %10lld ~ %10lld duration %10lld",
-                                           _nextOutputFrameNb,
-                                           processSourceFrameIters[0]->first,
-                                           outputStartTime,
-                                           outputStopTime,
-                                           outputStopTime - outputStartTime);
+            Environment::GetInstance().Log<LogLevel::Trace>(L"Processing output frame %6d for source frame %6d at %10lld ~ %10lld duration %10lld",
+                                                            _nextOutputFrameNb,
+                                                            processSourceFrameNb,
+                                                            outputStartTime,
+                                                            outputStopTime,
+                                                            outputStopTime - outputStartTime);
 
             RefreshOutputFrameRates(_nextOutputFrameNb);
 
-            if (ATL::CComPtr<IMediaSample> outSample; PrepareOutputSample(outSample, outputStartTime, outputStopTime, processSourceFrameIters[0]->second.typeSpecificFlags)) {
+            if (ATL::CComPtr<IMediaSample> outSample; PrepareOutputSample(outSample, outputStartTime, outputStopTime, processSourceFrames[0]->typeSpecificFlags)) {
                 if (const ATL::CComQIPtr<IMediaSideData> sideData(outSample); sideData != nullptr) {
-                    processSourceFrameIters[0]->second.hdrSideData->WriteTo(sideData);
+                    processSourceFrames[0]->hdrSideData->WriteTo(sideData);
                 }
 
-                _filter.m_pOutput->Deliver(outSample);
+                const std::chrono::steady_clock::time_point deliverStartTime = std::chrono::steady_clock::now();
+                _filter.DeliverOutputSample(outSample);
+                RecordStageLatency(PipelineStage::Deliver, deliverStartTime);
+                Environment::GetInstance().TraceComplete("Deliver", _nextOutputFrameNb, deliverStartTime);
                 RefreshDeliveryFrameRates(_nextOutputFrameNb);
 
-                Environment::GetInstance().Log(L"Deliver frame %6d", _nextOutputFrameNb);
+                if (_nextOutputFrameNb == _firstOutputFrameNb) {
+                    RecordStageLatency(PipelineStage::FirstFrame, _streamStartTime);
+                }
+
+                Environment::GetInstance().Log<LogLevel::Trace>(L"Deliver frame %6d", _nextOutputFrameNb);
             }
 
             _nextOutputFrameNb += 1;
         }
 
-        GarbageCollect(processSourceFrameIters[0]->first);
+        GarbageCollect(processSourceFrameNb);
+    }
+
+    {
+        const std::unique_lock prefetchLock(_prefetchMutex);
+
+        _isPrefetchStopping = true;
+    }
+    _prefetchRequestCv.notify_all();
+
+    for (std::thread &prefetchThread : _prefetchThreads) {
+        prefetchThread.join();
     }
+    _prefetchThreads.clear();
 
     Environment::GetInstance().Log(L"Stop worker thread");
 }
 
+/*
+ * Multi-threaded scripts get the frames from the prefetch threads, which work on the next few frames while the current one is delivered.
+ * The frames are still returned in order, since the frames ahead wait in _prefetchedFrames until requested.
+ * Other scripts are called directly on the worker thread, since some AviSynth internal filter (e.g. Subtitle) can't tolerate multi-thread access.
+ */
+auto FrameHandler::GetOutputFrame(int frameNb) -> PVideoFrame {
+    if (_prefetchThreads.empty() || !MainFrameServer::GetInstance().IsScriptMultiThreaded()) {
+        try {
+            return MainFrameServer::GetInstance().GetFrame(frameNb);
+        } catch (AvisynthError) {
+            return nullptr;
+        }
+    }
+
+    std::unique_lock prefetchLock(_prefetchMutex);
+
+    // frames skipped due to failed deliveries are never taken, so drop them once they are ready
+    for (auto iter = _prefetchedFrames.begin(); iter != _prefetchedFrames.end() && iter->first < frameNb;) {
+        iter = iter->second.isReady ? _prefetchedFrames.erase(iter) : std::next(iter);
+    }
+
+    _nextPrefetchFrameNb = std::max(_nextPrefetchFrameNb, frameNb);
+    for (; _nextPrefetchFrameNb < frameNb + static_cast<int>(_prefetchThreads.size()); ++_nextPrefetchFrameNb) {
+        _prefetchedFrames.try_emplace(_nextPrefetchFrameNb);
+        _prefetchRequests.emplace_back(_nextPrefetchFrameNb);
+        _numPendingPrefetches += 1;
+    }
+    _prefetchRequestCv.notify_all();
+
+    const auto iter = _prefetchedFrames.find(frameNb);
+    ASSERT(iter != _prefetchedFrames.end());
+    _prefetchedFrameCv.wait(prefetchLock, [&iter]() -> bool {
+        return iter->second.isReady;
+    });
+
+    PVideoFrame outputFrame = std::move(iter->second.frame);
+    _prefetchedFrames.erase(iter);
+    return outputFrame;
+}
+
+auto FrameHandler::PrefetchProc() -> void {
+#ifdef _DEBUG
+    SetThreadDescription(GetCurrentThread(), L"CSynthFilter Prefetch");
+#endif
+
+    while (true) {
+        int frameNb;
+        {
+            std::unique_lock prefetchLock(_prefetchMutex);
+
+            _prefetchRequestCv.wait(prefetchLock, [this]() -> bool {
+                return _isPrefetchStopping || !_prefetchRequests.empty();
+            });
+
+            if (_isPrefetchStopping) {
+                break;
+            }
+
+            frameNb = _prefetchRequests.front();
+            _prefetchRequests.pop_front();
+        }
+
+        const std::chrono::steady_clock::time_point prefetchStartTime = std::chrono::steady_clock::now();
+        PVideoFrame outputFrame;
+        try {
+            outputFrame = MainFrameServer::GetInstance().GetFrame(frameNb);
+        } catch (AvisynthError) {
+            Environment::GetInstance().Log<LogLevel::Error>(L"Failed to prefetch output frame %6d", frameNb);
+        }
+        Environment::GetInstance().TraceComplete("Prefetch", frameNb, prefetchStartTime);
+
+        {
+            const std::unique_lock prefetchLock(_prefetchMutex);
+
+            PrefetchedFrame &prefetchedFrame = _prefetchedFrames.at(frameNb);
+            prefetchedFrame.frame = std::move(outputFrame);
+            prefetchedFrame.isReady = true;
+            _numPendingPrefetches -= 1;
+        }
+        _prefetchedFrameCv.notify_all();
+    }
+}
+
+auto FrameHandler::WaitForPrefetches() -> void {
+    std::unique_lock prefetchLock(_prefetchMutex);
+
+    // drop the requests not yet picked up, and wait for the running ones
+    _numPendingPrefetches -= static_cast<int>(_prefetchRequests.size());
+    _prefetchRequests.clear();
+    _prefetchedFrameCv.wait(prefetchLock, [this]() -> bool {
+        return _numPendingPrefetches == 0;
+    });
+
+    _prefetchedFrames.clear();
+    _nextPrefetchFrameNb = 0;
+}
+
 }
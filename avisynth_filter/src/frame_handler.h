@@ -3,11 +3,15 @@
 #pragma once
 
 #include "hdr.h"
+#include "latency_histogram.h"
+#include "source_buffer_controller.h"
+#include "source_frame_ring.h"
 
 
 namespace SynthFilter {
 
 class CSynthFilter;
+class MainFrameServer;
 
 class FrameHandler {
 public:
@@ -22,6 +26,10 @@ public:
     auto EndFlush() -> void;
     auto StartWorker() -> void;
     auto WaitForWorkerLatch() -> void;
+    auto WaitForScriptLoad() -> void;
+    auto StartScriptSwap(const std::filesystem::path &scriptPath) -> void;
+    auto CancelScriptSwap() -> void;
+    auto WaitForInputConversion() -> void;
     auto GetInputBufferSize() const -> int;
     constexpr auto GetSourceFrameNb() const -> int { return _nextSourceFrameNb; }
     constexpr auto GetOutputFrameNb() const -> int { return _nextOutputFrameNb; }
@@ -29,8 +37,19 @@ public:
     constexpr auto GetCurrentInputFrameRate() const -> int { return _currentInputFrameRate; }
     constexpr auto GetCurrentOutputFrameRate() const -> int { return _currentOutputFrameRate; }
     constexpr auto GetCurrentDeliveryFrameRate() const -> int { return _currentDeliveryFrameRate; }
+    auto GetStageLatency(PipelineStage stage) const -> LatencyHistogram::Summary;
 
 private:
+    struct QueuedInputSample {
+        ATL::CComPtr<IMediaSample> sample;
+        BYTE *buffer;
+        int frameNb;
+        REFERENCE_TIME startTime;
+        REFERENCE_TIME stopTime;
+        DWORD typeSpecificFlags;
+        std::chrono::steady_clock::time_point receiveTime;
+    };
+
     struct SourceFrameInfo {
         PVideoFrame frame;
         REFERENCE_TIME startTime;
@@ -38,41 +57,96 @@ private:
         std::unique_ptr<HDRSideData> hdrSideData;
     };
 
+    struct PrefetchedFrame {
+        // nullptr if the script fails to return the frame
+        PVideoFrame frame;
+        bool isReady = false;
+    };
+
     static auto RefreshFrameRatesTemplate(int sampleNb, int &checkpointSampleNb, std::chrono::steady_clock::time_point &checkpointTime, int &currentFrameRate) -> void;
 
+    auto ResetFrameNumbers() -> void;
     auto ResetInput() -> void;
+    auto ConvertInputSample(const QueuedInputSample &queuedSample) -> void;
+    auto ConversionProc() -> void;
+    auto StartScriptLoad() -> void;
+    auto ScriptLoadProc(CMediaType mediaType) -> void;
+    auto ScriptSwapProc(CMediaType mediaType, std::filesystem::path scriptPath) -> void;
+    auto SwapScript(int nextOutputFrameNb) -> void;
     auto PrepareOutputSample(ATL::CComPtr<IMediaSample> &outSample, REFERENCE_TIME startTime, REFERENCE_TIME stopTime, DWORD sourceTypeSpecificFlags) -> bool;
     auto WorkerProc() -> void;
+    auto GetOutputFrame(int frameNb) -> PVideoFrame;
+    auto PrefetchProc() -> void;
+    auto WaitForPrefetches() -> void;
     auto GarbageCollect(int srcFrameNb) -> void;
     auto ChangeOutputFormat() -> bool;
     auto UpdateExtraSrcBuffer() -> void;
+    auto GetNumInFlightSourceFrames() const -> int;
     auto RefreshInputFrameRates(int frameNb) -> void;
     auto RefreshOutputFrameRates(int frameNb) -> void;
     auto RefreshDeliveryFrameRates(int frameNb) -> void;
+    auto RecordStageLatency(PipelineStage stage, std::chrono::steady_clock::time_point startTime) -> void;
 
     static constexpr const int NUM_SRC_FRAMES_PER_PROCESSING = 3;
 
     CSynthFilter &_filter;
 
-    std::map<int, SourceFrameInfo> _sourceFrames;
+    // received samples waiting for the conversion thread. The front one is removed after it is converted
+    std::deque<QueuedInputSample> _queuedInputSamples;
+    SourceFrameRing<SourceFrameInfo> _sourceFrames;
+
+    std::mutex _inputQueueMutex;
 
-    mutable std::shared_mutex _sourceMutex;
+    std::condition_variable _inputQueueCv;
 
-    std::condition_variable_any _addInputSampleCv;
-    std::condition_variable_any _newSourceFrameCv;
+    // output frames requested ahead of the delivery, in the order of frame numbers, all guarded by _prefetchMutex
+    std::map<int, PrefetchedFrame> _prefetchedFrames;
+    std::deque<int> _prefetchRequests;
+    int _nextPrefetchFrameNb = 0;
+    int _numPendingPrefetches = 0;
+    bool _isPrefetchStopping = false;
+    std::mutex _prefetchMutex;
+    std::condition_variable _prefetchRequestCv;
+    std::condition_variable _prefetchedFrameCv;
+    std::vector<std::thread> _prefetchThreads;
 
+    // numbers of the first source and output frames since the last flush. Non-zero when the script is kept through the flush
+    int _firstSourceFrameNb = 0;
+    int _firstOutputFrameNb = 0;
     int _nextSourceFrameNb;
+    REFERENCE_TIME _lastInputSampleStartTime;
     std::atomic<int> _maxRequestedFrameNb;
     int _nextOutputFrameNb;
     REFERENCE_TIME _nextOutputFrameStartTime;
     bool _notifyChangedOutputMediaType;
     int _extraSrcBuffer;
+    SourceBufferController _sourceBufferController;
+    // when the previous AddInputSample() returns to the upstream, for measuring how long the upstream takes to produce the next sample
+    std::chrono::steady_clock::time_point _lastInputSampleReturnTime;
+
+    // when the stream starts or the last flush ends, for measuring the time to the first output frame
+    std::chrono::steady_clock::time_point _streamStartTime;
 
+    std::thread _conversionThread;
     std::thread _workerThread;
+    std::thread _scriptLoadThread;
+    std::thread _scriptSwapThread;
+    std::mutex _scriptSwapMutex;
+
+    // the latest script requested while the swap thread is evaluating another one, picked up after that evaluation
+    std::optional<std::filesystem::path> _pendingScriptPath;
+    bool _isScriptSwapRunning = false;
+
+    // frameserver with the new script, waiting to replace the main one at the next frame boundary
+    std::unique_ptr<MainFrameServer> _standbyFrameServer;
+    std::mutex _standbyFrameServerMutex;
 
     std::atomic<bool> _isFlushing = false;
     std::atomic<bool> _isStopping = false;
+    std::atomic<bool> _isConversionLatched = false;
     std::atomic<bool> _isWorkerLatched = false;
+    std::atomic<bool> _isScriptReady = false;
+    std::atomic<bool> _isStandbyScriptReady = false;
 
     int _frameRateCheckpointInputSampleNb;
     std::chrono::steady_clock::time_point _frameRateCheckpointInputSampleTime;
@@ -83,6 +157,8 @@ private:
     int _currentInputFrameRate;
     int _currentOutputFrameRate;
     int _currentDeliveryFrameRate;
+
+    std::array<LatencyHistogram, NUM_PIPELINE_STAGES> _stageLatencies;
 };
 
 }
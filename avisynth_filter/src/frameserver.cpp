@@ -70,7 +70,7 @@ auto FrameServerCommon::CreateEnv() -> IScriptEnvironment * {
     IScriptEnvironment *env = CreateScriptEnvironment(MINIMUM_AVISYNTH_PLUS_INTERFACE_VERSION);
     if (env == nullptr) {
         const WCHAR *errorMessage = L"CreateScriptEnvironment() returns nullptr";
-        Environment::GetInstance().Log(errorMessage);
+        Environment::GetInstance().Log<LogLevel::Error>(L"%ls", errorMessage);
         MessageBoxW(nullptr, errorMessage, FILTER_NAME_FULL, MB_ICONERROR);
         throw;
     }
@@ -88,17 +88,19 @@ auto FrameServerBase::CreateAndSetupEnv() -> void {
 /**
  * Create new script clip with specified media type.
  */
-auto FrameServerBase::ReloadScript(const AM_MEDIA_TYPE &mediaType, bool ignoreDisconnect) -> bool {
+auto FrameServerBase::ReloadScript(const AM_MEDIA_TYPE &mediaType, const std::filesystem::path &scriptPath, bool ignoreDisconnect) -> bool {
     StopScript();
 
-    const VideoInfo &sourceVideoInfo = Format::GetVideoFormat(mediaType, this).videoInfo;
-    FrameServerCommon::GetInstance()._sourceVideoInfo = sourceVideoInfo;
+    // each frameserver has its own source clip, so that scripts of different source formats can be evaluated concurrently
+    _sourceVideoInfo = Format::GetVideoFormat(mediaType, this).videoInfo;
+    reinterpret_cast<SourceClip *>(static_cast<void *>(_sourceClip))->SetVideoInfo(_sourceVideoInfo);
 
     _errorString.clear();
+    _isDisconnectRequested = false;
     AVSValue invokeResult;
 
-    if (!FrameServerCommon::GetInstance()._scriptPath.empty()) {
-        const std::string utf8Filename = ConvertWideToUtf8(FrameServerCommon::GetInstance()._scriptPath.native());
+    if (!scriptPath.empty()) {
+        const std::string utf8Filename = ConvertWideToUtf8(scriptPath.native());
         const std::array<AVSValue, 2> args { utf8Filename.c_str(), true };
         const std::array<char *const, args.size()> argNames { nullptr, "utf8" };
 
@@ -111,6 +113,8 @@ auto FrameServerBase::ReloadScript(const AM_MEDIA_TYPE &mediaType, bool ignoreDi
 
     if (_errorString.empty()) {
         if (!invokeResult.Defined()) {
+            _isDisconnectRequested = true;
+
             if (!ignoreDisconnect) {
                 return false;
             }
@@ -153,13 +157,18 @@ MainFrameServer::~MainFrameServer() {
     _env->DeleteScriptEnvironment();
 }
 
-auto MainFrameServer::ReloadScript(const AM_MEDIA_TYPE &mediaType, bool ignoreDisconnect) -> bool {
+auto MainFrameServer::ReloadScript(const AM_MEDIA_TYPE &mediaType, const std::filesystem::path &scriptPath, bool ignoreDisconnect) -> bool {
     Environment::GetInstance().Log(L"ReloadScript from main frameserver");
 
-    if (__super::ReloadScript(mediaType, ignoreDisconnect)) {
-        const VideoInfo &sourceVideoInfo = FrameServerCommon::GetInstance()._sourceVideoInfo;
-        _sourceAvgFrameRate = static_cast<int>(llMulDiv(sourceVideoInfo.fps_numerator, FRAME_RATE_SCALE_FACTOR, sourceVideoInfo.fps_denominator, 0));
-        _sourceAvgFrameDuration = llMulDiv(sourceVideoInfo.fps_denominator, UNITS, sourceVideoInfo.fps_numerator, 0);
+    if (__super::ReloadScript(mediaType, scriptPath, ignoreDisconnect)) {
+        _sourceAvgFrameRate = static_cast<int>(llMulDiv(_sourceVideoInfo.fps_numerator, FRAME_RATE_SCALE_FACTOR, _sourceVideoInfo.fps_denominator, 0));
+        _sourceAvgFrameDuration = llMulDiv(_sourceVideoInfo.fps_denominator, UNITS, _sourceVideoInfo.fps_numerator, 0);
+
+        // Prefetch() in the script sets the number of filter chain threads, which means the script is ready for concurrent GetFrame() calls
+        // GetEnvProperty() needs interface version 8, the same as frame properties
+        // the error script is never multi-threaded, since Subtitle can't tolerate multi-thread access
+        _isScriptMultiThreaded = FrameServerCommon::GetInstance().IsFramePropsSupported() && _errorString.empty() && _env->GetEnvProperty(AEP_FILTERCHAIN_THREADS) > 1;
+        Environment::GetInstance().Log(L"Script is multi-threaded: %d", _isScriptMultiThreaded);
 
         return true;
     }
@@ -172,7 +181,7 @@ auto MainFrameServer::GetFrame(int frameNb) const -> PVideoFrame {
 }
 
 auto MainFrameServer::CreateSourceDummyFrame() const -> PVideoFrame {
-    return _env->NewVideoFrame(FrameServerCommon::GetInstance().GetSourceVideoInfo());
+    return _env->NewVideoFrame(_sourceVideoInfo);
 }
 
 auto MainFrameServer::LinkSynthFilter(const CSynthFilter *filter) -> void {
@@ -180,12 +189,26 @@ auto MainFrameServer::LinkSynthFilter(const CSynthFilter *filter) -> void {
     reinterpret_cast<SourceClip *>(static_cast<void *>(_sourceClip))->SetFrameHandler(filter->frameHandler.get());
 }
 
+auto MainFrameServer::HasSameOutput(const MainFrameServer &other) const -> bool {
+    return _scriptVideoInfo.width == other._scriptVideoInfo.width
+        && _scriptVideoInfo.height == other._scriptVideoInfo.height
+        && _scriptVideoInfo.IsSameColorspace(other._scriptVideoInfo)
+        && _scriptAvgFrameDuration == other._scriptAvgFrameDuration;
+}
+
 auto AuxFrameServer::ReloadScript(const AM_MEDIA_TYPE &mediaType, bool ignoreDisconnect) -> bool {
     Environment::GetInstance().Log(L"ReloadScript from auxiliary frameserver");
 
+    const std::filesystem::path scriptPath = FrameServerCommon::GetInstance().GetScriptPath();
+
+    if (LoadProbeResult(mediaType, scriptPath)) {
+        return true;
+    }
+
     CreateAndSetupEnv();
 
-    if (__super::ReloadScript(mediaType, ignoreDisconnect)) {
+    if (__super::ReloadScript(mediaType, scriptPath, ignoreDisconnect)) {
+        SaveProbeResult(mediaType, scriptPath);
         StopScript();
 
         // AviSynth+ prefetchers are only destroyed when the environment is deleted
@@ -24,16 +24,16 @@ public:
     auto SetScriptPath(const std::filesystem::path &scriptPath) -> void;
     constexpr auto GetVersionString() const -> std::string_view { return _versionString == nullptr ? "unknown AviSynth version" : _versionString; }
     constexpr auto IsFramePropsSupported() const -> bool { return _isFramePropsSupported; }
-    constexpr auto GetSourceVideoInfo() const -> const VideoInfo & { return _sourceVideoInfo; }
-    constexpr auto GetScriptPath() const -> const std::filesystem::path & { return _scriptPath; }
+    auto GetScriptPath() const -> std::filesystem::path;
 
 private:
     static auto CreateEnv() -> IScriptEnvironment *;
 
     const char *_versionString = nullptr;
     bool _isFramePropsSupported = false;
+    // set by the remote control and the property page while the streaming threads read it
     std::filesystem::path _scriptPath = Environment::GetInstance().GetScriptPath();
-    VideoInfo _sourceVideoInfo {};
+    mutable std::mutex _scriptPathMutex;
 };
 
 class FrameServerBase {
@@ -41,15 +41,17 @@ protected:
     CTOR_WITHOUT_COPYING(FrameServerBase)
 
     auto CreateAndSetupEnv() -> void;
-    auto ReloadScript(const AM_MEDIA_TYPE &mediaType, bool ignoreDisconnect) -> bool;
+    auto ReloadScript(const AM_MEDIA_TYPE &mediaType, const std::filesystem::path &scriptPath, bool ignoreDisconnect) -> bool;
     auto StopScript() -> void;
 
     IScriptEnvironment *_env = nullptr;
     PClip _sourceClip = nullptr;
     PClip _scriptClip = nullptr;
+    VideoInfo _sourceVideoInfo {};
     VideoInfo _scriptVideoInfo {};
     REFERENCE_TIME _scriptAvgFrameDuration = 0;
     std::string _errorString;
+    bool _isDisconnectRequested = false;
 };
 
 class MainFrameServer
@@ -61,21 +63,31 @@ public:
 
     DISABLE_COPYING(MainFrameServer)
 
-    auto ReloadScript(const AM_MEDIA_TYPE &mediaType, bool ignoreDisconnect) -> bool;
+    auto ReloadScript(const AM_MEDIA_TYPE &mediaType, const std::filesystem::path &scriptPath, bool ignoreDisconnect) -> bool;
     using FrameServerBase::StopScript;
+    auto IsScriptLoaded() const -> bool { return _scriptClip != nullptr; }
     auto GetFrame(int frameNb) const -> PVideoFrame;
     auto CreateSourceDummyFrame() const -> PVideoFrame;
     auto LinkSynthFilter(const CSynthFilter *filter) -> void;
+    auto HasSameOutput(const MainFrameServer &other) const -> bool;
+    auto AdoptPredecessor(MainFrameServer *predecessor) -> void { _predecessor.reset(predecessor); }
+    auto ReleasePredecessor() -> void;
+    auto GetNumPredecessors() const -> int;
     constexpr auto GetEnv() const -> IScriptEnvironment * { return _env; }
     constexpr auto GetSourceAvgFrameDuration() const -> REFERENCE_TIME { return _sourceAvgFrameDuration; }
     constexpr auto GetSourceAvgFrameRate() const -> int { return _sourceAvgFrameRate; }
     constexpr auto GetScriptAvgFrameDuration() const -> REFERENCE_TIME { return _scriptAvgFrameDuration; }
+    constexpr auto IsScriptMultiThreaded() const -> bool { return _isScriptMultiThreaded; }
     auto GetErrorString() const -> std::optional<std::string>;
 
 private:
+    bool _isScriptMultiThreaded = false;
     REFERENCE_TIME _sourceAvgFrameDuration = 0;
     int _sourceAvgFrameRate = 0;
     const CSynthFilter *_filter;
+
+    // the instance replaced by this one in a script swap, kept until this script is stopped, since its caches could hold the frames allocated by the replaced one
+    std::unique_ptr<MainFrameServer> _predecessor;
 };
 
 class AuxFrameServer
@@ -87,6 +99,18 @@ public:
     auto ReloadScript(const AM_MEDIA_TYPE &mediaType, bool ignoreDisconnect) -> bool;
     auto GenerateMediaType(const Format::PixelFormat &pixelFormat, const AM_MEDIA_TYPE *templateMediaType) const -> CMediaType;
     constexpr auto GetScriptPixelType() const -> int { return _scriptVideoInfo.pixel_type; }
+
+private:
+    struct ProbeCacheEntry {
+        std::wstring slotName;
+        // the script path, its version and the source format that the result is valid for
+        std::wstring key;
+    };
+
+    static auto GetProbeCacheEntry(const AM_MEDIA_TYPE &mediaType, const std::filesystem::path &scriptPath) -> std::optional<ProbeCacheEntry>;
+
+    auto LoadProbeResult(const AM_MEDIA_TYPE &mediaType, const std::filesystem::path &scriptPath) -> bool;
+    auto SaveProbeResult(const AM_MEDIA_TYPE &mediaType, const std::filesystem::path &scriptPath) const -> void;
 };
 
 #define AVSF_AVS_API MainFrameServer::GetInstance().GetEnv()
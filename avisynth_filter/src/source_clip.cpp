@@ -11,9 +11,13 @@ auto SourceClip::SetFrameHandler(FrameHandler *frameHandler) -> void {
     _frameHandler = frameHandler;
 }
 
+auto SourceClip::SetVideoInfo(const VideoInfo &videoInfo) -> void {
+    _videoInfo = videoInfo;
+}
+
 auto SourceClip::GetFrame(int frameNb, IScriptEnvironment *env) -> PVideoFrame {
     if (_frameHandler == nullptr) {
-        Environment::GetInstance().Log(L"Source frame %6d is requested without the frame handler being linked", frameNb);
+        Environment::GetInstance().Log<LogLevel::Error>(L"Source frame %6d is requested without the frame handler being linked", frameNb);
         return env->NewVideoFrame(GetVideoInfo());
     }
 
@@ -21,7 +25,7 @@ auto SourceClip::GetFrame(int frameNb, IScriptEnvironment *env) -> PVideoFrame {
 }
 
 auto SourceClip::GetVideoInfo() -> const VideoInfo & {
-    return FrameServerCommon::GetInstance().GetSourceVideoInfo();
+    return _videoInfo;
 }
 
 }
@@ -10,6 +10,7 @@ namespace SynthFilter {
 class SourceClip : public IClip {
 public:
     auto SetFrameHandler(FrameHandler *frameHandler) -> void;
+    auto SetVideoInfo(const VideoInfo &videoInfo) -> void;
 
     auto __stdcall GetFrame(int frameNb, IScriptEnvironment *env) -> PVideoFrame override;
     auto __stdcall GetVideoInfo() -> const VideoInfo & override;
@@ -19,6 +20,7 @@ public:
 
 private:
     FrameHandler *_frameHandler = nullptr;
+    VideoInfo _videoInfo {};
 };
 
 }
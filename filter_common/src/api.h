@@ -21,7 +21,7 @@ enum class AvsState {
 
 namespace {
 
-constexpr const int API_VERSION                           = 1;
+constexpr const int API_VERSION                           = 3;
 constexpr const char *API_WND_CLASS_NAME                  = "AvsFilterRemoteControlClass";
 constexpr const char *API_CSV_DELIMITER                   = ";";
 
@@ -44,6 +44,16 @@ constexpr const ULONG_PTR API_MSG_GET_API_VERSION         = 100;
  */
 constexpr const ULONG_PTR API_MSG_GET_VIDEO_FILTERS       = 101;
 
+/**
+ * input : none
+ * output: p50, p95, p99 and max latency in microseconds of each stage of the frame pipeline, joined by the delimiter
+ * note  : the stages are, in order, upstream waiting for buffer room, creating frame from input sample, script producing frame,
+ *         writing frame to output sample, waiting for output sample buffer, delivering output sample
+ *         and starting or seeking until the first output sample is delivered
+ *         since version 2. The last stage is since version 3
+ */
+constexpr const ULONG_PTR API_MSG_GET_STAGE_LATENCIES     = 102;
+
 ////// input related messages //////
 
 /**
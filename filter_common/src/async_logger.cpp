@@ -0,0 +1,121 @@
+// License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
+
+#include "async_logger.h"
+
+
+namespace SynthFilter {
+
+static std::atomic<uint64_t> nextLoggerId = 1;
+
+AsyncLogger::AsyncLogger(FILE *file)
+    : _file(file)
+    , _startTime(std::chrono::steady_clock::now())
+    , _id(nextLoggerId++)
+    , _writerThread(&AsyncLogger::WriterProc, this) {
+}
+
+AsyncLogger::~AsyncLogger() {
+    {
+        const std::unique_lock writerLock(_writerMutex);
+        _isStopping = true;
+    }
+    _writerCv.notify_one();
+
+    _writerThread.join();
+}
+
+auto AsyncLogger::GetThreadRing() -> LogRing & {
+    // the ring is shared with the logger, so that the records logged right before the thread exits are still written
+    thread_local std::shared_ptr<LogRing> threadRing;
+    thread_local uint64_t threadRingLoggerId = 0;
+
+    if (threadRingLoggerId != _id) {
+        threadRing = std::make_shared<LogRing>(GetCurrentThreadId());
+        threadRingLoggerId = _id;
+
+        const std::unique_lock ringsLock(_ringsMutex);
+        _rings.emplace_back(threadRing);
+    }
+
+    return *threadRing;
+}
+
+auto AsyncLogger::WriterProc() -> void {
+#ifdef _DEBUG
+    SetThreadDescription(GetCurrentThread(), L"CSynthFilter Log Writer");
+#endif
+
+    while (true) {
+        bool isStopping;
+        {
+            std::unique_lock writerLock(_writerMutex);
+            _writerCv.wait_for(writerLock, LOG_WRITE_INTERVAL, [this]() -> bool {
+                return _isStopping;
+            });
+            isStopping = _isStopping;
+        }
+
+        WriteRecords();
+
+        if (isStopping) {
+            break;
+        }
+    }
+}
+
+auto AsyncLogger::WriteRecords() -> void {
+    std::vector<std::shared_ptr<LogRing>> rings;
+    {
+        const std::unique_lock ringsLock(_ringsMutex);
+
+        // rings only referenced by the logger belong to exited threads, which will not log again
+        std::erase_if(_rings, [](const std::shared_ptr<LogRing> &ring) -> bool {
+            return ring.use_count() == 1 && ring->readIndex == ring->writeIndex && ring->numDropped == 0;
+        });
+        rings = _rings;
+    }
+
+    struct PendingRecord {
+        const LogRecord *record;
+        DWORD threadId;
+    };
+    std::vector<PendingRecord> pendingRecords;
+    std::vector<size_t> ringWriteIndices(rings.size());
+
+    for (size_t i = 0; i < rings.size(); ++i) {
+        LogRing &ring = *rings[i];
+
+        if (const uint32_t numDropped = ring.numDropped.exchange(0); numDropped > 0) {
+            fwprintf_s(_file, L"T %6lu: %u log records dropped because the log ring is full\n", ring.threadId, numDropped);
+        }
+
+        ringWriteIndices[i] = ring.writeIndex.load(std::memory_order_acquire);
+        for (size_t r = ring.readIndex.load(std::memory_order_relaxed); r < ringWriteIndices[i]; ++r) {
+            pendingRecords.emplace_back(&ring.records[r % ring.records.size()], ring.threadId);
+        }
+    }
+
+    if (pendingRecords.empty()) {
+        return;
+    }
+
+    // each ring is already in time order, so a stable sort interleaves the threads without reordering any of them
+    std::ranges::stable_sort(pendingRecords, {}, [](const PendingRecord &pendingRecord) -> std::chrono::steady_clock::time_point {
+        return pendingRecord.record->time;
+    });
+
+    for (const PendingRecord &pendingRecord : pendingRecords) {
+        const std::chrono::steady_clock::duration elapsed = pendingRecord.record->time - _startTime;
+        fwprintf_s(_file, L"T %6lu @ %11lld: ", pendingRecord.threadId, std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+        pendingRecord.record->writeFunc(_file, *pendingRecord.record);
+        fputwc(L'\n', _file);
+    }
+    fflush(_file);
+
+    // only release the records after they are formatted, since the logging threads reuse them right away
+    for (size_t i = 0; i < rings.size(); ++i) {
+        rings[i]->readIndex.store(ringWriteIndices[i], std::memory_order_release);
+    }
+}
+
+}
@@ -0,0 +1,182 @@
+// License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
+
+#pragma once
+
+#include "constants.h"
+#include "macros.h"
+
+
+namespace SynthFilter {
+
+/*
+ * Logger that keeps the logging threads away from the log file.
+ *
+ * Each logging thread owns a single-producer single-consumer ring of fixed size records. Logging only stores
+ * the time, the format string and the raw arguments into the next free record, without taking any lock.
+ * A background thread periodically collects the records from all rings, formats them in time order and writes them in one batch.
+ *
+ * When a ring is full, the record is dropped and counted instead of blocking the logging thread.
+ * The writer reports the number of dropped records of each thread the next time it drains the ring.
+ */
+class AsyncLogger {
+public:
+    explicit AsyncLogger(FILE *file);
+    ~AsyncLogger();
+
+    DISABLE_COPYING(AsyncLogger)
+
+    /*
+     * format is stored as is and only read by the writer thread later, thus must be a string literal.
+     * String arguments are copied into the record, truncated to fit. Other arguments must be trivially copyable.
+     */
+    template <typename... Args>
+    auto Log(const WCHAR *format, const Args &...args) -> void {
+        // decaying from the const reference turns character arrays into const pointers
+        using Layout = ArgumentLayout<std::decay_t<const Args &>...>;
+
+        LogRing &ring = GetThreadRing();
+        const size_t writeIndex = ring.writeIndex.load(std::memory_order_relaxed);
+        if (writeIndex - ring.readIndex.load(std::memory_order_acquire) >= ring.records.size()) {
+            if (ring.numDropped.load(std::memory_order_relaxed) < UINT32_MAX) {
+                ring.numDropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            return;
+        }
+
+        LogRecord &record = ring.records[writeIndex % ring.records.size()];
+        record.time = std::chrono::steady_clock::now();
+        record.format = format;
+        record.writeFunc = WriteRecord<Layout>;
+
+        Layout::Pack(record.arguments.data(), std::index_sequence_for<Args...>(), args...);
+
+        ring.writeIndex.store(writeIndex + 1, std::memory_order_release);
+    }
+
+private:
+    struct LogRecord;
+
+    using WriteRecordFunc = auto (*)(FILE *file, const LogRecord &record) -> void;
+
+    struct LogRecord {
+        std::chrono::steady_clock::time_point time;
+        const WCHAR *format;
+        WriteRecordFunc writeFunc;
+        alignas(8) std::array<BYTE, LOG_RECORD_SIZE - sizeof(std::chrono::steady_clock::time_point) - sizeof(const WCHAR *) - sizeof(WriteRecordFunc)> arguments;
+    };
+
+    struct LogRing {
+        explicit LogRing(DWORD threadId)
+            : threadId(threadId) {
+        }
+
+        const DWORD threadId;
+
+        // writeIndex is only written by the owning thread, readIndex only by the writer thread. Both only grow
+        alignas(std::hardware_destructive_interference_size) std::atomic<size_t> writeIndex = 0;
+        alignas(std::hardware_destructive_interference_size) std::atomic<size_t> readIndex = 0;
+        std::atomic<uint32_t> numDropped = 0;
+
+        std::array<LogRecord, LOG_RING_CAPACITY> records;
+    };
+
+    template <typename T>
+    static constexpr bool IS_WIDE_STRING = std::is_same_v<T, const WCHAR *> || std::is_same_v<T, WCHAR *>;
+    template <typename T>
+    static constexpr bool IS_NARROW_STRING = std::is_same_v<T, const char *> || std::is_same_v<T, char *>;
+
+    /*
+     * The position of each argument in LogRecord::arguments, decided at compile time from the argument types.
+     * Every argument starts at a multiple of 8 bytes. The space not taken by the fixed size arguments is split evenly among the strings.
+     */
+    template <typename... Args>
+    struct ArgumentLayout {
+        template <typename T>
+        static constexpr bool IS_STRING = IS_WIDE_STRING<T> || IS_NARROW_STRING<T>;
+
+        static constexpr size_t NUM_STRINGS = (static_cast<size_t>(IS_STRING<Args>) + ... + 0);
+        static constexpr size_t FIXED_SIZE = ((IS_STRING<Args> ? 0 : FFALIGN(sizeof(Args), 8)) + ... + 0);
+        static_assert(FIXED_SIZE <= sizeof(LogRecord::arguments), "Too many log arguments");
+
+        static constexpr size_t STRING_SLOT_SIZE = NUM_STRINGS == 0 ? 0 : (sizeof(LogRecord::arguments) - FIXED_SIZE) / NUM_STRINGS / 8 * 8;
+
+        static constexpr std::array<size_t, sizeof...(Args)> SIZES = { (IS_STRING<Args> ? STRING_SLOT_SIZE : FFALIGN(sizeof(Args), 8))... };
+        static constexpr std::array<size_t, sizeof...(Args)> OFFSETS = []() -> std::array<size_t, sizeof...(Args)> {
+            std::array<size_t, sizeof...(Args)> offsets {};
+            for (size_t i = 1; i < offsets.size(); ++i) {
+                offsets[i] = offsets[i - 1] + SIZES[i - 1];
+            }
+            return offsets;
+        }();
+
+        template <size_t... Is, typename... Ts>
+        static auto Pack(BYTE *arguments, std::index_sequence<Is...>, const Ts &...args) -> void {
+            (PackArgument<Args>(arguments + OFFSETS[Is], STRING_SLOT_SIZE, args), ...);
+        }
+
+        template <size_t... Is>
+        static auto Write(FILE *file, const LogRecord &record, std::index_sequence<Is...>) -> void {
+            fwprintf_s(file, record.format, UnpackArgument<Args>(record.arguments.data() + OFFSETS[Is])...);
+        }
+    };
+
+    template <typename T>
+    static auto PackArgument(BYTE *dst, size_t stringSlotSize, const T &arg) -> void {
+        if constexpr (IS_WIDE_STRING<T> || IS_NARROW_STRING<T>) {
+            using Char = std::remove_cvref_t<decltype(*arg)>;
+
+            Char *dstString = reinterpret_cast<Char *>(dst);
+            const size_t maxLength = stringSlotSize / sizeof(Char) - 1;
+            size_t length = 0;
+            if (arg != nullptr) {
+                while (length < maxLength && arg[length] != 0) {
+                    dstString[length] = arg[length];
+                    length += 1;
+                }
+            }
+            dstString[length] = 0;
+        } else {
+            static_assert(std::is_trivially_copyable_v<T>, "Log arguments must be trivially copyable");
+
+            memcpy(dst, &arg, sizeof(T));
+        }
+    }
+
+    template <typename T>
+    static auto UnpackArgument(const BYTE *src) -> std::conditional_t<IS_WIDE_STRING<T>, const WCHAR *, std::conditional_t<IS_NARROW_STRING<T>, const char *, T>> {
+        if constexpr (IS_WIDE_STRING<T>) {
+            return reinterpret_cast<const WCHAR *>(src);
+        } else if constexpr (IS_NARROW_STRING<T>) {
+            return reinterpret_cast<const char *>(src);
+        } else {
+            T arg;
+            memcpy(&arg, src, sizeof(T));
+            return arg;
+        }
+    }
+
+    template <typename Layout>
+    static auto WriteRecord(FILE *file, const LogRecord &record) -> void {
+        Layout::Write(file, record, std::make_index_sequence<Layout::SIZES.size()>());
+    }
+
+    auto GetThreadRing() -> LogRing &;
+    auto WriterProc() -> void;
+    auto WriteRecords() -> void;
+
+    FILE *_file;
+    const std::chrono::steady_clock::time_point _startTime;
+
+    // distinguishes the rings registered to this logger from the ones of a previous instance in the thread_local storage
+    const uint64_t _id;
+
+    std::mutex _ringsMutex;
+    std::vector<std::shared_ptr<LogRing>> _rings;
+
+    std::mutex _writerMutex;
+    std::condition_variable _writerCv;
+    bool _isStopping = false;
+    std::thread _writerThread;
+};
+
+}
@@ -7,12 +7,43 @@
 
 namespace SynthFilter {
 
+// severity of log records. Each level includes the ones before it
+enum class LogLevel {
+    None = 0,
+    Error,
+    Info,
+    // per frame records
+    Trace,
+    // start and end of every conversion kernel
+    Kernel,
+};
+
+// stages of the frame pipeline whose latencies are measured
+enum class PipelineStage {
+    // upstream thread waiting for room in the source frame queue
+    UpstreamWait = 0,
+    CreateFrame,
+    // from requesting an output frame from the script until it is ready
+    GetFrame,
+    WriteSample,
+    GetDeliveryBuffer,
+    Deliver,
+    // from starting the stream or seeking until the first output sample is delivered
+    FirstFrame,
+};
+
 namespace {
 
 const GUID MEDIASUBTYPE_I420                                  = FOURCCMap('024I');
 const GUID MEDIASUBTYPE_YV24                                  = FOURCCMap('42VY');
 const GUID MEDIASUBTYPE_Y410                                  = FOURCCMap('014Y');
 const GUID MEDIASUBTYPE_Y416                                  = FOURCCMap('614Y');
+// FourCCs of the 16-bit RGB formats from LAV Filters: "RGB" followed by the bits per pixel (48 and 64) as a character
+const GUID MEDIASUBTYPE_RGB48                                 = FOURCCMap('0BGR');
+const GUID MEDIASUBTYPE_RGB64                                 = FOURCCMap('@ABR');
+const GUID MEDIASUBTYPE_Y210                                  = FOURCCMap('012Y');
+const GUID MEDIASUBTYPE_Y216                                  = FOURCCMap('612Y');
+const GUID MEDIASUBTYPE_v210                                  = FOURCCMap('012v');
 
 #define SETTINGS_NAME_SUFFIX                                    " Settings"
 #define STATUS_NAME_SUFFIX                                      " Status"
@@ -25,12 +56,63 @@ const GUID MEDIASUBTYPE_Y416                                  = FOURCCMap('614Y'
 constexpr const int MINIMUM_AVISYNTH_PLUS_INTERFACE_VERSION   = 7;
 constexpr const DWORD SAMPLE2_TYPE_SPECIFIC_FLAGS_SIZE        = offsetof(AM_SAMPLE2_PROPERTIES, dwSampleFlags);
 
-constexpr const double EXTRA_SRC_BUFFER_CHANGE_THRESHOLD      = 0.1;
 constexpr const int INITIAL_SRC_BUFFER                        = 2;
 constexpr const int MIN_EXTRA_SRC_BUFFER                      = 0;
-constexpr const int EXTRA_SRC_BUFFER_DEC_STEP                 = 1;
 constexpr const int MAX_EXTRA_SRC_BUFFER                      = 15;
-constexpr const int EXTRA_SRC_BUFFER_INC_STEP                 = 2;
+
+/*
+ * The extra source buffer is sized to cover SRC_BUFFER_LEAD_TIME milliseconds ahead of the script, plus the measured script latency,
+ * plus SRC_BUFFER_JITTER_MULTIPLIER times the mean deviations of the script and decoder latencies.
+ * The buffered source frames take at most MAX_SRC_BUFFER_MEMORY MiB, which matters for high resolutions. 0 means no limit.
+ */
+constexpr const int SRC_BUFFER_LEAD_TIME                      = 100;
+constexpr const int MAX_SRC_BUFFER_MEMORY                     = 512;
+constexpr const double SRC_BUFFER_JITTER_MULTIPLIER           = 4;
+constexpr const std::chrono::milliseconds SRC_BUFFER_SHRINK_INTERVAL(500);
+
+/*
+ * Maximum number of source frames in the queue, including the ones waiting for conversion. The receiving thread blocks when the queue is full.
+ * It is far above the INITIAL_SRC_BUFFER and MAX_EXTRA_SRC_BUFFER of any sane configuration, since a script
+ * that waits for a source frame beyond the capacity would stall the pipeline.
+ * Each slot without frame only takes tens of bytes.
+ */
+constexpr const size_t SOURCE_FRAME_RING_CAPACITY             = 256;
+
+// received samples are held until the conversion thread converts them, so the upstream needs spare buffers to keep decoding meanwhile
+constexpr const long MIN_INPUT_SAMPLE_BUFFERS                 = 4;
+
+/*
+ * Frame conversions are split into bands of rows and run on the thread pool.
+ * 0 thread means picking automatically from the number of logical processors, up to MAX_AUTO_CONVERSION_THREADS.
+ * Memory bandwidth saturates after a few cores, so more threads would only take CPU time from the script.
+ * Bands are at least MIN_CONVERSION_BAND_SIZE bytes of the DirectShow frame, so small frames stay single-threaded.
+ */
+constexpr const int CONVERSION_THREADS                        = 0;
+constexpr const int MAX_AUTO_CONVERSION_THREADS               = 4;
+constexpr const int MIN_CONVERSION_BAND_SIZE                  = 1024 * 1024;
+
+/*
+ * Number of output frames that the AviSynth worker requests ahead of the delivery, each on a helper thread.
+ * It only applies to scripts that declare MT modes with Prefetch(). Other scripts, or values lower than 2, get the frames one at a time on the worker thread.
+ */
+constexpr const int OUTPUT_PREFETCH                           = 4;
+constexpr const int MAX_OUTPUT_PREFETCH                       = 16;
+
+/*
+ * Number of output samples that can wait in the queue to be delivered downstream by a separate thread.
+ * 0 delivers every sample on the worker thread, which waits until the downstream accepts it.
+ * The queued samples are sent with ReceiveMultiple() in batches of up to MAX_OUTPUT_QUEUE_BATCH_SIZE, and never more than the depth.
+ */
+constexpr const int OUTPUT_QUEUE_DEPTH                        = 0;
+constexpr const int MAX_OUTPUT_QUEUE_DEPTH                    = 16;
+constexpr const int MAX_OUTPUT_QUEUE_BATCH_SIZE               = 4;
+
+/*
+ * Planes of at least this size are copied with non-temporal stores instead of the frame server's BitBlt().
+ * Such planes are unlikely to stay in the cache until they are read, so writing them around the cache saves the read-for-ownership traffic.
+ * Smaller planes are likely still cached when the script or the renderer reads them.
+ */
+constexpr const int MIN_STREAMING_COPY_PLANE_SIZE             = 4 * 1024 * 1024;
 
 /*
  * If an output frame's stop time is this value close to the the next source frame's
@@ -59,8 +141,38 @@ constexpr const int NUM_FRAMES_FOR_INFINITE_STREAM            = 10810800;
 /*
  * align stride of input media type to this number so that LAV Filters can enable its "direct" mode
  * for better performance.
+ * The conversion kernels handle any stride, so reconnecting the input for the alignment is opt-in.
+ * A reconnection adds startup latency and may also force some decoders out of their "direct" mode.
  */
 constexpr const int MEDIA_SAMPLE_STRIDE_ALGINMENT             = 32;
+constexpr const bool ALIGN_INPUT_STRIDE                       = false;
+
+/*
+ * Keeping the script through seeks saves evaluating it again, but the script still holds the frames before the seek in its caches.
+ * Instead of clearing the caches, the source frames after the seek are numbered after every number the script has requested,
+ * plus KEPT_SCRIPT_FRAME_NB_MARGIN for the frames that the script might still request on its own, such as by the prefetchers of AviSynth+.
+ * Once the numbers pass half of NUM_FRAMES_FOR_INFINITE_STREAM, the script is reloaded to number from 0 again.
+ */
+constexpr const bool KEEP_SCRIPT_ON_SEEK                      = false;
+constexpr const int KEPT_SCRIPT_FRAME_NB_MARGIN               = 1000;
+
+/*
+ * A script swapped in while streaming can hold the frames of the scripts it replaces in its caches, so the replaced frameservers
+ * are only released after the script is stopped. Once MAX_SCRIPT_SWAP_PREDECESSORS of them are kept, the next change of the script
+ * restarts the stream instead, which releases them all.
+ */
+constexpr const int MAX_SCRIPT_SWAP_PREDECESSORS              = 2;
+
+/*
+ * The output format of the script is probed for every input format when building the graph. The results are cached in the settings,
+ * keyed by the script path and the source format, and valid as long as the modification time and the size of the script file stay the same.
+ * Changes to the files imported by the script are not detected, thus the cache can be turned off.
+ *
+ * The cache has PROBE_CACHE_NUM_SLOTS entries. Each key maps to one slot, which stores the full key along with the result,
+ * so that a key taking over the slot of another evicts it instead of reusing its result.
+ */
+constexpr const bool CACHE_SCRIPT_PROBES                      = true;
+constexpr const uint64_t PROBE_CACHE_NUM_SLOTS                = 64;
 
 /*
  * AviSynth+ and VapourSynth frame property names
@@ -76,16 +188,61 @@ constexpr const char *FRAME_PROP_NAME_TYPE_SPECIFIC_FLAGS     = "AVSF_TypeSpecif
 constexpr const WCHAR *REGISTRY_KEY_NAME_PREFIX               = L"Software\\AviSynthFilter\\";
 constexpr const WCHAR *SETTING_NAME_SCRIPT_FILE               = L"ScriptFile";
 constexpr const WCHAR *SETTING_NAME_LOG_FILE                  = L"LogFile";
+constexpr const WCHAR *SETTING_NAME_LOG_LEVEL                 = L"LogLevel";
+constexpr const WCHAR *SETTING_NAME_TRACE_FILE                = L"TraceFile";
 constexpr const WCHAR *SETTING_NAME_INPUT_FORMAT_PREFIX       = L"InputFormat_";
 constexpr const WCHAR *SETTING_NAME_REMOTE_CONTROL            = L"RemoteControl";
 constexpr const WCHAR *SETTING_NAME_INITIAL_SRC_BUFFER        = L"InitialSrcBuffer";
 constexpr const WCHAR *SETTING_NAME_MIN_EXTRA_SRC_BUFFER      = L"MinExtraSrcBuffer";
 constexpr const WCHAR *SETTING_NAME_MAX_EXTRA_SRC_BUFFER      = L"MaxExtraSrcBuffer";
-constexpr const WCHAR *SETTING_NAME_EXTRA_SRC_BUFFER_DEC_STEP = L"ExtraSrcBufferDecStep";
-constexpr const WCHAR *SETTING_NAME_EXTRA_SRC_BUFFER_INC_STEP = L"ExtraSrcBufferIncStep";
+constexpr const WCHAR *SETTING_NAME_SRC_BUFFER_LEAD_TIME      = L"SrcBufferLeadTime";
+constexpr const WCHAR *SETTING_NAME_MAX_SRC_BUFFER_MEMORY     = L"MaxSrcBufferMemory";
+constexpr const WCHAR *SETTING_NAME_CONVERSION_THREADS        = L"ConversionThreads";
+constexpr const WCHAR *SETTING_NAME_OUTPUT_PREFETCH           = L"OutputPrefetch";
+constexpr const WCHAR *SETTING_NAME_OUTPUT_QUEUE_DEPTH        = L"OutputQueueDepth";
+constexpr const WCHAR *SETTING_NAME_ALIGN_INPUT_STRIDE        = L"AlignInputStride";
+constexpr const WCHAR *SETTING_NAME_KEEP_SCRIPT_ON_SEEK       = L"KeepScriptOnSeek";
+constexpr const WCHAR *SETTING_NAME_CACHE_SCRIPT_PROBES       = L"CacheScriptProbes";
+constexpr const WCHAR *SETTING_NAME_PROBE_CACHE_PREFIX        = L"ProbeCache_";
 
 constexpr const int REMOTE_CONTROL_SMTO_TIMEOUT_MS            = 1000;
 
+/*
+ * Latencies are counted in microseconds into log-linear buckets. Each power of 2 range is split into 2^LATENCY_HISTOGRAM_SUB_BUCKET_BITS linear buckets,
+ * so the reported percentiles are at most 1 / 2^LATENCY_HISTOGRAM_SUB_BUCKET_BITS above the true value.
+ * Latencies from 2^LATENCY_HISTOGRAM_MAX_MAGNITUDE microseconds (about 2 minutes) are counted in the last bucket.
+ */
+constexpr const int NUM_PIPELINE_STAGES                       = static_cast<int>(PipelineStage::FirstFrame) + 1;
+constexpr const int LATENCY_HISTOGRAM_SUB_BUCKET_BITS         = 4;
+constexpr const int LATENCY_HISTOGRAM_MAX_MAGNITUDE           = 27;
+
+/*
+ * Log records above the level in the LogLevel setting are skipped at runtime.
+ * Records above MAX_COMPILED_LOG_LEVEL do not exist in the build at all, so the kernels are free of logging in release builds.
+ * The arguments of a skipped record are still evaluated, thus the ones on the frame path that cost more than a copy
+ * are guarded by Environment::IsLogEnabled().
+ */
+constexpr const LogLevel LOG_LEVEL                            = LogLevel::Info;
+#ifdef _DEBUG
+constexpr const LogLevel MAX_COMPILED_LOG_LEVEL               = LogLevel::Kernel;
+#else
+constexpr const LogLevel MAX_COMPILED_LOG_LEVEL               = LogLevel::Trace;
+#endif
+
+/*
+ * Each logging thread has a ring of LOG_RING_CAPACITY records, each LOG_RECORD_SIZE bytes including the arguments.
+ * The log writer drains the rings every LOG_WRITE_INTERVAL. A thread logging faster than the ring can hold between two writes has its records dropped.
+ */
+constexpr const size_t LOG_RECORD_SIZE                        = 512;
+constexpr const size_t LOG_RING_CAPACITY                      = 1024;
+constexpr const std::chrono::milliseconds LOG_WRITE_INTERVAL(100);
+
+/*
+ * The frame tracer writes its buffered events when the streaming stops. Until then, each thread buffers up to this number of events.
+ * One event takes 32 bytes.
+ */
+constexpr const size_t TRACE_MAX_EVENTS_PER_THREAD            = 256 * 1024;
+
 }
 
 }
@@ -30,12 +30,13 @@ Environment::Environment()
         MessageBoxW(nullptr, L"Unload to load settings", FILTER_NAME_FULL, MB_ICONERROR);
     }
 
-    if (!_logPath.empty()) {
+    if (!_logPath.empty() && _logLevel != LogLevel::None) {
         _logFile = _wfsopen(_logPath.c_str(), L"w", _SH_DENYNO);
         if (_logFile != nullptr) {
-            _logStartTime = std::chrono::steady_clock::now();
+            _logger = std::make_unique<AsyncLogger>(_logFile);
 
             Log(L"Filter version: %hs", FILTER_VERSION_STRING);
+            Log(L"Log level: %d", static_cast<int>(_logLevel));
             Log(L"Configured script file: %ls", _scriptPath.filename().c_str());
 
             std::ranges::for_each(
@@ -49,13 +50,35 @@ Environment::Environment()
         }
     }
 
-    Log(L"Active CPU feature: %ls", IsSupportAVX2() ? L"AVX2" : (IsSupportSSE4() ? L"SSE4" : L"Basic"));
+    if (!_tracePath.empty()) {
+        _traceFile = _wfsopen(_tracePath.c_str(), L"w", _SH_DENYNO);
+        if (_traceFile != nullptr) {
+            _tracer = std::make_unique<FrameTracer>(_traceFile);
+        }
+    }
+
+    // without a log file, every record is skipped by the level check alone
+    if (_logFile == nullptr) {
+        _logLevel = LogLevel::None;
+    }
+
+    Log(L"Active CPU feature: %ls", IsSupportAVX512() ? L"AVX-512" : (IsSupportAVX2() ? L"AVX2" : (IsSupportSSE4() ? L"SSE4" : L"Basic")));
 }
 
 Environment::~Environment() {
+    // the logger writes the remaining records before closing the file
+    _logger.reset();
+
     if (_logFile != nullptr) {
         fclose(_logFile);
     }
+
+    // the tracer writes the remaining events and closes the JSON array
+    _tracer.reset();
+
+    if (_traceFile != nullptr) {
+        fclose(_traceFile);
+    }
 }
 
 auto Environment::SaveSettings() const -> void {
@@ -99,6 +122,30 @@ auto Environment::SetInputFormatEnabled(std::wstring_view formatName, bool enabl
     }
 }
 
+auto Environment::ReadProbeCacheEntry(std::wstring_view name) const -> std::wstring {
+    const std::wstring settingName = std::format(L"{}{}", SETTING_NAME_PROBE_CACHE_PREFIX, name);
+    const std::unique_lock probeCacheLock(_probeCacheMutex);
+
+    if (_useIni) {
+        return _ini.GetValue(L"", settingName.c_str(), L"");
+    }
+
+    return _registry.ReadString(settingName.c_str());
+}
+
+auto Environment::WriteProbeCacheEntry(std::wstring_view name, std::wstring_view value) -> void {
+    const std::wstring settingName = std::format(L"{}{}", SETTING_NAME_PROBE_CACHE_PREFIX, name);
+    const std::unique_lock probeCacheLock(_probeCacheMutex);
+
+    // unlike the settings, the entries are saved right away, since they are not applied from the property page
+    if (_useIni) {
+        _ini.SetValue(L"", settingName.c_str(), std::wstring(value).c_str());
+        SaveSettingsToIni();
+    } else if (_registry) {
+        static_cast<void>(_registry.WriteString(settingName.c_str(), value));
+    }
+}
+
 auto Environment::LoadSettingsFromIni() -> void {
     _scriptPath = _ini.GetValue(L"", SETTING_NAME_SCRIPT_FILE, L"");
 
@@ -111,13 +158,29 @@ auto Environment::LoadSettingsFromIni() -> void {
 
     _isRemoteControlEnabled = _ini.GetBoolValue(L"", SETTING_NAME_REMOTE_CONTROL, false);
     _logPath = _ini.GetValue(L"", SETTING_NAME_LOG_FILE, L"");
+    _logLevel = static_cast<LogLevel>(_ini.GetLongValue(L"", SETTING_NAME_LOG_LEVEL, static_cast<long>(LOG_LEVEL)));
+    ValidateLogLevel();
+    _tracePath = _ini.GetValue(L"", SETTING_NAME_TRACE_FILE, L"");
 
     _initialSrcBuffer = _ini.GetLongValue(L"", SETTING_NAME_INITIAL_SRC_BUFFER, INITIAL_SRC_BUFFER);
     _minExtraSrcBuffer = _ini.GetLongValue(L"", SETTING_NAME_MIN_EXTRA_SRC_BUFFER, MIN_EXTRA_SRC_BUFFER);
     _maxExtraSrcBuffer = _ini.GetLongValue(L"", SETTING_NAME_MAX_EXTRA_SRC_BUFFER, MAX_EXTRA_SRC_BUFFER);
-    _extraSrcBufferDecStep = _ini.GetLongValue(L"", SETTING_NAME_EXTRA_SRC_BUFFER_DEC_STEP, EXTRA_SRC_BUFFER_DEC_STEP);
-    _extraSrcBufferIncStep = _ini.GetLongValue(L"", SETTING_NAME_EXTRA_SRC_BUFFER_INC_STEP, EXTRA_SRC_BUFFER_INC_STEP);
+    _srcBufferLeadTime = _ini.GetLongValue(L"", SETTING_NAME_SRC_BUFFER_LEAD_TIME, SRC_BUFFER_LEAD_TIME);
+    _maxSrcBufferMemory = _ini.GetLongValue(L"", SETTING_NAME_MAX_SRC_BUFFER_MEMORY, MAX_SRC_BUFFER_MEMORY);
     ValidateExtraSrcBufferValues();
+
+    _conversionThreads = _ini.GetLongValue(L"", SETTING_NAME_CONVERSION_THREADS, CONVERSION_THREADS);
+    ValidateConversionThreads();
+
+    _outputPrefetch = _ini.GetLongValue(L"", SETTING_NAME_OUTPUT_PREFETCH, OUTPUT_PREFETCH);
+    ValidateOutputPrefetch();
+
+    _outputQueueDepth = _ini.GetLongValue(L"", SETTING_NAME_OUTPUT_QUEUE_DEPTH, OUTPUT_QUEUE_DEPTH);
+    ValidateOutputQueueDepth();
+
+    _isInputStrideAligned = _ini.GetBoolValue(L"", SETTING_NAME_ALIGN_INPUT_STRIDE, ALIGN_INPUT_STRIDE);
+    _isScriptKeptOnSeek = _ini.GetBoolValue(L"", SETTING_NAME_KEEP_SCRIPT_ON_SEEK, KEEP_SCRIPT_ON_SEEK);
+    _isScriptProbeCached = _ini.GetBoolValue(L"", SETTING_NAME_CACHE_SCRIPT_PROBES, CACHE_SCRIPT_PROBES);
 }
 
 auto Environment::LoadSettingsFromRegistry() -> void {
@@ -132,21 +195,55 @@ auto Environment::LoadSettingsFromRegistry() -> void {
 
     _isRemoteControlEnabled = _registry.ReadNumber(SETTING_NAME_REMOTE_CONTROL, 0) != 0;
     _logPath = _registry.ReadString(SETTING_NAME_LOG_FILE);
+    _logLevel = static_cast<LogLevel>(_registry.ReadNumber(SETTING_NAME_LOG_LEVEL, static_cast<int>(LOG_LEVEL)));
+    ValidateLogLevel();
+    _tracePath = _registry.ReadString(SETTING_NAME_TRACE_FILE);
 
     _initialSrcBuffer = _registry.ReadNumber(SETTING_NAME_INITIAL_SRC_BUFFER, INITIAL_SRC_BUFFER);
     _minExtraSrcBuffer = _registry.ReadNumber(SETTING_NAME_MIN_EXTRA_SRC_BUFFER, MIN_EXTRA_SRC_BUFFER);
     _maxExtraSrcBuffer = _registry.ReadNumber(SETTING_NAME_MAX_EXTRA_SRC_BUFFER, MAX_EXTRA_SRC_BUFFER);
-    _extraSrcBufferDecStep = _registry.ReadNumber(SETTING_NAME_EXTRA_SRC_BUFFER_DEC_STEP, EXTRA_SRC_BUFFER_DEC_STEP);
-    _extraSrcBufferIncStep = _registry.ReadNumber(SETTING_NAME_EXTRA_SRC_BUFFER_INC_STEP, EXTRA_SRC_BUFFER_INC_STEP);
+    _srcBufferLeadTime = _registry.ReadNumber(SETTING_NAME_SRC_BUFFER_LEAD_TIME, SRC_BUFFER_LEAD_TIME);
+    _maxSrcBufferMemory = _registry.ReadNumber(SETTING_NAME_MAX_SRC_BUFFER_MEMORY, MAX_SRC_BUFFER_MEMORY);
     ValidateExtraSrcBufferValues();
+
+    _conversionThreads = _registry.ReadNumber(SETTING_NAME_CONVERSION_THREADS, CONVERSION_THREADS);
+    ValidateConversionThreads();
+
+    _outputPrefetch = _registry.ReadNumber(SETTING_NAME_OUTPUT_PREFETCH, OUTPUT_PREFETCH);
+    ValidateOutputPrefetch();
+
+    _outputQueueDepth = _registry.ReadNumber(SETTING_NAME_OUTPUT_QUEUE_DEPTH, OUTPUT_QUEUE_DEPTH);
+    ValidateOutputQueueDepth();
+
+    _isInputStrideAligned = _registry.ReadNumber(SETTING_NAME_ALIGN_INPUT_STRIDE, ALIGN_INPUT_STRIDE) != 0;
+    _isScriptKeptOnSeek = _registry.ReadNumber(SETTING_NAME_KEEP_SCRIPT_ON_SEEK, KEEP_SCRIPT_ON_SEEK) != 0;
+    _isScriptProbeCached = _registry.ReadNumber(SETTING_NAME_CACHE_SCRIPT_PROBES, CACHE_SCRIPT_PROBES) != 0;
 }
 
 auto Environment::ValidateExtraSrcBufferValues() -> void {
     _initialSrcBuffer = std::max(_initialSrcBuffer, 2);
     _minExtraSrcBuffer = std::max(_minExtraSrcBuffer, 0);
     _maxExtraSrcBuffer = std::max(_maxExtraSrcBuffer, _minExtraSrcBuffer);
-    _extraSrcBufferDecStep = std::max(_extraSrcBufferDecStep, 0);
-    _extraSrcBufferIncStep = std::max(_extraSrcBufferIncStep, 0);
+    _srcBufferLeadTime = std::max(_srcBufferLeadTime, 0);
+    _maxSrcBufferMemory = std::max(_maxSrcBufferMemory, 0);
+}
+
+auto Environment::ValidateConversionThreads() -> void {
+    if (_conversionThreads <= 0) {
+        _conversionThreads = std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1, MAX_AUTO_CONVERSION_THREADS);
+    }
+}
+
+auto Environment::ValidateOutputPrefetch() -> void {
+    _outputPrefetch = std::clamp(_outputPrefetch, 1, MAX_OUTPUT_PREFETCH);
+}
+
+auto Environment::ValidateOutputQueueDepth() -> void {
+    _outputQueueDepth = std::clamp(_outputQueueDepth, 0, MAX_OUTPUT_QUEUE_DEPTH);
+}
+
+auto Environment::ValidateLogLevel() -> void {
+    _logLevel = std::clamp(_logLevel, LogLevel::None, MAX_COMPILED_LOG_LEVEL);
 }
 
 auto Environment::SaveSettingsToIni() const -> void {
@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include "async_logger.h"
+#include "frame_tracer.h"
 #include "registry.h"
 #include "singleton.h"
 
@@ -17,19 +19,47 @@ public:
 
     auto SaveSettings() const -> void;
 
-    template <typename... Args>
-    constexpr auto Log(std::wstring_view format, Args &&...args) -> void {
-        if (_logFile == nullptr) {
-            return;
+    template <LogLevel level>
+    constexpr auto IsLogEnabled() const -> bool {
+        if constexpr (level <= MAX_COMPILED_LOG_LEVEL) {
+            // _logLevel stays None without a logger
+            return level <= _logLevel;
+        } else {
+            return false;
         }
+    }
 
-        const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - _logStartTime;
-        const std::wstring logTemplate = std::format(L"T {:6d} @ {:11d}: {}\n", GetCurrentThreadId(), std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count(), format);
+    // format must be a string literal, see AsyncLogger::Log()
+    template <LogLevel level = LogLevel::Info, typename... Args>
+    constexpr auto Log(const WCHAR *format, const Args &...args) -> void {
+        if (IsLogEnabled<level>()) {
+            _logger->Log(format, args...);
+        }
+    }
 
-        const std::unique_lock logLock(_logMutex);
+    // name must be a string literal, see FrameTracer::AddCompleteEvent()
+    auto TraceComplete(const char *name, int frameNb, std::chrono::steady_clock::time_point startTime) -> void {
+        if (_tracer != nullptr) {
+            _tracer->AddCompleteEvent(name, frameNb, startTime);
+        }
+    }
 
-        fwprintf_s(_logFile, logTemplate.c_str(), std::forward<Args>(args)...);
-        fflush(_logFile);
+    auto TraceAsync(const char *name, int frameNb, std::chrono::steady_clock::time_point startTime) -> void {
+        if (_tracer != nullptr) {
+            _tracer->AddAsyncEvent(name, frameNb, startTime);
+        }
+    }
+
+    auto TraceInstant(const char *name, int frameNb) -> void {
+        if (_tracer != nullptr) {
+            _tracer->AddInstantEvent(name, frameNb);
+        }
+    }
+
+    auto FlushTrace() -> void {
+        if (_tracer != nullptr) {
+            _tracer->Flush();
+        }
     }
 
     constexpr auto GetScriptPath() const -> const std::filesystem::path & { return _scriptPath; }
@@ -38,23 +68,38 @@ public:
     auto SetInputFormatEnabled(std::wstring_view formatName, bool enabled) -> void;
     constexpr auto IsRemoteControlEnabled() const -> bool { return _isRemoteControlEnabled; }
     auto SetRemoteControlEnabled(bool enabled) -> void;
+    constexpr auto IsSupportAVX512() const -> bool { return std::__isa_available >= __ISA_AVAILABLE_AVX512; }
     constexpr auto IsSupportAVX2() const -> bool { return std::__isa_available >= __ISA_AVAILABLE_AVX2; }
     constexpr auto IsSupportSSE4() const -> bool { return std::__isa_available >= __ISA_AVAILABLE_SSE42; }
     constexpr auto GetInitialSrcBuffer() const -> int { return _initialSrcBuffer; }
     constexpr auto GetMinExtraSrcBuffer() const -> int { return _minExtraSrcBuffer; }
     constexpr auto GetMaxExtraSrcBuffer() const -> int { return _maxExtraSrcBuffer; }
-    constexpr auto GetExtraSrcBufferDecStep() const -> int { return _extraSrcBufferDecStep; }
-    constexpr auto GetExtraSrcBufferIncStep() const -> int { return _extraSrcBufferIncStep; }
+    constexpr auto GetSrcBufferLeadTime() const -> int { return _srcBufferLeadTime; }
+    constexpr auto GetMaxSrcBufferMemory() const -> int { return _maxSrcBufferMemory; }
+    constexpr auto GetConversionThreads() const -> int { return _conversionThreads; }
+    constexpr auto GetOutputPrefetch() const -> int { return _outputPrefetch; }
+    constexpr auto GetOutputQueueDepth() const -> int { return _outputQueueDepth; }
+    constexpr auto IsInputStrideAligned() const -> bool { return _isInputStrideAligned; }
+    constexpr auto IsScriptKeptOnSeek() const -> bool { return _isScriptKeptOnSeek; }
+    constexpr auto IsScriptProbeCached() const -> bool { return _isScriptProbeCached; }
+    auto ReadProbeCacheEntry(std::wstring_view name) const -> std::wstring;
+    auto WriteProbeCacheEntry(std::wstring_view name, std::wstring_view value) -> void;
 
 private:
     auto LoadSettingsFromIni() -> void;
     auto LoadSettingsFromRegistry() -> void;
     auto ValidateExtraSrcBufferValues() -> void;
+    auto ValidateConversionThreads() -> void;
+    auto ValidateOutputPrefetch() -> void;
+    auto ValidateOutputQueueDepth() -> void;
+    auto ValidateLogLevel() -> void;
     auto SaveSettingsToIni() const -> void;
     auto SaveSettingsToRegistry() const -> void;
 
     bool _useIni = false;
     CSimpleIniW _ini;
+    // the probe cache entries are accessed by the concurrent probes
+    mutable std::mutex _probeCacheMutex;
     std::filesystem::path _iniPath;
 
     Registry _registry;
@@ -65,13 +110,23 @@ private:
     int _initialSrcBuffer;
     int _minExtraSrcBuffer;
     int _maxExtraSrcBuffer;
-    int _extraSrcBufferDecStep;
-    int _extraSrcBufferIncStep;
+    int _srcBufferLeadTime;
+    int _maxSrcBufferMemory;
+    int _conversionThreads;
+    int _outputPrefetch;
+    int _outputQueueDepth;
+    bool _isInputStrideAligned;
+    bool _isScriptKeptOnSeek;
+    bool _isScriptProbeCached;
 
     std::filesystem::path _logPath;
+    LogLevel _logLevel = LogLevel::None;
     FILE *_logFile = nullptr;
-    std::chrono::steady_clock::time_point _logStartTime;
-    std::mutex _logMutex;
+    std::unique_ptr<AsyncLogger> _logger;
+
+    std::filesystem::path _tracePath;
+    FILE *_traceFile = nullptr;
+    std::unique_ptr<FrameTracer> _tracer;
 };
 
 }
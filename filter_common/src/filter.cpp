@@ -7,6 +7,7 @@
 #include "macros.h"
 #include "prop_settings.h"
 #include "prop_status.h"
+#include "thread_pool.h"
 
 
 namespace SynthFilter {
@@ -15,6 +16,7 @@ CSynthFilter::CSynthFilter(LPUNKNOWN pUnk, HRESULT *phr)
     : CVideoTransformFilter(FILTER_NAME_FULL, pUnk, __uuidof(CSynthFilter)) {
     if (_numFilterInstances == 0) {
         Environment::Create();
+        ThreadPool::Create();
         FrameServerCommon::Create();
         MainFrameServer::Create().LinkSynthFilter(this);
         AuxFrameServer::Create();
@@ -35,6 +37,7 @@ CSynthFilter::~CSynthFilter() {
         AuxFrameServer::Destroy();
         MainFrameServer::Destroy();
         FrameServerCommon::Destroy();
+        ThreadPool::Destroy();
         Environment::Destroy();
     }
 }
@@ -79,31 +82,24 @@ auto CSynthFilter::CheckConnect(PIN_DIRECTION direction, IPin *pPin) -> HRESULT
         ATL::CComPtr<IEnumMediaTypes> enumTypes;
         CheckHr(pPin->EnumMediaTypes(&enumTypes));
 
+        struct FormatProbe {
+            std::shared_ptr<AM_MEDIA_TYPE> inputMediaType;
+            const Format::PixelFormat *inputPixelFormat;
+            std::unique_ptr<AuxFrameServer> frameServer;
+            bool result = false;
+        };
+        std::vector<FormatProbe> probes;
+
         AM_MEDIA_TYPE *nextType;
         while (true) {
             hr = enumTypes->Next(1, &nextType, nullptr);
             if (hr == S_OK) {
-                const std::shared_ptr<AM_MEDIA_TYPE> nextTypePtr(nextType, &DeleteMediaType);
+                std::shared_ptr<AM_MEDIA_TYPE> nextTypePtr(nextType, &DeleteMediaType);
 
                 if (const Format::PixelFormat *optInputPixelFormat = GetInputPixelFormat(nextType);
-                    optInputPixelFormat && std::ranges::find(_compatibleMediaTypes, optInputPixelFormat, &MediaTypePair::inputPixelFormat) == _compatibleMediaTypes.end()) {
-                    // invoke the script with each supported input pixel format, and observe the output frameserver format
-                    if (!AuxFrameServer::GetInstance().ReloadScript(*nextType, Environment::GetInstance().IsRemoteControlEnabled())) {
-                        Environment::GetInstance().Log(L"Disconnect filter by user request");
-                        _disconnectFilter = true;
-                        return VFW_E_TYPE_NOT_ACCEPTED;
-                    }
-
-                    // all media types that share the same frameserver format are acceptable for output pin connection
-                    const int scriptFormatId = AuxFrameServer::GetInstance().GetScriptPixelType();
-                    for (const Format::PixelFormat &frameServerPixelFormat : Format::LookupFrameServerFormatId(scriptFormatId)) {
-                        const CMediaType outputMediaType = AuxFrameServer::GetInstance().GenerateMediaType(frameServerPixelFormat, nextType);
-                        _compatibleMediaTypes.emplace_back(nextTypePtr, optInputPixelFormat, outputMediaType, MediaTypeToPixelFormat(&outputMediaType));
-                        if (std::ranges::find(_availableOutputMediaTypes, outputMediaType) == _availableOutputMediaTypes.end()) {
-                            _availableOutputMediaTypes.emplace_back(outputMediaType);
-                        }
-                        Environment::GetInstance().Log(L"Add compatible formats: input %5ls output %5ls", optInputPixelFormat->name, frameServerPixelFormat.name);
-                    }
+                    optInputPixelFormat && std::ranges::find(_compatibleMediaTypes, optInputPixelFormat, &MediaTypePair::inputPixelFormat) == _compatibleMediaTypes.end()
+                    && std::ranges::find(probes, optInputPixelFormat, &FormatProbe::inputPixelFormat) == probes.end()) {
+                    probes.emplace_back(std::move(nextTypePtr), optInputPixelFormat, std::make_unique<AuxFrameServer>());
                 }
             } else if (hr == VFW_E_ENUM_OUT_OF_SYNC) {
                 CheckHr(enumTypes->Reset());
@@ -111,6 +107,34 @@ auto CSynthFilter::CheckConnect(PIN_DIRECTION direction, IPin *pPin) -> HRESULT
                 break;
             }
         }
+
+        // invoke the script with each supported input pixel format, and observe the output frameserver format
+        // each probe has its own frameserver instance, so that the evaluations run concurrently instead of one after another
+        const bool ignoreDisconnect = Environment::GetInstance().IsRemoteControlEnabled();
+        ThreadPool::GetInstance().Run(static_cast<int>(probes.size()), [&probes, ignoreDisconnect](int probeIndex) -> void {
+            FormatProbe &probe = probes[probeIndex];
+            probe.result = probe.frameServer->ReloadScript(*probe.inputMediaType, ignoreDisconnect);
+        });
+
+        if (std::ranges::any_of(probes, [](const FormatProbe &probe) -> bool { return !probe.result; })) {
+            Environment::GetInstance().Log(L"Disconnect filter by user request");
+            _disconnectFilter = true;
+            return VFW_E_TYPE_NOT_ACCEPTED;
+        }
+
+        // collect in the enumeration order, which is the preference order of the upstream
+        for (const FormatProbe &probe : probes) {
+            // all media types that share the same frameserver format are acceptable for output pin connection
+            const int scriptFormatId = probe.frameServer->GetScriptPixelType();
+            for (const Format::PixelFormat &frameServerPixelFormat : Format::LookupFrameServerFormatId(scriptFormatId)) {
+                const CMediaType outputMediaType = probe.frameServer->GenerateMediaType(frameServerPixelFormat, probe.inputMediaType.get());
+                _compatibleMediaTypes.emplace_back(probe.inputMediaType, probe.inputPixelFormat, outputMediaType, MediaTypeToPixelFormat(&outputMediaType));
+                if (std::ranges::find(_availableOutputMediaTypes, outputMediaType) == _availableOutputMediaTypes.end()) {
+                    _availableOutputMediaTypes.emplace_back(outputMediaType);
+                }
+                Environment::GetInstance().Log(L"Add compatible formats: input %5ls output %5ls", probe.inputPixelFormat->name, frameServerPixelFormat.name);
+            }
+        }
     }
 
     return S_OK;
@@ -174,9 +198,12 @@ auto CSynthFilter::CheckTransform(const CMediaType *mtIn, const CMediaType *mtOu
 auto CSynthFilter::DecideBufferSize(IMemAllocator *pAlloc, ALLOCATOR_PROPERTIES *pProperties) -> HRESULT {
     HRESULT hr;
 
-    pProperties->cBuffers = std::max(pProperties->cBuffers, 2L);
+    // besides the queued samples, one batch is being sent downstream by the queue and one sample is being filled by the worker
+    // so that GetDeliveryBuffer() only waits for the queue bound, never for the allocator
+    const int outputQueueDepth = Environment::GetInstance().GetOutputQueueDepth();
+    pProperties->cBuffers = std::max({ pProperties->cBuffers, 2L, static_cast<long>(outputQueueDepth + CSynthFilterOutputQueue::GetBatchSize(outputQueueDepth) + 1) });
 
-    const long newMediaSampleSize = Format::GetStrideAlignedMediaSampleSize(m_pOutput->CurrentMediaType(), Format::OUTPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT);
+    const long newMediaSampleSize = Format::GetStrideAlignedMediaSampleSize(m_pOutput->CurrentMediaType(), MEDIA_SAMPLE_STRIDE_ALGINMENT);
     pProperties->cbBuffer = std::max(newMediaSampleSize, pProperties->cbBuffer);
 
     ALLOCATOR_PROPERTIES actual;
@@ -223,32 +250,34 @@ auto CSynthFilter::CompleteConnect(PIN_DIRECTION direction, IPin *pReceivePin) -
              * Before output pin is connected, we have a chance to check if input pin's current media type is correctly stride aligned.
              * If not, reconnect with an aligned media type.
              * By doing this, we can save the verbose negotiation via media sample's media type.
+             *
+             * The conversion works with any stride, so this is only done if the input stride alignment is enabled.
              */
 
-            const int strideAlignment = std::max(MEDIA_SAMPLE_STRIDE_ALGINMENT, Format::INPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT);
+            if (Environment::GetInstance().IsInputStrideAligned()) {
+                BITMAPINFOHEADER *bmi = Format::GetBitmapInfo(m_pInput->CurrentMediaType());
+                const int alignedStride = FFALIGN(bmi->biWidth, MEDIA_SAMPLE_STRIDE_ALGINMENT);
+                if (bmi->biWidth != alignedStride) {
+                    AM_MEDIA_TYPE alignedMediaType;
+                    CheckHr(m_pInput->GetConnected()->ConnectionMediaType(&alignedMediaType));
 
-            BITMAPINFOHEADER *bmi = Format::GetBitmapInfo(m_pInput->CurrentMediaType());
-            const int alignedStride = FFALIGN(bmi->biWidth, strideAlignment);
-            if (bmi->biWidth != alignedStride) {
-                AM_MEDIA_TYPE alignedMediaType;
-                CheckHr(m_pInput->GetConnected()->ConnectionMediaType(&alignedMediaType));
+                    bmi = Format::GetBitmapInfo(alignedMediaType);
+                    bmi->biWidth = alignedStride;
+                    bmi->biSizeImage = Format::GetBitmapSize(bmi);
 
-                bmi = Format::GetBitmapInfo(alignedMediaType);
-                bmi->biWidth = alignedStride;
-                bmi->biSizeImage = GetBitmapSize(bmi);
+                    if (m_pInput->QueryAccept(&alignedMediaType) == S_OK) {
+                        hr = reinterpret_cast<IFilterGraph2 *>(m_pGraph)->ReconnectEx(m_pInput->GetConnected(), &alignedMediaType);
+                    }
 
-                if (m_pInput->QueryAccept(&alignedMediaType) == S_OK) {
-                    hr = reinterpret_cast<IFilterGraph2 *>(m_pGraph)->ReconnectEx(m_pInput->GetConnected(), &alignedMediaType);
+                    FreeMediaType(alignedMediaType);
+                    CheckHr(hr);
                 }
-
-                FreeMediaType(alignedMediaType);
-                CheckHr(hr);
             }
         } else {
             const Format::PixelFormat *optConnectionInputPixelFormat = MediaTypeToPixelFormat(&m_pInput->CurrentMediaType());
             const Format::PixelFormat *optConnectionOutputPixelFormat = MediaTypeToPixelFormat(&m_pOutput->CurrentMediaType());
             if (!optConnectionInputPixelFormat || !optConnectionOutputPixelFormat) {
-                Environment::GetInstance().Log(L"Unexpected input or output format");
+                Environment::GetInstance().Log<LogLevel::Error>(L"Unexpected input or output format");
                 return E_UNEXPECTED;
             }
             Environment::GetInstance().Log(L"Pins are connected with media types: %5ls -> %5ls", optConnectionInputPixelFormat->name, optConnectionOutputPixelFormat->name);
@@ -280,7 +309,7 @@ auto CSynthFilter::CompleteConnect(PIN_DIRECTION direction, IPin *pReceivePin) -
 
             if (!isMediaTypesCompatible) {
                 if (reconnectInputMediaType == nullptr) {
-                    Environment::GetInstance().Log(L"Failed to reconnect with any of the %d candidate input media types", _mediaTypeReconnectionWatermark);
+                    Environment::GetInstance().Log<LogLevel::Error>(L"Failed to reconnect with any of the %d candidate input media types", _mediaTypeReconnectionWatermark);
                     return E_UNEXPECTED;
                 }
 
@@ -303,6 +332,18 @@ auto CSynthFilter::StartStreaming() -> HRESULT {
         _remoteControl->Start();
     }
 
+    if (const int outputQueueDepth = Environment::GetInstance().GetOutputQueueDepth(); outputQueueDepth > 0) {
+        HRESULT hr = S_OK;
+        auto outputQueue = std::make_unique<CSynthFilterOutputQueue>(m_pOutput->GetConnected(), &hr, outputQueueDepth);
+
+        if (SUCCEEDED(hr)) {
+            const std::unique_lock outputQueueLock(_outputQueueMutex);
+            _outputQueue = std::move(outputQueue);
+        } else {
+            Environment::GetInstance().Log<LogLevel::Error>(L"Failed to create output queue: %#10lx. Deliver samples synchronously", hr);
+        }
+    }
+
     // the paired BeginFlush() is in StopStreaming()
     frameHandler->EndFlush();
 
@@ -313,12 +354,15 @@ auto CSynthFilter::Receive(IMediaSample *pSample) -> HRESULT {
     HRESULT hr;
 
     if (m_pInput->SampleProps()->dwStreamId != AM_STREAM_MEDIA) {
-        return m_pOutput->Deliver(pSample);
+        return DeliverOutputSample(pSample);
     }
 
     AM_MEDIA_TYPE *pmt;
     pSample->GetMediaType(&pmt);
     if (pmt != nullptr && pmt->pbFormat != nullptr) {
+        // the queued samples are converted with the current input format
+        frameHandler->WaitForInputConversion();
+
         m_pInput->CurrentMediaType() = *pmt;
         _inputVideoFormat = Format::GetVideoFormat(*pmt, &MainFrameServer::GetInstance());
         DeleteMediaType(pmt);
@@ -338,7 +382,10 @@ auto CSynthFilter::Receive(IMediaSample *pSample) -> HRESULT {
 
     m_tDecodeStart = timeGetTime();
 
+    const int sourceFrameNb = frameHandler->GetSourceFrameNb();
+    const std::chrono::steady_clock::time_point receiveStartTime = std::chrono::steady_clock::now();
     hr = frameHandler->AddInputSample(pSample);
+    Environment::GetInstance().TraceComplete("Receive", sourceFrameNb, receiveStartTime);
 
     m_tDecodeStart = timeGetTime() - m_tDecodeStart;
     m_itrAvgDecode = m_tDecodeStart * (10000 / 16) + 15 * (m_itrAvgDecode / 16);
@@ -367,28 +414,73 @@ auto CSynthFilter::Receive(IMediaSample *pSample) -> HRESULT {
     return hr;
 }
 
+auto CSynthFilter::EndOfStream() -> HRESULT {
+    // queued behind the samples that are not delivered yet
+    if (_outputQueue != nullptr) {
+        _outputQueue->EOS();
+        return S_OK;
+    }
+
+    return __super::EndOfStream();
+}
+
 auto CSynthFilter::BeginFlush() -> HRESULT {
     if (IsActive()) {
         frameHandler->BeginFlush();
     }
 
+    // discards the queued samples and releases the worker if it is waiting for room in the queue
+    if (_outputQueue != nullptr) {
+        _outputQueue->BeginFlush();
+        return S_OK;
+    }
+
     return __super::BeginFlush();
 }
 
 auto CSynthFilter::EndFlush() -> HRESULT {
     if (IsActive()) {
         frameHandler->WaitForWorkerLatch();
-        MainFrameServer::GetInstance().StopScript();
+        frameHandler->WaitForScriptLoad();
+        if (!Environment::GetInstance().IsScriptKeptOnSeek()) {
+            MainFrameServer::GetInstance().StopScript();
+        }
         frameHandler->EndFlush();
     }
 
+    if (_outputQueue != nullptr) {
+        _outputQueue->EndFlush();
+        return S_OK;
+    }
+
     return __super::EndFlush();
 }
 
+auto CSynthFilter::NewSegment(REFERENCE_TIME tStart, REFERENCE_TIME tStop, double dRate) -> HRESULT {
+    if (_outputQueue != nullptr) {
+        _outputQueue->NewSegment(tStart, tStop, dRate);
+        return S_OK;
+    }
+
+    return __super::NewSegment(tStart, tStop, dRate);
+}
+
 auto CSynthFilter::StopStreaming() -> HRESULT {
     frameHandler->BeginFlush();
     frameHandler->WaitForWorkerLatch();
+    frameHandler->WaitForScriptLoad();
+    frameHandler->CancelScriptSwap();
     MainFrameServer::GetInstance().StopScript();
+    Environment::GetInstance().FlushTrace();
+
+    if (_outputQueue != nullptr) {
+        // StopStreaming() is also called for format changes in the middle of the stream, where the queued samples are still to be shown.
+        // When the filter is actually stopping, the stopped downstream rejects them right away
+        _outputQueue->WaitForDelivery();
+
+        const std::unique_lock outputQueueLock(_outputQueueMutex);
+        _outputQueue.reset();
+    }
 
     // keep flushing until start streaming
 
@@ -416,7 +508,35 @@ auto STDMETHODCALLTYPE CSynthFilter::GetPages(__RPC__out CAUUID *pPages) -> HRES
 
 auto CSynthFilter::ReloadScript(const std::filesystem::path &scriptPath) -> void {
     FrameServerCommon::GetInstance().SetScriptPath(scriptPath);
-    _needReloadScript = true;
+
+    if (IsActive()) {
+        // build the new script in the background and swap it in without interrupting the playback
+        frameHandler->StartScriptSwap(scriptPath);
+    } else {
+        _needReloadScript = true;
+    }
+}
+
+/**
+ * Same as IMemInputPin::Receive(), the caller keeps its reference of the sample.
+ * Only called by the streaming threads, which never overlap with the creation or destruction of the output queue.
+ */
+auto CSynthFilter::DeliverOutputSample(IMediaSample *sample) -> HRESULT {
+    if (_outputQueue == nullptr) {
+        return m_pOutput->Deliver(sample);
+    }
+
+    sample->AddRef();
+    return _outputQueue->Deliver(sample);
+}
+
+auto CSynthFilter::GetNumQueuedOutputSamples() -> std::optional<int> {
+    const std::unique_lock outputQueueLock(_outputQueueMutex);
+
+    if (_outputQueue == nullptr) {
+        return std::nullopt;
+    }
+    return _outputQueue->GetNumQueuedSamples();
 }
 
 auto CSynthFilter::GetFrameServerState() const -> AvsState {
@@ -6,6 +6,7 @@
 #include "format.h"
 #include "frame_handler.h"
 #include "frameserver.h"
+#include "output_queue.h"
 #include "remote_control.h"
 
 
@@ -45,8 +46,10 @@ public:
     auto CompleteConnect(PIN_DIRECTION direction, IPin *pReceivePin) -> HRESULT override;
     auto StartStreaming() -> HRESULT override;
     auto Receive(IMediaSample *pSample) -> HRESULT override;
+    auto EndOfStream() -> HRESULT override;
     auto BeginFlush() -> HRESULT override;
     auto EndFlush() -> HRESULT override;
+    auto NewSegment(REFERENCE_TIME tStart, REFERENCE_TIME tStop, double dRate) -> HRESULT override;
     auto StopStreaming() -> HRESULT override;
 
     // ISpecifyPropertyPages
@@ -58,6 +61,8 @@ public:
     constexpr auto GetVideoSourcePath() const -> const std::filesystem::path & { return _videoSourcePath; }
     constexpr auto GetVideoFilterNames() const -> const std::vector<std::wstring> & { return _videoFilterNames; }
     auto GetFrameServerState() const -> AvsState;
+    auto DeliverOutputSample(IMediaSample *sample) -> HRESULT;
+    auto GetNumQueuedOutputSamples() -> std::optional<int>;
 
     std::unique_ptr<FrameHandler> frameHandler = std::make_unique<FrameHandler>(*this);
 
@@ -77,7 +82,7 @@ private:
                        return AuxFrameServer::GetInstance().GenerateMediaType(pixelFormat, mtIn);
                    });
         if (ret.empty()) {
-            Environment::GetInstance().Log(L"Unable to find any supported pixel format for script pixel type %d", scriptFormatId);
+            Environment::GetInstance().Log<LogLevel::Error>(L"Unable to find any supported pixel format for script pixel type %d", scriptFormatId);
         }
         return ret;
     }
@@ -93,6 +98,10 @@ private:
 
     std::unique_ptr<RemoteControl> _remoteControl = std::make_unique<RemoteControl>(*this);
 
+    // only exists while streaming with a positive queue depth. The mutex guards the replacement against the readers outside of the streaming threads
+    std::unique_ptr<CSynthFilterOutputQueue> _outputQueue;
+    std::mutex _outputQueueMutex;
+
     bool _disconnectFilter = false;
     std::vector<MediaTypePair> _compatibleMediaTypes;
     std::vector<CMediaType> _availableOutputMediaTypes;
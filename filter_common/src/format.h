@@ -53,6 +53,49 @@ public:
         int resourceId;
     };
 
+    /*
+     * Everything needed to convert between a DirectShow buffer and the frame server planes, resolved once per media type in GetVideoFormat():
+     * the buffer geometry, the kernels for the pixel format and the active instruction set, and the band converter for the planes layout.
+     * Converting a frame then takes one indirect call per band, without re-deriving anything from the VideoFormat.
+     */
+    struct ConversionPlan {
+        using CopyPlaneFunc = auto(const BYTE *src, BYTE *dst, int srcStride, int dstStride, int rowSize, int height) -> void;
+        using DeinterleaveFunc = auto(const BYTE *src, int srcStride, std::array<BYTE *, 3> dsts, const std::array<int, 3> &dstStrides, int rowSize, int height) -> void;
+        using InterleaveUVFunc = auto(const BYTE *src1, const BYTE *src2, int srcStride1, int srcStride2, BYTE *dst, int dstStride, int rowSize, int height) -> void;
+        using InterleaveThreeFunc = auto(std::array<const BYTE *, 3> srcs, const std::array<int, 3> &srcStrides, BYTE *dst, int dstStride, int rowSize, int height) -> void;
+        using CopyFromInputBandFunc = auto(const ConversionPlan &plan, const BYTE *srcBuffer, const std::array<BYTE *, 3> &dstSlices, const std::array<int, 3> &dstStrides, int bandRow, int bandHeight) -> void;
+        using CopyToOutputBandFunc = auto(const ConversionPlan &plan, const std::array<const BYTE *, 3> &srcSlices, const std::array<int, 3> &srcStrides, BYTE *dstBuffer, int bandRow, int bandHeight) -> void;
+
+        int height;
+        // number of main plane rows per secondary plane row. Bands are aligned to it
+        int secPlaneHeightRatio;
+        // rows per band. Equal to height if the frame is converted in one band
+        int bandHeight;
+
+        // geometry of the DirectShow buffer. The main plane stride is negative if the rows are flipped against the frame server's
+        ptrdiff_t mainPlaneOffset;
+        int mainPlaneStride;
+        int mainPlaneRowSize;
+        // offsets of the U and V planes, or only the first one for the interleaved UV plane
+        std::array<ptrdiff_t, 2> secPlaneOffsets;
+        int secPlaneStride;
+        int secPlaneRowSize;
+
+        // frame server plane of each component (de-)interleaved from the main plane
+        std::array<int, 3> componentPlanes = { 0, 1, 2 };
+
+        // kernels for the pixel format and the active instruction set. Only the ones used by the band converter are set
+        CopyPlaneFunc *mainPlaneInputFunc = nullptr;
+        CopyPlaneFunc *mainPlaneOutputFunc = nullptr;
+        CopyPlaneFunc *secPlaneCopyFunc = nullptr;
+        DeinterleaveFunc *deinterleaveFunc = nullptr;
+        InterleaveUVFunc *interleaveUVFunc = nullptr;
+        InterleaveThreeFunc *interleaveThreeFunc = nullptr;
+
+        CopyFromInputBandFunc *copyFromInputBandFunc;
+        CopyToOutputBandFunc *copyToOutputBandFunc;
+    };
+
     struct VideoFormat {
         struct ColorSpaceInfo {
             std::optional<int> colorRange;
@@ -72,14 +115,7 @@ public:
         int hdrLuminance = 0;
         BITMAPINFOHEADER bmi;
         FrameServerCore frameServerCore;
-
-        /*
-         * bit 1 is set if the format requires bit shifting
-         * bit 2 is set if the protection of the destination sample buffer has been queried
-         * bit 3 is set if the protection of the destination sample buffer has PAGE_WRITECOMBINE
-         * when all bits are set, CopyToOutput() utilize an intermediate destination buffer
-         */
-        int outputBufferTemporalFlags = 0;
+        ConversionPlan conversionPlan;
 
         auto GetCodecFourCC() const -> DWORD;
     };
@@ -105,26 +141,17 @@ public:
         return nullptr;
     }
 
+    // same as the GetBitmapSize() from the DirectShow base classes, except that v210 is sized by its 48-pixel row padding
+    static auto GetBitmapSize(const BITMAPINFOHEADER *bmi) -> DWORD;
     static auto GetStrideAlignedMediaSampleSize(const AM_MEDIA_TYPE &mediaType, int strideAlignment) -> long;
     static auto GetVideoFormat(const AM_MEDIA_TYPE &mediaType, const FrameServerBase *frameServerInstance) -> VideoFormat;
     static auto WriteSample(const VideoFormat &videoFormat, InputFrameType srcFrame, BYTE *dstBuffer) -> void;
     static auto CreateFrame(const VideoFormat &videoFormat, const BYTE *srcBuffer) -> OutputFrameType;
-    static auto CopyFromInput(const VideoFormat &videoFormat, const BYTE *srcBuffer, const std::array<BYTE *, 3> &dstSlices, const std::array<int, 3> &dstStrides, int frameWidth, int height) -> void;
-    static auto CopyToOutput(const VideoFormat &videoFormat, const std::array<const BYTE *, 3> &srcSlices, const std::array<int, 3> &srcStrides, BYTE *dstBuffer, int frameWidth, int height) -> void;
+    static auto CopyFromInput(const VideoFormat &videoFormat, const BYTE *srcBuffer, const std::array<BYTE *, 3> &dstSlices, const std::array<int, 3> &dstStrides) -> void;
+    static auto CopyToOutput(const VideoFormat &videoFormat, const std::array<const BYTE *, 3> &srcSlices, const std::array<int, 3> &srcStrides, BYTE *dstBuffer) -> void;
 
     static const std::vector<PixelFormat> PIXEL_FORMATS;
 
-    /*
-     * When (de-)interleaving the data from the buffers for U and V planes, if the stride is
-     * not a multiple of the vector size, we can't use intrinsics to bulk copy the remainder bytes.
-     * Traditionally we copy these bytes in a loop.
-     *
-     * However, if we allocate the buffer size with the headroom of one intrinsic size, we can keep using
-     * the same logic with intrinsics, simplifying the code. The junk data in the padding will be harmless.
-     */
-    static inline int INPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT;
-    static inline int OUTPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT;
-
 private:
     static inline const __m128i _UV_SHUFFLE_MASK_M128_C1  = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
     static inline const __m128i _UV_SHUFFLE_MASK_M128_C2  = _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
@@ -138,20 +165,205 @@ private:
     static inline const __m128i _Y410_SHUFFLE_MASK_3      = _mm_setr_epi8(2, 3, 6, 7, 10, 11, 14, 15, 0, 0, 0, 0, 0, 0, 0, 0);
     static inline const __m128i _Y416_SHUFFLE_MASK_M128   = _mm_setr_epi8(0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15);
     static inline       __m256i _Y416_SHUFFLE_MASK_M256;
+    static inline const __m128i _YUY2_SHUFFLE_MASK_M128   = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 5, 9, 13, 3, 7, 11, 15);
+    static inline const __m128i _Y210_SHUFFLE_MASK_M128   = _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 10, 11, 6, 7, 14, 15);
     static inline const __m128i _RGB_SHUFFLE_MASK_M128_C1 = _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
     static inline       __m256i _RGB_SHUFFLE_MASK_M256_C1;
+    static inline       __m512i _UV_SHUFFLE_MASK_M512_C1;
+    static inline       __m512i _UV_SHUFFLE_MASK_M512_C2;
+    static inline       __m512i _Y416_SHUFFLE_MASK_M512;
+    static inline       __m512i _RGB_SHUFFLE_MASK_M512_C1;
     static constexpr const int  _UV_PERMUTE_INDEX         = 0b11011000;
     static inline       __m256i _FOUR_PERMUTE_INDEX;
+    static inline       __m512i _DEINTERLEAVE_UV_PERMUTE_INDEX_M512;
+    static inline       __m512i _INTERLEAVE_UV_PERMUTE_INDEX_M512;
+    static inline       __m512i _FOUR_PERMUTE_INDEX_M512;
+    static inline       __m512i _YUY2_DEINTERLEAVE_UV_PERMUTE_INDEX_M512;
+    static inline       __m512i _YUY2_INTERLEAVE_UV_PERMUTE_INDEX_M512;
+    // indexed by [source vector][component] for deinterleaving, [destination vector][component] for interleaving
+    static inline       std::array<std::array<__m128i, 3>, 3> _RGB24_DEINTERLEAVE_SHUFFLE_MASKS;
+    static inline       std::array<std::array<__m128i, 3>, 3> _RGB24_INTERLEAVE_SHUFFLE_MASKS;
+    static inline       std::array<std::array<__m128i, 3>, 3> _RGB48_DEINTERLEAVE_SHUFFLE_MASKS;
+    static inline       std::array<std::array<__m128i, 3>, 3> _RGB48_INTERLEAVE_SHUFFLE_MASKS;
+    // indexed by [regrouped vector][permute] for deinterleaving, [destination vector][permute] for interleaving
+    static inline       std::array<std::array<__m512i, 2>, 3> _RGB_DEINTERLEAVE_PERMUTE_INDICES_M512;
+    static inline       std::array<std::array<__m512i, 2>, 3> _RGB_INTERLEAVE_PERMUTE_INDICES_M512;
+    // indexed by [plane][first two or third components][block in the 256-bit vector] for deinterleaving, [first two or third components][plane][block in the 256-bit vector] for interleaving
+    static inline       std::array<std::array<std::array<__m128i, 2>, 2>, 3> _V210_DEINTERLEAVE_SHUFFLE_MASKS;
+    static inline       std::array<std::array<std::array<__m128i, 2>, 3>, 2> _V210_INTERLEAVE_SHUFFLE_MASKS;
+    // indexed by [plane] for deinterleaving, [first two or third components] for interleaving
+    static inline       std::array<__m512i, 3> _V210_DEINTERLEAVE_PERMUTE_INDICES_M512;
+    static inline       std::array<__m512i, 2> _V210_INTERLEAVE_PERMUTE_INDICES_M512;
+
+    static auto CreateConversionPlan(const VideoFormat &videoFormat) -> ConversionPlan;
 
     /*
-     * intrinsicType: 1 = SSE4, 2 = AVX2. Anything else: non-SIMD
+     * Frames are split into bands of rows to be converted in parallel on the thread pool.
+     * Band boundaries are aligned to rowAlignment so that every band holds whole rows of the subsampled planes.
+     * Frames that are too small to amortize the dispatch are converted as one band on the calling thread.
+     */
+    static auto GetBandHeight(const BITMAPINFOHEADER &bmi, int height, int rowAlignment) -> int;
+    static auto ForEachBand(const ConversionPlan &plan, const std::function<void(int bandRow, int bandHeight)> &bandFunc) -> void;
+
+    // BitBlt() of the frame server
+    static auto CopyPlane(const BYTE *src, BYTE *dst, int srcStride, int dstStride, int rowSize, int height) -> void;
+    // the frame server's BitBlt() for planes that fit in the cache, the streaming copy for larger ones
+    static auto GetCopyPlaneFunc(int planeSize) -> ConversionPlan::CopyPlaneFunc *;
+
+    template <PlanesLayout layout>
+    static constexpr auto CopyFromInputBand(const ConversionPlan &plan, const BYTE *srcBuffer, const std::array<BYTE *, 3> &dstSlices, const std::array<int, 3> &dstStrides, int bandRow, int bandHeight) -> void {
+        const int bandSecRow = bandRow / plan.secPlaneHeightRatio;
+        const int bandSecHeight = bandHeight / plan.secPlaneHeightRatio;
+        const BYTE *srcMainPlane = srcBuffer + plan.mainPlaneOffset + static_cast<ptrdiff_t>(plan.mainPlaneStride) * bandRow;
+
+        if constexpr (layout == PlanesLayout::ALL_PLANES_INTERLEAVED) {
+            if (plan.deinterleaveFunc == nullptr) {
+                // the frame server takes the interleaved format as is
+                plan.mainPlaneInputFunc(srcMainPlane, dstSlices[0] + static_cast<ptrdiff_t>(dstStrides[0]) * bandRow, plan.mainPlaneStride, dstStrides[0], plan.mainPlaneRowSize, bandHeight);
+            } else {
+                std::array<BYTE *, 3> dstComponentSlices;
+                std::array<int, 3> dstComponentStrides;
+                for (size_t c = 0; c < plan.componentPlanes.size(); ++c) {
+                    const int p = plan.componentPlanes[c];
+                    dstComponentSlices[c] = dstSlices[p] + static_cast<ptrdiff_t>(dstStrides[p]) * bandRow;
+                    dstComponentStrides[c] = dstStrides[p];
+                }
+
+                plan.deinterleaveFunc(srcMainPlane, plan.mainPlaneStride, dstComponentSlices, dstComponentStrides, plan.mainPlaneRowSize, bandHeight);
+            }
+        } else {
+            plan.mainPlaneInputFunc(srcMainPlane, dstSlices[0] + static_cast<ptrdiff_t>(dstStrides[0]) * bandRow, plan.mainPlaneStride, dstStrides[0], plan.mainPlaneRowSize, bandHeight);
+
+            const BYTE *srcSecPlane1 = srcBuffer + plan.secPlaneOffsets[0] + static_cast<ptrdiff_t>(plan.secPlaneStride) * bandSecRow;
+            BYTE *dstSlice1 = dstSlices[1] + static_cast<ptrdiff_t>(dstStrides[1]) * bandSecRow;
+            BYTE *dstSlice2 = dstSlices[2] + static_cast<ptrdiff_t>(dstStrides[2]) * bandSecRow;
+
+            if constexpr (layout == PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED) {
+                plan.deinterleaveFunc(srcSecPlane1, plan.secPlaneStride, { dstSlice1, dstSlice2 }, { dstStrides[1], dstStrides[2] }, plan.secPlaneRowSize, bandSecHeight);
+            } else {
+                const BYTE *srcSecPlane2 = srcBuffer + plan.secPlaneOffsets[1] + static_cast<ptrdiff_t>(plan.secPlaneStride) * bandSecRow;
+
+                plan.secPlaneCopyFunc(srcSecPlane1, dstSlice1, plan.secPlaneStride, dstStrides[1], plan.secPlaneRowSize, bandSecHeight);
+                plan.secPlaneCopyFunc(srcSecPlane2, dstSlice2, plan.secPlaneStride, dstStrides[2], plan.secPlaneRowSize, bandSecHeight);
+            }
+        }
+    }
+
+    template <PlanesLayout layout>
+    static constexpr auto CopyToOutputBand(const ConversionPlan &plan, const std::array<const BYTE *, 3> &srcSlices, const std::array<int, 3> &srcStrides, BYTE *dstBuffer, int bandRow, int bandHeight) -> void {
+        const int bandSecRow = bandRow / plan.secPlaneHeightRatio;
+        const int bandSecHeight = bandHeight / plan.secPlaneHeightRatio;
+        BYTE *dstMainPlane = dstBuffer + plan.mainPlaneOffset + static_cast<ptrdiff_t>(plan.mainPlaneStride) * bandRow;
+
+        if constexpr (layout == PlanesLayout::ALL_PLANES_INTERLEAVED) {
+            if (plan.interleaveThreeFunc == nullptr) {
+                plan.mainPlaneOutputFunc(srcSlices[0] + static_cast<ptrdiff_t>(srcStrides[0]) * bandRow, dstMainPlane, srcStrides[0], plan.mainPlaneStride, plan.mainPlaneRowSize, bandHeight);
+            } else {
+                std::array<const BYTE *, 3> srcComponentSlices;
+                std::array<int, 3> srcComponentStrides;
+                for (size_t c = 0; c < plan.componentPlanes.size(); ++c) {
+                    const int p = plan.componentPlanes[c];
+                    srcComponentSlices[c] = srcSlices[p] + static_cast<ptrdiff_t>(srcStrides[p]) * bandRow;
+                    srcComponentStrides[c] = srcStrides[p];
+                }
+
+                plan.interleaveThreeFunc(srcComponentSlices, srcComponentStrides, dstMainPlane, plan.mainPlaneStride, plan.mainPlaneRowSize, bandHeight);
+            }
+        } else {
+            plan.mainPlaneOutputFunc(srcSlices[0] + static_cast<ptrdiff_t>(srcStrides[0]) * bandRow, dstMainPlane, srcStrides[0], plan.mainPlaneStride, plan.mainPlaneRowSize, bandHeight);
+
+            const BYTE *srcSlice1 = srcSlices[1] + static_cast<ptrdiff_t>(srcStrides[1]) * bandSecRow;
+            const BYTE *srcSlice2 = srcSlices[2] + static_cast<ptrdiff_t>(srcStrides[2]) * bandSecRow;
+            BYTE *dstSecPlane1 = dstBuffer + plan.secPlaneOffsets[0] + static_cast<ptrdiff_t>(plan.secPlaneStride) * bandSecRow;
+
+            if constexpr (layout == PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED) {
+                plan.interleaveUVFunc(srcSlice1, srcSlice2, srcStrides[1], srcStrides[2], dstSecPlane1, plan.secPlaneStride, plan.secPlaneRowSize, bandSecHeight);
+            } else {
+                BYTE *dstSecPlane2 = dstBuffer + plan.secPlaneOffsets[1] + static_cast<ptrdiff_t>(plan.secPlaneStride) * bandSecRow;
+
+                plan.secPlaneCopyFunc(srcSlice1, dstSecPlane1, srcStrides[1], plan.secPlaneStride, plan.secPlaneRowSize, bandSecHeight);
+                plan.secPlaneCopyFunc(srcSlice2, dstSecPlane2, srcStrides[2], plan.secPlaneStride, plan.secPlaneRowSize, bandSecHeight);
+            }
+        }
+    }
+
+    // mask with the lowest numBits bits set, used by the AVX-512 masked loads and stores
+    static constexpr auto LowBitsMask(int numBits) -> uint64_t {
+        return numBits >= 64 ? ~0ULL : (1ULL << numBits) - 1;
+    }
+
+    // shift each 16-bit integer in the vector. Non-SIMD vectors are arrays of 16-bit integers
+    template <int shiftSize, bool isRightShift, typename Vector>
+    static constexpr auto ShiftEach16BitInt(Vector vec) -> Vector {
+        if constexpr (shiftSize == 0) {
+            return vec;
+        } else if constexpr (std::is_same_v<Vector, __m128i>) {
+            return isRightShift ? _mm_srli_epi16(vec, shiftSize) : _mm_slli_epi16(vec, shiftSize);
+        } else if constexpr (std::is_same_v<Vector, __m256i>) {
+            return isRightShift ? _mm256_srli_epi16(vec, shiftSize) : _mm256_slli_epi16(vec, shiftSize);
+        } else if constexpr (std::is_same_v<Vector, __m512i>) {
+            return isRightShift ? _mm512_srli_epi16(vec, shiftSize) : _mm512_slli_epi16(vec, shiftSize);
+        } else {
+            for (uint16_t &component : *reinterpret_cast<std::array<uint16_t, sizeof(Vector) / sizeof(uint16_t)> *>(&vec)) {
+                component = static_cast<uint16_t>(isRightShift ? component >> shiftSize : component << shiftSize);
+            }
+            return vec;
+        }
+    }
+
+    // rows of arbitrary strides start at any address, so vectors are always loaded unaligned
+    template <typename Vector>
+    static constexpr auto LoadVector(const Vector *src) -> Vector {
+        if constexpr (std::is_same_v<Vector, __m128i>) {
+            return _mm_loadu_si128(src);
+        } else if constexpr (std::is_same_v<Vector, __m256i>) {
+            return _mm256_loadu_si256(src);
+        } else if constexpr (std::is_same_v<Vector, __m512i>) {
+            return _mm512_loadu_si512(src);
+        } else {
+            return *src;
+        }
+    }
+
+    /*
+     * Non-temporal stores bypass the cache, which suits buffers that are written once and consumed by someone else (e.g. the output samples).
+     * They also avoid reading back from write-combined memory. The destination must be aligned to the vector size.
+     */
+    template <typename Vector>
+    static constexpr auto StoreVector(Vector *dst, const Vector &vec, bool isNonTemporal) -> void {
+        if constexpr (std::is_same_v<Vector, __m128i>) {
+            if (isNonTemporal) {
+                _mm_stream_si128(dst, vec);
+            } else {
+                _mm_storeu_si128(dst, vec);
+            }
+        } else if constexpr (std::is_same_v<Vector, __m256i>) {
+            if (isNonTemporal) {
+                _mm256_stream_si256(dst, vec);
+            } else {
+                _mm256_storeu_si256(dst, vec);
+            }
+        } else if constexpr (std::is_same_v<Vector, __m512i>) {
+            if (isNonTemporal) {
+                _mm512_stream_si512(dst, vec);
+            } else {
+                _mm512_storeu_si512(dst, vec);
+            }
+        } else {
+            *dst = vec;
+        }
+    }
+
+    /*
+     * intrinsicType: 1 = SSE4, 2 = AVX2, 3 = AVX-512. Anything else: non-SIMD
      * componentSize is the size per pixel component (1 for 8-bit, 2 for 10 and 16-bit)
      * srcNumComponents is the number of components per pixel for the source
      * dstNumComponents is the number of components per pixel for the destination
      * srcNumComponents should always >= dstNumComponents. They differ in case we want to discard certain components (e.g. the alpha plane of Y410/Y416)
      * colorFamily: 1 = YUV, 2 = RGB
+     * rightShiftSize: if non-zero, each 16-bit component is right shifted while being deinterleaved (e.g. P010), so that each byte is only touched once
      */
-    template <int intrinsicType, int componentSize, int srcNumComponents, int dstNumComponents, int colorFamily>
+    template <int intrinsicType, int componentSize, int srcNumComponents, int dstNumComponents, int colorFamily, int rightShiftSize = 0>
     static constexpr auto Deinterleave(const BYTE *src, int srcStride, std::array<BYTE *, 3> dsts, const std::array<int, 3> &dstStrides, int rowSize, int height) -> void {
         /*
          * Place bytes from each plane in sequence by shuffling, then write the sequence of bytes to respective buffer.
@@ -159,14 +371,20 @@ private:
          * For AVX2, because its 256-bit shuffle instruction does not operate cross the 128-bit lane,
          * we first prepare the two 128-bit integers just like the SSSE3 version, then permute to correct the order.
          * Much like 0, 2, 1, 3 -> 0, 1, 2, 3.
+         *
+         * AVX-512 does the same with four 128-bit lanes. Its last cycle of each row loads and stores with masks,
+         * so that it never touches the bytes beyond rowSize.
+         *
+         * SSE and AVX2 stop at the last whole vector of each row, and leave the remaining columns to the non-SIMD version.
          */
 
-        Environment::GetInstance().Log(L"Deinterleave() start");
+        Environment::GetInstance().Log<LogLevel::Kernel>(L"Deinterleave() start");
 
         // Input is the type for the input data each SIMD intrustion works on (__m128i, __m256i, etc.)
         using Input = std::conditional_t<intrinsicType == 1, __m128i
                     , std::conditional_t<intrinsicType == 2, __m256i
-                    , std::array<BYTE, componentSize * srcNumComponents>>>;
+                    , std::conditional_t<intrinsicType == 3, __m512i
+                    , std::array<BYTE, componentSize * srcNumComponents>>>>;
         // Output is the type for the output of the SIMD instructions, half the size of Input
         using Output = std::array<BYTE, sizeof(Input) / srcNumComponents>;
 
@@ -197,9 +415,38 @@ private:
             } else if constexpr (srcNumComponents == 4) {
                 shuffleMask = _Y416_SHUFFLE_MASK_M256;
             }
+        } else if constexpr (intrinsicType == 3) {
+            if constexpr (componentSize == 1) {
+                if constexpr (colorFamily == 1) {
+                    shuffleMask = _UV_SHUFFLE_MASK_M512_C1;
+                } else if constexpr (colorFamily == 2) {
+                    shuffleMask = _RGB_SHUFFLE_MASK_M512_C1;
+                }
+            } else if constexpr (srcNumComponents == 2) {
+                shuffleMask = _UV_SHUFFLE_MASK_M512_C2;
+            } else if constexpr (srcNumComponents == 4) {
+                shuffleMask = _Y416_SHUFFLE_MASK_M512;
+            }
         }
 
-        const int cycles = DivideRoundUp(rowSize, sizeof(Input));
+        int cycles;
+        if constexpr (intrinsicType == 1 || intrinsicType == 2) {
+            cycles = rowSize / static_cast<int>(sizeof(Input));
+
+            const int vectorRowSize = cycles * static_cast<int>(sizeof(Input));
+            if (vectorRowSize < rowSize) {
+                std::array<BYTE *, 3> tailDsts {};
+                for (int p = 0; p < dstNumComponents; ++p) {
+                    tailDsts[p] = dsts[p] + vectorRowSize / srcNumComponents;
+                }
+                Deinterleave<0, componentSize, srcNumComponents, dstNumComponents, colorFamily, rightShiftSize>(src + vectorRowSize, srcStride, tailDsts, dstStrides, rowSize - vectorRowSize, height);
+            }
+        } else {
+            cycles = DivideRoundUp(rowSize, sizeof(Input));
+        }
+        const int lastCycleSize = rowSize - (cycles - 1) * static_cast<int>(sizeof(Input));
+        [[maybe_unused]] const uint64_t srcLastCycleMask = LowBitsMask(lastCycleSize);
+        [[maybe_unused]] const uint64_t dstLastCycleMask = LowBitsMask(lastCycleSize / srcNumComponents);
 
         for (int y = 0; y < height; ++y) {
             const Input *srcLine = reinterpret_cast<const Input *>(src);
@@ -209,7 +456,20 @@ private:
             }
 
             for (int i = 0; i < cycles; ++i) {
-                const Input srcVec = *srcLine++;
+                [[maybe_unused]] const bool isLastCycle = i == cycles - 1;
+
+                Input srcVec;
+                if constexpr (intrinsicType == 3) {
+                    srcVec = _mm512_maskz_loadu_epi8(isLastCycle ? srcLastCycleMask : ~0ULL, srcLine++);
+                } else {
+                    srcVec = LoadVector(srcLine++);
+                }
+
+                if constexpr (rightShiftSize > 0) {
+                    static_assert(componentSize == 2);
+                    srcVec = ShiftEach16BitInt<rightShiftSize, true>(srcVec);
+                }
+
                 Input dataVec;
 
                 if constexpr (intrinsicType == 1) {
@@ -222,12 +482,30 @@ private:
                     } else if constexpr (srcNumComponents == 4) {
                         dataVec = _mm256_permutevar8x32_epi32(srcShuffle, _FOUR_PERMUTE_INDEX);
                     }
+                } else if constexpr (intrinsicType == 3) {
+                    const Input srcShuffle = _mm512_shuffle_epi8(srcVec, shuffleMask);
+
+                    if constexpr (srcNumComponents == 2) {
+                        dataVec = _mm512_permutexvar_epi64(_DEINTERLEAVE_UV_PERMUTE_INDEX_M512, srcShuffle);
+                    } else if constexpr (srcNumComponents == 4) {
+                        dataVec = _mm512_permutexvar_epi32(_FOUR_PERMUTE_INDEX_M512, srcShuffle);
+                    }
                 } else {
                     dataVec = srcVec;
                 }
 
                 for (int p = 0; p < dstNumComponents; ++p) {
-                    *dstsLine[p]++ = *(reinterpret_cast<const Output *>(&dataVec) + p);
+                    if constexpr (intrinsicType == 3) {
+                        const uint64_t dstMask = isLastCycle ? dstLastCycleMask : ~0ULL;
+
+                        if constexpr (srcNumComponents == 2) {
+                            _mm256_mask_storeu_epi8(dstsLine[p]++, static_cast<__mmask32>(dstMask), *(reinterpret_cast<const __m256i *>(&dataVec) + p));
+                        } else if constexpr (srcNumComponents == 4) {
+                            _mm_mask_storeu_epi8(dstsLine[p]++, static_cast<__mmask16>(dstMask), *(reinterpret_cast<const __m128i *>(&dataVec) + p));
+                        }
+                    } else {
+                        *dstsLine[p]++ = *(reinterpret_cast<const Output *>(&dataVec) + p);
+                    }
                 }
             }
 
@@ -237,54 +515,113 @@ private:
             }
         }
 
-        Environment::GetInstance().Log(L"Deinterleave() end");
+        Environment::GetInstance().Log<LogLevel::Kernel>(L"Deinterleave() end");
     }
 
-    template <int intrinsicType, int componentSize>
+    /*
+     * leftShiftSize: if non-zero, each 16-bit component is left shifted while being interleaved (e.g. P010)
+     * isNonTemporal: write the destination with non-temporal stores whenever the row is aligned
+     */
+    template <int intrinsicType, int componentSize, int leftShiftSize = 0, bool isNonTemporal = false>
     static constexpr auto InterleaveUV(const BYTE *src1, const BYTE *src2, int srcStride1, int srcStride2, BYTE *dst, int dstStride, int rowSize, int height) -> void {
-        Environment::GetInstance().Log(L"InterleaveUV() start");
+        Environment::GetInstance().Log<LogLevel::Kernel>(L"InterleaveUV() start");
 
         using Component = std::array<BYTE, componentSize>;
         using Vector = std::conditional_t<intrinsicType == 1, __m128i
                      , std::conditional_t<intrinsicType == 2, __m256i
-                     , Component>>;
+                     , std::conditional_t<intrinsicType == 3, __m512i
+                     , Component>>>;
 
         const div_t cycleInfo = std::div(rowSize, sizeof(Vector) * 2);
-        const int vectorCycles = cycleInfo.quot;
-        const int remainderCycles = cycleInfo.rem / (sizeof(Component) * 2);
+        int vectorCycles = cycleInfo.quot;
+        int remainderCycles = cycleInfo.rem / (sizeof(Component) * 2);
+
+        // AVX-512 covers the remainder with one more masked cycle instead of the component loop
+        uint64_t srcLastCycleMask = ~0ULL;
+        uint64_t dstLastCycleMask1 = ~0ULL;
+        uint64_t dstLastCycleMask2 = ~0ULL;
+        if constexpr (intrinsicType == 3) {
+            if (cycleInfo.rem > 0) {
+                vectorCycles += 1;
+                remainderCycles = 0;
+
+                srcLastCycleMask = LowBitsMask(cycleInfo.rem / 2);
+                dstLastCycleMask1 = LowBitsMask(std::min(cycleInfo.rem, static_cast<int>(sizeof(Vector))));
+                dstLastCycleMask2 = LowBitsMask(std::max(cycleInfo.rem - static_cast<int>(sizeof(Vector)), 0));
+            }
+        }
 
         for (int y = 0; y < height; ++y) {
             const Vector *src1LineAsVector = reinterpret_cast<const Vector *>(src1);
             const Vector *src2LineAsVector = reinterpret_cast<const Vector *>(src2);
             Vector *dstLineAsVector = reinterpret_cast<Vector *>(dst);
+            const bool isNonTemporalRow = isNonTemporal && reinterpret_cast<uintptr_t>(dst) % sizeof(Vector) == 0;
 
             for (int i = 0; i < vectorCycles; ++i) {
-                const Vector src1Vec = *src1LineAsVector++;
-                const Vector src2Vec = *src2LineAsVector++;
+                [[maybe_unused]] const bool isLastCycle = i == vectorCycles - 1;
+
+                Vector src1Vec;
+                Vector src2Vec;
+                if constexpr (intrinsicType == 3) {
+                    const uint64_t srcMask = isLastCycle ? srcLastCycleMask : ~0ULL;
+                    src1Vec = _mm512_maskz_loadu_epi8(srcMask, src1LineAsVector++);
+                    src2Vec = _mm512_maskz_loadu_epi8(srcMask, src2LineAsVector++);
+                } else {
+                    src1Vec = LoadVector(src1LineAsVector++);
+                    src2Vec = LoadVector(src2LineAsVector++);
+                }
 
+                if constexpr (leftShiftSize > 0) {
+                    static_assert(componentSize == 2);
+                    src1Vec = ShiftEach16BitInt<leftShiftSize, false>(src1Vec);
+                    src2Vec = ShiftEach16BitInt<leftShiftSize, false>(src2Vec);
+                }
+
+                Vector dstVec1;
+                Vector dstVec2;
                 if constexpr (intrinsicType == 1) {
                     if constexpr (componentSize == 1) {
-                        *dstLineAsVector++ = _mm_unpacklo_epi8(src1Vec, src2Vec);
-                        *dstLineAsVector++ = _mm_unpackhi_epi8(src1Vec, src2Vec);
+                        dstVec1 = _mm_unpacklo_epi8(src1Vec, src2Vec);
+                        dstVec2 = _mm_unpackhi_epi8(src1Vec, src2Vec);
                     } else if constexpr (componentSize == 2) {
-                        *dstLineAsVector++ = _mm_unpacklo_epi16(src1Vec, src2Vec);
-                        *dstLineAsVector++ = _mm_unpackhi_epi16(src1Vec, src2Vec);
+                        dstVec1 = _mm_unpacklo_epi16(src1Vec, src2Vec);
+                        dstVec2 = _mm_unpackhi_epi16(src1Vec, src2Vec);
                     }
                 } else if constexpr (intrinsicType == 2) {
                     const Vector src1Permute = _mm256_permute4x64_epi64(src1Vec, _UV_PERMUTE_INDEX);
                     const Vector src2Permute = _mm256_permute4x64_epi64(src2Vec, _UV_PERMUTE_INDEX);
 
                     if constexpr (componentSize == 1) {
-                        *dstLineAsVector++ = _mm256_unpacklo_epi8(src1Permute, src2Permute);
-                        *dstLineAsVector++ = _mm256_unpackhi_epi8(src1Permute, src2Permute);
+                        dstVec1 = _mm256_unpacklo_epi8(src1Permute, src2Permute);
+                        dstVec2 = _mm256_unpackhi_epi8(src1Permute, src2Permute);
                     } else if constexpr (componentSize == 2) {
-                        *dstLineAsVector++ = _mm256_unpacklo_epi16(src1Permute, src2Permute);
-                        *dstLineAsVector++ = _mm256_unpackhi_epi16(src1Permute, src2Permute);
+                        dstVec1 = _mm256_unpacklo_epi16(src1Permute, src2Permute);
+                        dstVec2 = _mm256_unpackhi_epi16(src1Permute, src2Permute);
+                    }
+                } else if constexpr (intrinsicType == 3) {
+                    const Vector src1Permute = _mm512_permutexvar_epi64(_INTERLEAVE_UV_PERMUTE_INDEX_M512, src1Vec);
+                    const Vector src2Permute = _mm512_permutexvar_epi64(_INTERLEAVE_UV_PERMUTE_INDEX_M512, src2Vec);
+
+                    if constexpr (componentSize == 1) {
+                        dstVec1 = _mm512_unpacklo_epi8(src1Permute, src2Permute);
+                        dstVec2 = _mm512_unpackhi_epi8(src1Permute, src2Permute);
+                    } else if constexpr (componentSize == 2) {
+                        dstVec1 = _mm512_unpacklo_epi16(src1Permute, src2Permute);
+                        dstVec2 = _mm512_unpackhi_epi16(src1Permute, src2Permute);
+                    }
+
+                    if (isLastCycle) {
+                        _mm512_mask_storeu_epi8(dstLineAsVector++, dstLastCycleMask1, dstVec1);
+                        _mm512_mask_storeu_epi8(dstLineAsVector++, dstLastCycleMask2, dstVec2);
+                        continue;
                     }
                 } else {
-                    *dstLineAsVector++ = src1Vec;
-                    *dstLineAsVector++ = src2Vec;
+                    dstVec1 = src1Vec;
+                    dstVec2 = src2Vec;
                 }
+
+                StoreVector(dstLineAsVector++, dstVec1, isNonTemporalRow);
+                StoreVector(dstLineAsVector++, dstVec2, isNonTemporalRow);
             }
 
             const Component *src1LineAsComponent = reinterpret_cast<const Component *>(src1LineAsVector);
@@ -292,8 +629,13 @@ private:
             Component *dstLineAsComponent = reinterpret_cast<Component *>(dstLineAsVector);
 
             for (int i = 0; i < remainderCycles; ++i) {
-                *dstLineAsComponent++ = *src1LineAsComponent++;
-                *dstLineAsComponent++ = *src2LineAsComponent++;
+                if constexpr (leftShiftSize > 0) {
+                    *dstLineAsComponent++ = ShiftEach16BitInt<leftShiftSize, false>(*src1LineAsComponent++);
+                    *dstLineAsComponent++ = ShiftEach16BitInt<leftShiftSize, false>(*src2LineAsComponent++);
+                } else {
+                    *dstLineAsComponent++ = *src1LineAsComponent++;
+                    *dstLineAsComponent++ = *src2LineAsComponent++;
+                }
             }
 
             src1 += srcStride1;
@@ -301,27 +643,465 @@ private:
             dst += dstStride;
         }
 
-        Environment::GetInstance().Log(L"InterleaveUV() end");
+        if constexpr (isNonTemporal) {
+            _mm_sfence();
+        }
+
+        Environment::GetInstance().Log<LogLevel::Kernel>(L"InterleaveUV() end");
     }
 
-    template <int colorFamily>
+    template <int intrinsicType, int colorFamily>
     static constexpr auto InterleaveThree(std::array<const BYTE *, 3> srcs, const std::array<int, 3> &srcStrides, BYTE *dst, int dstStride, int rowSize, int height) -> void {
-        // Extract 32-bit integers from each sources and form 128-bit integer, then shuffle to the correct order
+        /*
+         * For SSE, extract 32-bit integers from each sources and form 128-bit integer, then shuffle to the correct order.
+         *
+         * For AVX2 and AVX-512, unpack the sources with the constant fourth component twice, which forms the pixels within each 128-bit lane,
+         * then transpose the lanes to the correct order.
+         *
+         * AVX-512 masks the last cycle of each row. SSE and AVX2 stop at the last whole output vector, and leave the remaining pixels to the non-SIMD version.
+         */
+
+        Environment::GetInstance().Log<LogLevel::Kernel>(L"InterleaveThree() start");
+
+        constexpr int componentSize = colorFamily == 1 ? 2 : 1;
+
+        if constexpr (intrinsicType == 1 || intrinsicType == 2) {
+            const int outputSize = intrinsicType == 1 ? static_cast<int>(sizeof(__m128i)) : static_cast<int>(sizeof(__m256i)) * 4;
+            const int vectorRowSize = rowSize / outputSize * outputSize;
+            if (vectorRowSize < rowSize) {
+                InterleaveThree<0, colorFamily>({ srcs[0] + vectorRowSize / 4, srcs[1] + vectorRowSize / 4, srcs[2] + vectorRowSize / 4 }, srcStrides, dst + vectorRowSize, dstStride, rowSize - vectorRowSize, height);
+            }
+        }
+
+        if constexpr (intrinsicType == 2 || intrinsicType == 3) {
+            using Vector = std::conditional_t<intrinsicType == 2, __m256i, __m512i>;
+
+            Vector fourthVec;
+            if constexpr (intrinsicType == 2) {
+                fourthVec = _mm256_set1_epi8(-1);
+            } else {
+                fourthVec = _mm512_set1_epi8(-1);
+            }
+            const int cycles = intrinsicType == 2 ? rowSize / (static_cast<int>(sizeof(Vector)) * 4) : DivideRoundUp(rowSize, sizeof(Vector) * 4);
+            const int lastCycleSize = rowSize - (cycles - 1) * static_cast<int>(sizeof(Vector)) * 4;
+            [[maybe_unused]] const uint64_t srcLastCycleMask = LowBitsMask(lastCycleSize / 4);
+            [[maybe_unused]] std::array<uint64_t, 4> dstLastCycleMasks;
+            for (int v = 0; v < static_cast<int>(dstLastCycleMasks.size()); ++v) {
+                dstLastCycleMasks[v] = LowBitsMask(std::clamp(lastCycleSize - v * static_cast<int>(sizeof(Vector)), 0, static_cast<int>(sizeof(Vector))));
+            }
+
+            for (int y = 0; y < height; ++y) {
+                const Vector *srcLine1 = reinterpret_cast<const Vector *>(srcs[0]);
+                const Vector *srcLine2 = reinterpret_cast<const Vector *>(srcs[1]);
+                const Vector *srcLine3 = reinterpret_cast<const Vector *>(srcs[2]);
+                Vector *dstLine = reinterpret_cast<Vector *>(dst);
+
+                for (int i = 0; i < cycles; ++i) {
+                    if constexpr (intrinsicType == 2) {
+                        const Vector srcVec1 = LoadVector(srcLine1++);
+                        const Vector srcVec2 = LoadVector(srcLine2++);
+                        const Vector srcVec3 = LoadVector(srcLine3++);
+
+                        Vector a, b, c, d;
+                        if constexpr (componentSize == 1) {
+                            const Vector lo12 = _mm256_unpacklo_epi8(srcVec1, srcVec2);
+                            const Vector hi12 = _mm256_unpackhi_epi8(srcVec1, srcVec2);
+                            const Vector lo34 = _mm256_unpacklo_epi8(srcVec3, fourthVec);
+                            const Vector hi34 = _mm256_unpackhi_epi8(srcVec3, fourthVec);
+                            a = _mm256_unpacklo_epi16(lo12, lo34);
+                            b = _mm256_unpackhi_epi16(lo12, lo34);
+                            c = _mm256_unpacklo_epi16(hi12, hi34);
+                            d = _mm256_unpackhi_epi16(hi12, hi34);
+                        } else {
+                            const Vector lo12 = _mm256_unpacklo_epi16(srcVec1, srcVec2);
+                            const Vector hi12 = _mm256_unpackhi_epi16(srcVec1, srcVec2);
+                            const Vector lo34 = _mm256_unpacklo_epi16(srcVec3, fourthVec);
+                            const Vector hi34 = _mm256_unpackhi_epi16(srcVec3, fourthVec);
+                            a = _mm256_unpacklo_epi32(lo12, lo34);
+                            b = _mm256_unpackhi_epi32(lo12, lo34);
+                            c = _mm256_unpacklo_epi32(hi12, hi34);
+                            d = _mm256_unpackhi_epi32(hi12, hi34);
+                        }
+
+                        // the two 128-bit lanes of each of a, b, c, d are two output vectors apart
+                        StoreVector(dstLine++, _mm256_permute2x128_si256(a, b, 0x20), false);
+                        StoreVector(dstLine++, _mm256_permute2x128_si256(c, d, 0x20), false);
+                        StoreVector(dstLine++, _mm256_permute2x128_si256(a, b, 0x31), false);
+                        StoreVector(dstLine++, _mm256_permute2x128_si256(c, d, 0x31), false);
+                    } else {
+                        const bool isLastCycle = i == cycles - 1;
+                        const uint64_t srcMask = isLastCycle ? srcLastCycleMask : ~0ULL;
+                        const Vector srcVec1 = _mm512_maskz_loadu_epi8(srcMask, srcLine1++);
+                        const Vector srcVec2 = _mm512_maskz_loadu_epi8(srcMask, srcLine2++);
+                        const Vector srcVec3 = _mm512_maskz_loadu_epi8(srcMask, srcLine3++);
+
+                        Vector a, b, c, d;
+                        if constexpr (componentSize == 1) {
+                            const Vector lo12 = _mm512_unpacklo_epi8(srcVec1, srcVec2);
+                            const Vector hi12 = _mm512_unpackhi_epi8(srcVec1, srcVec2);
+                            const Vector lo34 = _mm512_unpacklo_epi8(srcVec3, fourthVec);
+                            const Vector hi34 = _mm512_unpackhi_epi8(srcVec3, fourthVec);
+                            a = _mm512_unpacklo_epi16(lo12, lo34);
+                            b = _mm512_unpackhi_epi16(lo12, lo34);
+                            c = _mm512_unpacklo_epi16(hi12, hi34);
+                            d = _mm512_unpackhi_epi16(hi12, hi34);
+                        } else {
+                            const Vector lo12 = _mm512_unpacklo_epi16(srcVec1, srcVec2);
+                            const Vector hi12 = _mm512_unpackhi_epi16(srcVec1, srcVec2);
+                            const Vector lo34 = _mm512_unpacklo_epi16(srcVec3, fourthVec);
+                            const Vector hi34 = _mm512_unpackhi_epi16(srcVec3, fourthVec);
+                            a = _mm512_unpacklo_epi32(lo12, lo34);
+                            b = _mm512_unpackhi_epi32(lo12, lo34);
+                            c = _mm512_unpacklo_epi32(hi12, hi34);
+                            d = _mm512_unpackhi_epi32(hi12, hi34);
+                        }
+
+                        // 4x4 transpose of the 128-bit lanes
+                        const Vector ab01 = _mm512_shuffle_i64x2(a, b, 0x44);
+                        const Vector cd01 = _mm512_shuffle_i64x2(c, d, 0x44);
+                        const Vector ab23 = _mm512_shuffle_i64x2(a, b, 0xEE);
+                        const Vector cd23 = _mm512_shuffle_i64x2(c, d, 0xEE);
+                        _mm512_mask_storeu_epi8(dstLine++, isLastCycle ? dstLastCycleMasks[0] : ~0ULL, _mm512_shuffle_i64x2(ab01, cd01, 0x88));
+                        _mm512_mask_storeu_epi8(dstLine++, isLastCycle ? dstLastCycleMasks[1] : ~0ULL, _mm512_shuffle_i64x2(ab01, cd01, 0xDD));
+                        _mm512_mask_storeu_epi8(dstLine++, isLastCycle ? dstLastCycleMasks[2] : ~0ULL, _mm512_shuffle_i64x2(ab23, cd23, 0x88));
+                        _mm512_mask_storeu_epi8(dstLine++, isLastCycle ? dstLastCycleMasks[3] : ~0ULL, _mm512_shuffle_i64x2(ab23, cd23, 0xDD));
+                    }
+                }
+
+                for (size_t p = 0; p < srcs.size(); ++p) {
+                    srcs[p] += srcStrides[p];
+                }
+                dst += dstStride;
+            }
+        } else if constexpr (intrinsicType == 1) {
+            using Input = uint32_t;
+            using Output = __m128i;
+
+            Output shuffleMask;
+            if constexpr (colorFamily == 1) {
+                shuffleMask = _UV_SHUFFLE_MASK_M128_C2;
+            } else if constexpr (colorFamily == 2) {
+                shuffleMask = _RGB_SHUFFLE_MASK_M128_C1;
+            }
+            const Output initial = _mm_set1_epi8(-1);
 
-        Environment::GetInstance().Log(L"InterleaveThree() start");
+            const int cycles = rowSize / static_cast<int>(sizeof(Output));
 
-        using Input = uint32_t;
-        using Output = __m128i;
+            for (int y = 0; y < height; ++y) {
+                std::array<const Input *, srcs.size()> srcsLine;
+                for (size_t p = 0; p < srcs.size(); ++p) {
+                    srcsLine[p] = reinterpret_cast<const Input *>(srcs[p]);
+                }
+                Output *dstLine = reinterpret_cast<Output *>(dst);
+
+                for (int i = 0; i < cycles; ++i) {
+                    Output vec = _mm_insert_epi32(initial, *srcsLine[0]++, 0);
+                    vec = _mm_insert_epi32(vec, *srcsLine[1]++, 1);
+                    vec = _mm_insert_epi32(vec, *srcsLine[2]++, 2);
+                    StoreVector(dstLine++, _mm_shuffle_epi8(vec, shuffleMask), false);
+                }
 
-        Output shuffleMask;
-        if constexpr (colorFamily == 1) {
-            shuffleMask = _UV_SHUFFLE_MASK_M128_C2;
-        } else if constexpr (colorFamily == 2) {
-            shuffleMask = _RGB_SHUFFLE_MASK_M128_C1;
+                for (size_t p = 0; p < srcs.size(); ++p) {
+                    srcs[p] += srcStrides[p];
+                }
+                dst += dstStride;
+            }
+        } else {
+            using Component = std::array<BYTE, componentSize>;
+
+            Component fourthComponent;
+            fourthComponent.fill(0xFF);
+
+            const int cycles = rowSize / (static_cast<int>(sizeof(Component)) * 4);
+
+            for (int y = 0; y < height; ++y) {
+                std::array<const Component *, srcs.size()> srcsLine;
+                for (size_t p = 0; p < srcs.size(); ++p) {
+                    srcsLine[p] = reinterpret_cast<const Component *>(srcs[p]);
+                }
+                Component *dstLine = reinterpret_cast<Component *>(dst);
+
+                for (int i = 0; i < cycles; ++i) {
+                    *dstLine++ = *srcsLine[0]++;
+                    *dstLine++ = *srcsLine[1]++;
+                    *dstLine++ = *srcsLine[2]++;
+                    *dstLine++ = fourthComponent;
+                }
+
+                for (size_t p = 0; p < srcs.size(); ++p) {
+                    srcs[p] += srcStrides[p];
+                }
+                dst += dstStride;
+            }
         }
-        const Output initial = _mm_set1_epi8(-1);
 
-        const int cycles = DivideRoundUp(rowSize, sizeof(Output));
+        Environment::GetInstance().Log<LogLevel::Kernel>(L"InterleaveThree() end");
+    }
+
+    /*
+     * src and dst can be the same buffer for in-place shifting,
+     * or different ones so that the bytes are shifted while being copied
+     * isNonTemporal: write the destination with non-temporal stores whenever the row is aligned
+     */
+    template <int intrinsicType, int shiftSize, bool isRightShift, bool isNonTemporal = false>
+    static constexpr auto BitShiftEach16BitInt(const BYTE *src, BYTE *dst, int srcStride, int dstStride, int rowSize, int height) -> void {
+        Environment::GetInstance().Log<LogLevel::Kernel>(L"BitShiftEach16BitInt(%d) start", isRightShift);
+
+        using Vector = std::conditional_t<intrinsicType == 1, __m128i
+                     , std::conditional_t<intrinsicType == 2, __m256i
+                     , std::conditional_t<intrinsicType == 3, __m512i
+                     , uint16_t>>>;
+
+        // AVX-512 masks the last cycle of each row. SSE and AVX2 stop at the last whole vector, and leave the remaining columns to the non-SIMD version
+        int cycles;
+        if constexpr (intrinsicType == 1 || intrinsicType == 2) {
+            cycles = rowSize / static_cast<int>(sizeof(Vector));
+
+            const int vectorRowSize = cycles * static_cast<int>(sizeof(Vector));
+            if (vectorRowSize < rowSize) {
+                BitShiftEach16BitInt<0, shiftSize, isRightShift>(src + vectorRowSize, dst + vectorRowSize, srcStride, dstStride, rowSize - vectorRowSize, height);
+            }
+        } else {
+            cycles = DivideRoundUp(rowSize, sizeof(Vector));
+        }
+        [[maybe_unused]] const uint64_t lastCycleMask = LowBitsMask(rowSize - (cycles - 1) * static_cast<int>(sizeof(Vector)));
+
+        for (int y = 0; y < height; ++y) {
+            const Vector *srcLine = reinterpret_cast<const Vector *>(src);
+            Vector *dstLine = reinterpret_cast<Vector *>(dst);
+            const bool isNonTemporalRow = isNonTemporal && reinterpret_cast<uintptr_t>(dst) % sizeof(Vector) == 0;
+
+            for (int i = 0; i < cycles; ++i) {
+                if constexpr (intrinsicType == 3) {
+                    // mask the last cycle so that we never touch the bytes beyond rowSize
+                    if (i == cycles - 1) {
+                        _mm512_mask_storeu_epi8(dstLine, lastCycleMask, ShiftEach16BitInt<shiftSize, isRightShift>(_mm512_maskz_loadu_epi8(lastCycleMask, srcLine)));
+                        break;
+                    }
+
+                    StoreVector(dstLine++, ShiftEach16BitInt<shiftSize, isRightShift>(_mm512_loadu_si512(srcLine++)), isNonTemporalRow);
+                } else {
+                    StoreVector(dstLine++, ShiftEach16BitInt<shiftSize, isRightShift>(LoadVector(srcLine++)), isNonTemporalRow);
+                }
+            }
+
+            src += srcStride;
+            dst += dstStride;
+        }
+
+        if constexpr (isNonTemporal) {
+            _mm_sfence();
+        }
+
+        Environment::GetInstance().Log<LogLevel::Kernel>(L"BitShiftEach16BitInt(%d) end", isRightShift);
+    }
+
+    /*
+     * Copy a plane with non-temporal stores, for planes too large to stay in the cache anyway.
+     * The head of each row is copied normally until the destination is aligned to the vector size, and so is the tail.
+     */
+    template <int intrinsicType>
+    static constexpr auto CopyPlaneStreaming(const BYTE *src, BYTE *dst, int srcStride, int dstStride, int rowSize, int height) -> void {
+        Environment::GetInstance().Log<LogLevel::Kernel>(L"CopyPlaneStreaming() start");
+
+        using Vector = std::conditional_t<intrinsicType == 1, __m128i
+                     , std::conditional_t<intrinsicType == 2, __m256i
+                     , __m512i>>;
+
+        for (int y = 0; y < height; ++y) {
+            const int headSize = std::min(static_cast<int>((sizeof(Vector) - reinterpret_cast<uintptr_t>(dst) % sizeof(Vector)) % sizeof(Vector)), rowSize);
+            const int cycles = (rowSize - headSize) / static_cast<int>(sizeof(Vector));
+            const int tailOffset = headSize + cycles * static_cast<int>(sizeof(Vector));
+
+            memcpy(dst, src, headSize);
+
+            const Vector *srcLine = reinterpret_cast<const Vector *>(src + headSize);
+            Vector *dstLine = reinterpret_cast<Vector *>(dst + headSize);
+            for (int i = 0; i < cycles; ++i) {
+                StoreVector(dstLine++, LoadVector(srcLine++), true);
+            }
+
+            memcpy(dst + tailOffset, src + tailOffset, rowSize - tailOffset);
+
+            src += srcStride;
+            dst += dstStride;
+        }
+
+        _mm_sfence();
+
+        Environment::GetInstance().Log<LogLevel::Kernel>(L"CopyPlaneStreaming() end");
+    }
+
+    /*
+     * Right shift and mask one component out of two vectors of Y410 pixels, then pack them into one vector of 16-bit integers in the pixel order
+     */
+    template <int intrinsicType, int shiftSize, typename Vector>
+    static constexpr auto ExtractY410Plane(const Vector &srcVec1, const Vector &srcVec2, const Vector &andMask) -> Vector {
+        if constexpr (intrinsicType == 2) {
+            const Vector plane1 = _mm256_and_si256(_mm256_srli_epi32(srcVec1, shiftSize), andMask);
+            const Vector plane2 = _mm256_and_si256(_mm256_srli_epi32(srcVec2, shiftSize), andMask);
+            return _mm256_permute4x64_epi64(_mm256_packus_epi32(plane1, plane2), _UV_PERMUTE_INDEX);
+        } else if constexpr (intrinsicType == 3) {
+            const Vector plane1 = _mm512_and_si512(_mm512_srli_epi32(srcVec1, shiftSize), andMask);
+            const Vector plane2 = _mm512_and_si512(_mm512_srli_epi32(srcVec2, shiftSize), andMask);
+            return _mm512_permutexvar_epi64(_DEINTERLEAVE_UV_PERMUTE_INDEX_M512, _mm512_packus_epi32(plane1, plane2));
+        }
+    }
+
+    /*
+     * Y410 packs 10-bit U, Y, V and 2-bit alpha in each 32-bit integer
+     * intrinsicType: 2 = AVX2, 3 = AVX-512. Anything else: SSE4
+     */
+    template <int intrinsicType>
+    static constexpr auto DeinterleaveY410(const BYTE *src, int srcStride, std::array<BYTE *, 3> dsts, const std::array<int, 3> &dstStrides, int rowSize, int height) -> void {
+        /*
+         * For SSE, process one plane at a time by zeroing all other planes, shuffle it from different pixels together, and fix the position by right shifting.
+         *
+         * For AVX2 and AVX-512, right shift and mask each plane out of two vectors of pixels, pack them into one vector of 16-bit integers,
+         * then permute to correct the order across the 128-bit lanes.
+         *
+         * AVX-512 masks the last cycle of each row. SSE and AVX2 stop at the last whole input vector, and leave the remaining pixels to the non-SIMD version.
+         */
+
+        Environment::GetInstance().Log<LogLevel::Kernel>(L"DeinterleaveY410() start");
+
+        if constexpr (intrinsicType == 1 || intrinsicType == 2) {
+            const int inputSize = intrinsicType == 1 ? static_cast<int>(sizeof(__m128i)) : static_cast<int>(sizeof(__m256i)) * 2;
+            const int vectorRowSize = rowSize / inputSize * inputSize;
+            if (vectorRowSize < rowSize) {
+                DeinterleaveY410<0>(src + vectorRowSize, srcStride, { dsts[0] + vectorRowSize / 2, dsts[1] + vectorRowSize / 2, dsts[2] + vectorRowSize / 2 }, dstStrides, rowSize - vectorRowSize, height);
+            }
+        }
+
+        if constexpr (intrinsicType == 2 || intrinsicType == 3) {
+            using Vector = std::conditional_t<intrinsicType == 2, __m256i, __m512i>;
+
+            Vector andMask;
+            if constexpr (intrinsicType == 2) {
+                andMask = _mm256_set1_epi32(1023);
+            } else {
+                andMask = _mm512_set1_epi32(1023);
+            }
+            const int cycles = intrinsicType == 2 ? rowSize / (static_cast<int>(sizeof(Vector)) * 2) : DivideRoundUp(rowSize, sizeof(Vector) * 2);
+            const int lastCyclePixels = (rowSize - (cycles - 1) * static_cast<int>(sizeof(Vector)) * 2) / 4;
+            [[maybe_unused]] const uint64_t srcLastCycleMask1 = LowBitsMask(std::min(lastCyclePixels, 16));
+            [[maybe_unused]] const uint64_t srcLastCycleMask2 = LowBitsMask(std::max(lastCyclePixels - 16, 0));
+            [[maybe_unused]] const uint64_t dstLastCycleMask = LowBitsMask(lastCyclePixels);
+
+            for (int y = 0; y < height; ++y) {
+                const Vector *srcLine = reinterpret_cast<const Vector *>(src);
+                Vector *dstLine1 = reinterpret_cast<Vector *>(dsts[0]);
+                Vector *dstLine2 = reinterpret_cast<Vector *>(dsts[1]);
+                Vector *dstLine3 = reinterpret_cast<Vector *>(dsts[2]);
+
+                for (int i = 0; i < cycles; ++i) {
+                    if constexpr (intrinsicType == 2) {
+                        const Vector srcVec1 = LoadVector(srcLine++);
+                        const Vector srcVec2 = LoadVector(srcLine++);
+
+                        StoreVector(dstLine1++, ExtractY410Plane<intrinsicType, 0>(srcVec1, srcVec2, andMask), false);
+                        StoreVector(dstLine2++, ExtractY410Plane<intrinsicType, 10>(srcVec1, srcVec2, andMask), false);
+                        StoreVector(dstLine3++, ExtractY410Plane<intrinsicType, 20>(srcVec1, srcVec2, andMask), false);
+                    } else {
+                        const bool isLastCycle = i == cycles - 1;
+                        const Vector srcVec1 = _mm512_maskz_loadu_epi32(static_cast<__mmask16>(isLastCycle ? srcLastCycleMask1 : ~0ULL), srcLine++);
+                        const Vector srcVec2 = _mm512_maskz_loadu_epi32(static_cast<__mmask16>(isLastCycle ? srcLastCycleMask2 : ~0ULL), srcLine++);
+                        const __mmask32 dstMask = static_cast<__mmask32>(isLastCycle ? dstLastCycleMask : ~0ULL);
+
+                        _mm512_mask_storeu_epi16(dstLine1++, dstMask, ExtractY410Plane<intrinsicType, 0>(srcVec1, srcVec2, andMask));
+                        _mm512_mask_storeu_epi16(dstLine2++, dstMask, ExtractY410Plane<intrinsicType, 10>(srcVec1, srcVec2, andMask));
+                        _mm512_mask_storeu_epi16(dstLine3++, dstMask, ExtractY410Plane<intrinsicType, 20>(srcVec1, srcVec2, andMask));
+                    }
+                }
+
+                src += srcStride;
+                for (size_t p = 0; p < dsts.size(); ++p) {
+                    dsts[p] += dstStrides[p];
+                }
+            }
+        } else if constexpr (intrinsicType == 1) {
+            using Input = __m128i;
+            using Output = uint64_t;
+
+            for (int y = 0; y < height; ++y) {
+                const Input *srcLine = reinterpret_cast<const Input *>(src);
+                std::array<Output *, dsts.size()> dstsLine;
+                for (size_t p = 0; p < dsts.size(); ++p) {
+                    dstsLine[p] = reinterpret_cast<Output *>(dsts[p]);
+                }
+
+                for (int i = 0; i < rowSize / static_cast<int>(sizeof(Input)); ++i) {
+                    const Input srcVec = LoadVector(srcLine++);
+
+                    const Input dataVec1 = _mm_shuffle_epi8(_mm_and_si128(srcVec, _Y410_AND_MASK_1), _Y410_SHUFFLE_MASK_1);
+                    const Input dataVec2 = _mm_srli_epi32(_mm_shuffle_epi8(_mm_and_si128(srcVec, _Y410_AND_MASK_2), _Y410_SHUFFLE_MASK_2), 2);
+                    const Input dataVec3 = _mm_srli_epi32(_mm_shuffle_epi8(_mm_and_si128(srcVec, _Y410_AND_MASK_3), _Y410_SHUFFLE_MASK_3), 4);
+
+                    *dstsLine[0]++ = *reinterpret_cast<const Output *>(&dataVec1);
+                    *dstsLine[1]++ = *reinterpret_cast<const Output *>(&dataVec2);
+                    *dstsLine[2]++ = *reinterpret_cast<const Output *>(&dataVec3);
+                }
+
+                src += srcStride;
+                for (size_t p = 0; p < dsts.size(); ++p) {
+                    dsts[p] += dstStrides[p];
+                }
+            }
+        } else {
+            for (int y = 0; y < height; ++y) {
+                const uint32_t *srcLine = reinterpret_cast<const uint32_t *>(src);
+                std::array<uint16_t *, dsts.size()> dstsLine;
+                for (size_t p = 0; p < dsts.size(); ++p) {
+                    dstsLine[p] = reinterpret_cast<uint16_t *>(dsts[p]);
+                }
+
+                for (int i = 0; i < rowSize / static_cast<int>(sizeof(uint32_t)); ++i) {
+                    const uint32_t pixel = *srcLine++;
+
+                    *dstsLine[0]++ = static_cast<uint16_t>(pixel & 1023);
+                    *dstsLine[1]++ = static_cast<uint16_t>((pixel >> 10) & 1023);
+                    *dstsLine[2]++ = static_cast<uint16_t>((pixel >> 20) & 1023);
+                }
+
+                src += srcStride;
+                for (size_t p = 0; p < dsts.size(); ++p) {
+                    dsts[p] += dstStrides[p];
+                }
+            }
+        }
+
+        Environment::GetInstance().Log<LogLevel::Kernel>(L"DeinterleaveY410() end");
+    }
+
+    template <int intrinsicType>
+    static constexpr auto InterleaveY410(std::array<const BYTE *, 3> srcs, const std::array<int, 3> &srcStrides, BYTE *dst, int dstStride, int rowSize, int height) -> void {
+        // expand each 16-bit integer to 32-bit, left shift to right position and OR them all
+        // due the expansion, only half the size for each source vector is used, therefore we need to cast
+        // AVX-512 masks the last cycle of each row. SSE and AVX2 stop at the last whole output vector, and leave the remaining pixels to the non-SIMD version
+
+        Environment::GetInstance().Log<LogLevel::Kernel>(L"InterleaveY410() start");
+
+        using Input = std::conditional_t<intrinsicType == 1, uint64_t
+                    , std::conditional_t<intrinsicType == 2, __m128i
+                    , std::conditional_t<intrinsicType == 3, __m256i
+                    , uint16_t>>>;
+        using Output = std::conditional_t<intrinsicType == 1, __m128i
+                     , std::conditional_t<intrinsicType == 2, __m256i
+                     , std::conditional_t<intrinsicType == 3, __m512i
+                     , uint32_t>>>;
+
+        int cycles;
+        if constexpr (intrinsicType == 1 || intrinsicType == 2) {
+            cycles = rowSize / static_cast<int>(sizeof(Output));
+
+            const int vectorRowSize = cycles * static_cast<int>(sizeof(Output));
+            if (vectorRowSize < rowSize) {
+                InterleaveY410<0>({ srcs[0] + vectorRowSize / 2, srcs[1] + vectorRowSize / 2, srcs[2] + vectorRowSize / 2 }, srcStrides, dst + vectorRowSize, dstStride, rowSize - vectorRowSize, height);
+            }
+        } else {
+            cycles = DivideRoundUp(rowSize, sizeof(Output));
+        }
+        [[maybe_unused]] const uint64_t lastCycleMask = LowBitsMask((rowSize - (cycles - 1) * static_cast<int>(sizeof(Output))) / 4);
 
         for (int y = 0; y < height; ++y) {
             std::array<const Input *, srcs.size()> srcsLine;
@@ -331,10 +1111,276 @@ private:
             Output *dstLine = reinterpret_cast<Output *>(dst);
 
             for (int i = 0; i < cycles; ++i) {
-                Output vec = _mm_insert_epi32(initial, *srcsLine[0]++, 0);
-                vec = _mm_insert_epi32(vec, *srcsLine[1]++, 1);
-                vec = _mm_insert_epi32(vec, *srcsLine[2]++, 2);
-                *dstLine++ = _mm_shuffle_epi8(vec, shuffleMask);
+                if constexpr (intrinsicType == 2) {
+                    const Output vec1 = _mm256_cvtepu16_epi32(LoadVector(srcsLine[0]++));
+                    const Output vec2 = _mm256_slli_epi32(_mm256_cvtepu16_epi32(LoadVector(srcsLine[1]++)), 10);
+                    const Output vec3 = _mm256_slli_epi32(_mm256_cvtepu16_epi32(LoadVector(srcsLine[2]++)), 20);
+                    StoreVector(dstLine++, _mm256_or_si256(_mm256_or_si256(vec1, vec2), vec3), false);
+                } else if constexpr (intrinsicType == 3) {
+                    const __mmask16 mask = static_cast<__mmask16>(i == cycles - 1 ? lastCycleMask : ~0ULL);
+                    const Output vec1 = _mm512_cvtepu16_epi32(_mm256_maskz_loadu_epi16(mask, srcsLine[0]++));
+                    const Output vec2 = _mm512_slli_epi32(_mm512_cvtepu16_epi32(_mm256_maskz_loadu_epi16(mask, srcsLine[1]++)), 10);
+                    const Output vec3 = _mm512_slli_epi32(_mm512_cvtepu16_epi32(_mm256_maskz_loadu_epi16(mask, srcsLine[2]++)), 20);
+                    _mm512_mask_storeu_epi32(dstLine++, mask, _mm512_or_si512(_mm512_or_si512(vec1, vec2), vec3));
+                } else if constexpr (intrinsicType == 1) {
+                    const Output vec1 = _mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(srcsLine[0]++)));
+                    const Output vec2 = _mm_slli_epi32(_mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(srcsLine[1]++))), 10);
+                    const Output vec3 = _mm_slli_epi32(_mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(srcsLine[2]++))), 20);
+                    StoreVector(dstLine++, _mm_or_si128(_mm_or_si128(vec1, vec2), vec3), false);
+                } else {
+                    *dstLine++ = static_cast<Output>(*srcsLine[0]++) | (static_cast<Output>(*srcsLine[1]++) << 10) | (static_cast<Output>(*srcsLine[2]++) << 20);
+                }
+            }
+
+            for (size_t p = 0; p < srcs.size(); ++p) {
+                srcs[p] += srcStrides[p];
+            }
+            dst += dstStride;
+        }
+
+        Environment::GetInstance().Log<LogLevel::Kernel>(L"InterleaveY410() end");
+    }
+
+    /*
+     * RGB24 and RGB48 pack three components in each 3- or 6-byte pixel, which no vector size divides evenly
+     * The components are written to the destinations in their source order. Callers reorder them by ordering the destinations (e.g. R-G-B to the frame server's planes)
+     * intrinsicType: 1 = SSE4, 2 = AVX2, 3 = AVX-512. Anything else: non-SIMD
+     * componentSize is the size per pixel component (1 for RGB24, 2 for RGB48)
+     */
+    template <int intrinsicType, int componentSize>
+    static constexpr auto DeinterleaveRGB(const BYTE *src, int srcStride, std::array<BYTE *, 3> dsts, const std::array<int, 3> &dstStrides, int rowSize, int height) -> void {
+        /*
+         * For SSE, load 48 bytes of pixels into three vectors, shuffle each component out of each vector to its final position and OR the three parts together.
+         *
+         * For AVX2, load the next 48 bytes into the upper 128-bit lanes, so that the same in-lane shuffles produce twice the pixels of each component in order.
+         *
+         * For AVX-512, regroup the 128-bit lanes of three whole vectors the same way with two cross-lane permutes of 64-bit integers each, then shuffle like AVX2.
+         *
+         * AVX-512 masks the last cycle of each row. SSE and AVX2 stop at the last whole cycle, and leave the remaining pixels to the non-SIMD version.
+         */
+
+        Environment::GetInstance().Log<LogLevel::Kernel>(L"DeinterleaveRGB() start");
+
+        constexpr int cycleSize = intrinsicType == 1 ? static_cast<int>(sizeof(__m128i)) * 3
+                                : intrinsicType == 2 ? static_cast<int>(sizeof(__m256i)) * 3
+                                : intrinsicType == 3 ? static_cast<int>(sizeof(__m512i)) * 3
+                                : componentSize * 3;
+        const std::array<std::array<__m128i, 3>, 3> &shuffleMasks = componentSize == 1 ? _RGB24_DEINTERLEAVE_SHUFFLE_MASKS : _RGB48_DEINTERLEAVE_SHUFFLE_MASKS;
+
+        int cycles;
+        if constexpr (intrinsicType == 1 || intrinsicType == 2) {
+            cycles = rowSize / cycleSize;
+
+            const int vectorRowSize = cycles * cycleSize;
+            if (vectorRowSize < rowSize) {
+                DeinterleaveRGB<0, componentSize>(src + vectorRowSize, srcStride, { dsts[0] + vectorRowSize / 3, dsts[1] + vectorRowSize / 3, dsts[2] + vectorRowSize / 3 }, dstStrides, rowSize - vectorRowSize, height);
+            }
+        } else {
+            cycles = DivideRoundUp(rowSize, cycleSize);
+        }
+        const int lastCycleSize = rowSize - (cycles - 1) * cycleSize;
+        [[maybe_unused]] std::array<uint64_t, 3> srcLastCycleMasks;
+        for (int v = 0; v < static_cast<int>(srcLastCycleMasks.size()); ++v) {
+            srcLastCycleMasks[v] = LowBitsMask(std::clamp(lastCycleSize - v * cycleSize / 3, 0, cycleSize / 3));
+        }
+        [[maybe_unused]] const uint64_t dstLastCycleMask = LowBitsMask(lastCycleSize / 3);
+
+        [[maybe_unused]] std::array<std::array<__m256i, 3>, 3> shuffleMasksM256;
+        [[maybe_unused]] std::array<std::array<__m512i, 3>, 3> shuffleMasksM512;
+        for (int v = 0; v < 3; ++v) {
+            for (int c = 0; c < 3; ++c) {
+                if constexpr (intrinsicType == 2) {
+                    shuffleMasksM256[v][c] = _mm256_broadcastsi128_si256(shuffleMasks[v][c]);
+                } else if constexpr (intrinsicType == 3) {
+                    shuffleMasksM512[v][c] = _mm512_broadcast_i32x4(shuffleMasks[v][c]);
+                }
+            }
+        }
+
+        for (int y = 0; y < height; ++y) {
+            const BYTE *srcLine = src;
+            std::array<BYTE *, 3> dstsLine = dsts;
+
+            for (int i = 0; i < cycles; ++i) {
+                if constexpr (intrinsicType == 1) {
+                    const std::array srcVecs {
+                        LoadVector(reinterpret_cast<const __m128i *>(srcLine)),
+                        LoadVector(reinterpret_cast<const __m128i *>(srcLine + 16)),
+                        LoadVector(reinterpret_cast<const __m128i *>(srcLine + 32)),
+                    };
+
+                    for (int c = 0; c < 3; ++c) {
+                        const __m128i dataVec = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(srcVecs[0], shuffleMasks[0][c]),
+                                                                          _mm_shuffle_epi8(srcVecs[1], shuffleMasks[1][c])),
+                                                             _mm_shuffle_epi8(srcVecs[2], shuffleMasks[2][c]));
+                        StoreVector(reinterpret_cast<__m128i *>(dstsLine[c]), dataVec, false);
+                        dstsLine[c] += sizeof(__m128i);
+                    }
+                } else if constexpr (intrinsicType == 2) {
+                    std::array<__m256i, 3> srcVecs;
+                    for (int v = 0; v < 3; ++v) {
+                        const __m128i lo = LoadVector(reinterpret_cast<const __m128i *>(srcLine + v * 16));
+                        const __m128i hi = LoadVector(reinterpret_cast<const __m128i *>(srcLine + v * 16 + 48));
+                        srcVecs[v] = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+                    }
+
+                    for (int c = 0; c < 3; ++c) {
+                        const __m256i dataVec = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(srcVecs[0], shuffleMasksM256[0][c]),
+                                                                                _mm256_shuffle_epi8(srcVecs[1], shuffleMasksM256[1][c])),
+                                                                _mm256_shuffle_epi8(srcVecs[2], shuffleMasksM256[2][c]));
+                        StoreVector(reinterpret_cast<__m256i *>(dstsLine[c]), dataVec, false);
+                        dstsLine[c] += sizeof(__m256i);
+                    }
+                } else if constexpr (intrinsicType == 3) {
+                    const bool isLastCycle = i == cycles - 1;
+                    std::array<__m512i, 3> loadVecs;
+                    for (int v = 0; v < 3; ++v) {
+                        loadVecs[v] = _mm512_maskz_loadu_epi8(isLastCycle ? srcLastCycleMasks[v] : ~0ULL, srcLine + v * sizeof(__m512i));
+                    }
+
+                    // the 128-bit lane k of srcVecs[v] is the 128-bit lane 3 * k + v of the loaded bytes
+                    std::array<__m512i, 3> srcVecs;
+                    for (int v = 0; v < 3; ++v) {
+                        const __m512i firstTwoVec = _mm512_permutex2var_epi64(loadVecs[0], _RGB_DEINTERLEAVE_PERMUTE_INDICES_M512[v][0], loadVecs[1]);
+                        srcVecs[v] = _mm512_permutex2var_epi64(firstTwoVec, _RGB_DEINTERLEAVE_PERMUTE_INDICES_M512[v][1], loadVecs[2]);
+                    }
+
+                    for (int c = 0; c < 3; ++c) {
+                        const __m512i dataVec = _mm512_or_si512(_mm512_or_si512(_mm512_shuffle_epi8(srcVecs[0], shuffleMasksM512[0][c]),
+                                                                                _mm512_shuffle_epi8(srcVecs[1], shuffleMasksM512[1][c])),
+                                                                _mm512_shuffle_epi8(srcVecs[2], shuffleMasksM512[2][c]));
+                        _mm512_mask_storeu_epi8(dstsLine[c], isLastCycle ? dstLastCycleMask : ~0ULL, dataVec);
+                        dstsLine[c] += sizeof(__m512i);
+                    }
+                } else {
+                    for (int c = 0; c < 3; ++c) {
+                        memcpy(dstsLine[c], srcLine + c * componentSize, componentSize);
+                        dstsLine[c] += componentSize;
+                    }
+                }
+
+                srcLine += cycleSize;
+            }
+
+            src += srcStride;
+            for (int p = 0; p < 3; ++p) {
+                dsts[p] += dstStrides[p];
+            }
+        }
+
+        Environment::GetInstance().Log<LogLevel::Kernel>(L"DeinterleaveRGB() end");
+    }
+
+    template <int intrinsicType, int componentSize>
+    static constexpr auto InterleaveRGB(std::array<const BYTE *, 3> srcs, const std::array<int, 3> &srcStrides, BYTE *dst, int dstStride, int rowSize, int height) -> void {
+        // the reverse of DeinterleaveRGB(): each output vector is the OR of one shuffle of each of the three sources
+        // AVX2 produces the 48-byte groups in the 128-bit lanes out of order, so the lanes are swapped back when stored. AVX-512 regroups them with two permutes per output vector
+        // AVX-512 masks the last cycle of each row. SSE and AVX2 stop at the last whole cycle, and leave the remaining pixels to the non-SIMD version
+
+        Environment::GetInstance().Log<LogLevel::Kernel>(L"InterleaveRGB() start");
+
+        constexpr int cycleSize = intrinsicType == 1 ? static_cast<int>(sizeof(__m128i)) * 3
+                                : intrinsicType == 2 ? static_cast<int>(sizeof(__m256i)) * 3
+                                : intrinsicType == 3 ? static_cast<int>(sizeof(__m512i)) * 3
+                                : componentSize * 3;
+        const std::array<std::array<__m128i, 3>, 3> &shuffleMasks = componentSize == 1 ? _RGB24_INTERLEAVE_SHUFFLE_MASKS : _RGB48_INTERLEAVE_SHUFFLE_MASKS;
+
+        int cycles;
+        if constexpr (intrinsicType == 1 || intrinsicType == 2) {
+            cycles = rowSize / cycleSize;
+
+            const int vectorRowSize = cycles * cycleSize;
+            if (vectorRowSize < rowSize) {
+                InterleaveRGB<0, componentSize>({ srcs[0] + vectorRowSize / 3, srcs[1] + vectorRowSize / 3, srcs[2] + vectorRowSize / 3 }, srcStrides, dst + vectorRowSize, dstStride, rowSize - vectorRowSize, height);
+            }
+        } else {
+            cycles = DivideRoundUp(rowSize, cycleSize);
+        }
+        const int lastCycleSize = rowSize - (cycles - 1) * cycleSize;
+        [[maybe_unused]] const uint64_t srcLastCycleMask = LowBitsMask(lastCycleSize / 3);
+        [[maybe_unused]] std::array<uint64_t, 3> dstLastCycleMasks;
+        for (int v = 0; v < static_cast<int>(dstLastCycleMasks.size()); ++v) {
+            dstLastCycleMasks[v] = LowBitsMask(std::clamp(lastCycleSize - v * cycleSize / 3, 0, cycleSize / 3));
+        }
+
+        [[maybe_unused]] std::array<std::array<__m256i, 3>, 3> shuffleMasksM256;
+        [[maybe_unused]] std::array<std::array<__m512i, 3>, 3> shuffleMasksM512;
+        for (int v = 0; v < 3; ++v) {
+            for (int c = 0; c < 3; ++c) {
+                if constexpr (intrinsicType == 2) {
+                    shuffleMasksM256[v][c] = _mm256_broadcastsi128_si256(shuffleMasks[v][c]);
+                } else if constexpr (intrinsicType == 3) {
+                    shuffleMasksM512[v][c] = _mm512_broadcast_i32x4(shuffleMasks[v][c]);
+                }
+            }
+        }
+
+        for (int y = 0; y < height; ++y) {
+            std::array<const BYTE *, 3> srcsLine = srcs;
+            BYTE *dstLine = dst;
+
+            for (int i = 0; i < cycles; ++i) {
+                if constexpr (intrinsicType == 1) {
+                    std::array<__m128i, 3> srcVecs;
+                    for (int c = 0; c < 3; ++c) {
+                        srcVecs[c] = LoadVector(reinterpret_cast<const __m128i *>(srcsLine[c]));
+                        srcsLine[c] += sizeof(__m128i);
+                    }
+
+                    for (int v = 0; v < 3; ++v) {
+                        const __m128i dataVec = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(srcVecs[0], shuffleMasks[v][0]),
+                                                                          _mm_shuffle_epi8(srcVecs[1], shuffleMasks[v][1])),
+                                                             _mm_shuffle_epi8(srcVecs[2], shuffleMasks[v][2]));
+                        StoreVector(reinterpret_cast<__m128i *>(dstLine + v * sizeof(__m128i)), dataVec, false);
+                    }
+                } else if constexpr (intrinsicType == 2) {
+                    std::array<__m256i, 3> srcVecs;
+                    for (int c = 0; c < 3; ++c) {
+                        srcVecs[c] = LoadVector(reinterpret_cast<const __m256i *>(srcsLine[c]));
+                        srcsLine[c] += sizeof(__m256i);
+                    }
+
+                    // the lower lanes hold the first 48 bytes, the upper lanes the next 48
+                    std::array<__m256i, 3> dataVecs;
+                    for (int v = 0; v < 3; ++v) {
+                        dataVecs[v] = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(srcVecs[0], shuffleMasksM256[v][0]),
+                                                                      _mm256_shuffle_epi8(srcVecs[1], shuffleMasksM256[v][1])),
+                                                      _mm256_shuffle_epi8(srcVecs[2], shuffleMasksM256[v][2]));
+                    }
+
+                    __m256i *dstVecLine = reinterpret_cast<__m256i *>(dstLine);
+                    StoreVector(dstVecLine++, _mm256_permute2x128_si256(dataVecs[0], dataVecs[1], 0x20), false);
+                    StoreVector(dstVecLine++, _mm256_permute2x128_si256(dataVecs[2], dataVecs[0], 0x30), false);
+                    StoreVector(dstVecLine++, _mm256_permute2x128_si256(dataVecs[1], dataVecs[2], 0x31), false);
+                } else if constexpr (intrinsicType == 3) {
+                    const bool isLastCycle = i == cycles - 1;
+                    std::array<__m512i, 3> srcVecs;
+                    for (int c = 0; c < 3; ++c) {
+                        srcVecs[c] = _mm512_maskz_loadu_epi8(isLastCycle ? srcLastCycleMask : ~0ULL, srcsLine[c]);
+                        srcsLine[c] += sizeof(__m512i);
+                    }
+
+                    // the 128-bit lane k of dataVecs[v] is the 128-bit lane 3 * k + v of the output
+                    std::array<__m512i, 3> dataVecs;
+                    for (int v = 0; v < 3; ++v) {
+                        dataVecs[v] = _mm512_or_si512(_mm512_or_si512(_mm512_shuffle_epi8(srcVecs[0], shuffleMasksM512[v][0]),
+                                                                      _mm512_shuffle_epi8(srcVecs[1], shuffleMasksM512[v][1])),
+                                                      _mm512_shuffle_epi8(srcVecs[2], shuffleMasksM512[v][2]));
+                    }
+
+                    for (int v = 0; v < 3; ++v) {
+                        const __m512i firstTwoVec = _mm512_permutex2var_epi64(dataVecs[0], _RGB_INTERLEAVE_PERMUTE_INDICES_M512[v][0], dataVecs[1]);
+                        const __m512i dstVec = _mm512_permutex2var_epi64(firstTwoVec, _RGB_INTERLEAVE_PERMUTE_INDICES_M512[v][1], dataVecs[2]);
+                        _mm512_mask_storeu_epi8(dstLine + v * sizeof(__m512i), isLastCycle ? dstLastCycleMasks[v] : ~0ULL, dstVec);
+                    }
+                } else {
+                    for (int c = 0; c < 3; ++c) {
+                        memcpy(dstLine + c * componentSize, srcsLine[c], componentSize);
+                        srcsLine[c] += componentSize;
+                    }
+                }
+
+                dstLine += cycleSize;
             }
 
             for (size_t p = 0; p < srcs.size(); ++p) {
@@ -343,65 +1389,514 @@ private:
             dst += dstStride;
         }
 
-        Environment::GetInstance().Log(L"InterleaveThree() end");
+        Environment::GetInstance().Log<LogLevel::Kernel>(L"InterleaveRGB() end");
     }
 
-    template <int intrinsicType, int shiftSize, bool isRightShift>
-    static constexpr auto BitShiftEach16BitInt(BYTE *src, BYTE *dst, int stride, int rowSize, int height) -> void {
-        Environment::GetInstance().Log(L"BitShiftEach16BitInt(%d) start", isRightShift);
+    /*
+     * YUY2, Y210 and Y216 pack two pixels in Y0-U-Y1-V order, which are unpacked to the Y, U and V planes
+     * componentSize is the size per pixel component (1 for YUY2, 2 for Y210 and Y216)
+     * rightShiftSize: if non-zero, each 16-bit component is right shifted while being deinterleaved (e.g. Y210)
+     * intrinsicType: 1 = SSE4, 2 = AVX2, 3 = AVX-512. Anything else: non-SIMD
+     */
+    template <int intrinsicType, int componentSize, int rightShiftSize>
+    static constexpr auto DeinterleaveYUY2(const BYTE *src, int srcStride, std::array<BYTE *, 3> dsts, const std::array<int, 3> &dstStrides, int rowSize, int height) -> void {
+        /*
+         * Shuffle each 128-bit lane to Y-U-V with 8 bytes of Y, then unpack the 64-bit integers of two vectors to the Y vector and the UV vector.
+         * AVX2 and AVX-512 further permute both across the 128-bit lanes.
+         *
+         * AVX-512 masks the last cycle of each row. SSE and AVX2 stop at the last whole cycle, and leave the remaining pixels to the non-SIMD version.
+         */
+
+        Environment::GetInstance().Log<LogLevel::Kernel>(L"DeinterleaveYUY2() start");
 
         using Vector = std::conditional_t<intrinsicType == 1, __m128i
                      , std::conditional_t<intrinsicType == 2, __m256i
-                     , uint16_t>>;
+                     , std::conditional_t<intrinsicType == 3, __m512i
+                     , std::array<BYTE, componentSize * 4>>>>;
+        constexpr int cycleSize = intrinsicType >= 1 && intrinsicType <= 3 ? static_cast<int>(sizeof(Vector)) * 2 : static_cast<int>(sizeof(Vector));
+
+        int cycles;
+        if constexpr (intrinsicType == 1 || intrinsicType == 2) {
+            cycles = rowSize / cycleSize;
+
+            const int vectorRowSize = cycles * cycleSize;
+            if (vectorRowSize < rowSize) {
+                DeinterleaveYUY2<0, componentSize, rightShiftSize>(src + vectorRowSize, srcStride, { dsts[0] + vectorRowSize / 2, dsts[1] + vectorRowSize / 4, dsts[2] + vectorRowSize / 4 }, dstStrides, rowSize - vectorRowSize, height);
+            }
+        } else {
+            cycles = DivideRoundUp(rowSize, cycleSize);
+        }
+        const int lastCycleSize = rowSize - (cycles - 1) * cycleSize;
+        [[maybe_unused]] const uint64_t srcLastCycleMask1 = LowBitsMask(std::min(lastCycleSize, 64));
+        [[maybe_unused]] const uint64_t srcLastCycleMask2 = LowBitsMask(std::max(lastCycleSize - 64, 0));
+        [[maybe_unused]] const uint64_t dstLastCycleMaskY = LowBitsMask(lastCycleSize / 2);
+        [[maybe_unused]] const uint64_t dstLastCycleMaskUV = LowBitsMask(lastCycleSize / 4);
 
-        const int cycles = DivideRoundUp(rowSize, sizeof(Vector));
+        [[maybe_unused]] Vector shuffleMask;
+        if constexpr (intrinsicType == 1) {
+            shuffleMask = componentSize == 1 ? _YUY2_SHUFFLE_MASK_M128 : _Y210_SHUFFLE_MASK_M128;
+        } else if constexpr (intrinsicType == 2) {
+            shuffleMask = _mm256_broadcastsi128_si256(componentSize == 1 ? _YUY2_SHUFFLE_MASK_M128 : _Y210_SHUFFLE_MASK_M128);
+        } else if constexpr (intrinsicType == 3) {
+            shuffleMask = _mm512_broadcast_i32x4(componentSize == 1 ? _YUY2_SHUFFLE_MASK_M128 : _Y210_SHUFFLE_MASK_M128);
+        }
 
         for (int y = 0; y < height; ++y) {
-            Vector *srcLine = reinterpret_cast<Vector *>(src);
+            const Vector *srcLine = reinterpret_cast<const Vector *>(src);
+            BYTE *dstLineY = dsts[0];
+            BYTE *dstLineU = dsts[1];
+            BYTE *dstLineV = dsts[2];
+
+            for (int i = 0; i < cycles; ++i) {
+                if constexpr (intrinsicType == 1) {
+                    const __m128i srcVec1 = _mm_shuffle_epi8(ShiftEach16BitInt<rightShiftSize, true>(LoadVector(srcLine++)), shuffleMask);
+                    const __m128i srcVec2 = _mm_shuffle_epi8(ShiftEach16BitInt<rightShiftSize, true>(LoadVector(srcLine++)), shuffleMask);
+                    const __m128i uvVec = _mm_shuffle_epi32(_mm_unpackhi_epi64(srcVec1, srcVec2), _UV_PERMUTE_INDEX);
+
+                    StoreVector(reinterpret_cast<__m128i *>(dstLineY), _mm_unpacklo_epi64(srcVec1, srcVec2), false);
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(dstLineU), uvVec);
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(dstLineV), _mm_unpackhi_epi64(uvVec, uvVec));
+                } else if constexpr (intrinsicType == 2) {
+                    const __m256i srcVec1 = _mm256_shuffle_epi8(ShiftEach16BitInt<rightShiftSize, true>(LoadVector(srcLine++)), shuffleMask);
+                    const __m256i srcVec2 = _mm256_shuffle_epi8(ShiftEach16BitInt<rightShiftSize, true>(LoadVector(srcLine++)), shuffleMask);
+                    const __m256i uvVec = _mm256_permutevar8x32_epi32(_mm256_unpackhi_epi64(srcVec1, srcVec2), _mm256_setr_epi32(0, 4, 2, 6, 1, 5, 3, 7));
+
+                    StoreVector(reinterpret_cast<__m256i *>(dstLineY), _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(srcVec1, srcVec2), _UV_PERMUTE_INDEX), false);
+                    StoreVector(reinterpret_cast<__m128i *>(dstLineU), _mm256_castsi256_si128(uvVec), false);
+                    StoreVector(reinterpret_cast<__m128i *>(dstLineV), _mm256_extracti128_si256(uvVec, 1), false);
+                } else if constexpr (intrinsicType == 3) {
+                    const bool isLastCycle = i == cycles - 1;
+                    const __m512i srcVec1 = _mm512_shuffle_epi8(ShiftEach16BitInt<rightShiftSize, true>(_mm512_maskz_loadu_epi8(isLastCycle ? srcLastCycleMask1 : ~0ULL, srcLine++)), shuffleMask);
+                    const __m512i srcVec2 = _mm512_shuffle_epi8(ShiftEach16BitInt<rightShiftSize, true>(_mm512_maskz_loadu_epi8(isLastCycle ? srcLastCycleMask2 : ~0ULL, srcLine++)), shuffleMask);
+                    const __m512i uvVec = _mm512_permutexvar_epi32(_YUY2_DEINTERLEAVE_UV_PERMUTE_INDEX_M512, _mm512_unpackhi_epi64(srcVec1, srcVec2));
+                    const __mmask32 dstMaskUV = static_cast<__mmask32>(isLastCycle ? dstLastCycleMaskUV : ~0ULL);
+
+                    _mm512_mask_storeu_epi8(dstLineY, isLastCycle ? dstLastCycleMaskY : ~0ULL, _mm512_permutexvar_epi64(_DEINTERLEAVE_UV_PERMUTE_INDEX_M512, _mm512_unpacklo_epi64(srcVec1, srcVec2)));
+                    _mm256_mask_storeu_epi8(dstLineU, dstMaskUV, _mm512_castsi512_si256(uvVec));
+                    _mm256_mask_storeu_epi8(dstLineV, dstMaskUV, _mm512_extracti64x4_epi64(uvVec, 1));
+                } else {
+                    const Vector srcVec = ShiftEach16BitInt<rightShiftSize, true>(*srcLine++);
+
+                    memcpy(dstLineY, srcVec.data(), componentSize);
+                    memcpy(dstLineY + componentSize, srcVec.data() + componentSize * 2, componentSize);
+                    memcpy(dstLineU, srcVec.data() + componentSize, componentSize);
+                    memcpy(dstLineV, srcVec.data() + componentSize * 3, componentSize);
+                }
+
+                dstLineY += cycleSize / 2;
+                dstLineU += cycleSize / 4;
+                dstLineV += cycleSize / 4;
+            }
+
+            src += srcStride;
+            for (int p = 0; p < 3; ++p) {
+                dsts[p] += dstStrides[p];
+            }
+        }
+
+        Environment::GetInstance().Log<LogLevel::Kernel>(L"DeinterleaveYUY2() end");
+    }
+
+    template <int intrinsicType, int componentSize, int leftShiftSize>
+    static constexpr auto InterleaveYUY2(std::array<const BYTE *, 3> srcs, const std::array<int, 3> &srcStrides, BYTE *dst, int dstStride, int rowSize, int height) -> void {
+        // interleave U with V, then Y with UV. AVX2 corrects the order of the 128-bit lanes when storing
+        // AVX-512 permutes Y, U and V across the 128-bit lanes beforehand, so that the in-lane interleaving produces the output in order
+        // AVX-512 masks the last cycle of each row. SSE and AVX2 stop at the last whole cycle, and leave the remaining pixels to the non-SIMD version
+
+        Environment::GetInstance().Log<LogLevel::Kernel>(L"InterleaveYUY2() start");
+
+        using Vector = std::conditional_t<intrinsicType == 1, __m128i
+                     , std::conditional_t<intrinsicType == 2, __m256i
+                     , std::conditional_t<intrinsicType == 3, __m512i
+                     , std::array<BYTE, componentSize * 4>>>>;
+        constexpr int cycleSize = intrinsicType >= 1 && intrinsicType <= 3 ? static_cast<int>(sizeof(Vector)) * 2 : static_cast<int>(sizeof(Vector));
+
+        // the unpacking instruction is chosen by the vector type of the operands rather than intrinsicType, since AVX2 also unpacks U and V in 128-bit
+        [[maybe_unused]] const auto Unpack = []<typename V>(const V &a, const V &b, bool isHigh) -> V {
+            if constexpr (std::is_same_v<V, __m128i>) {
+                if constexpr (componentSize == 1) {
+                    return isHigh ? _mm_unpackhi_epi8(a, b) : _mm_unpacklo_epi8(a, b);
+                } else {
+                    return isHigh ? _mm_unpackhi_epi16(a, b) : _mm_unpacklo_epi16(a, b);
+                }
+            } else if constexpr (std::is_same_v<V, __m256i>) {
+                if constexpr (componentSize == 1) {
+                    return isHigh ? _mm256_unpackhi_epi8(a, b) : _mm256_unpacklo_epi8(a, b);
+                } else {
+                    return isHigh ? _mm256_unpackhi_epi16(a, b) : _mm256_unpacklo_epi16(a, b);
+                }
+            } else {
+                if constexpr (componentSize == 1) {
+                    return isHigh ? _mm512_unpackhi_epi8(a, b) : _mm512_unpacklo_epi8(a, b);
+                } else {
+                    return isHigh ? _mm512_unpackhi_epi16(a, b) : _mm512_unpacklo_epi16(a, b);
+                }
+            }
+        };
+
+        int cycles;
+        if constexpr (intrinsicType == 1 || intrinsicType == 2) {
+            cycles = rowSize / cycleSize;
+
+            const int vectorRowSize = cycles * cycleSize;
+            if (vectorRowSize < rowSize) {
+                InterleaveYUY2<0, componentSize, leftShiftSize>({ srcs[0] + vectorRowSize / 2, srcs[1] + vectorRowSize / 4, srcs[2] + vectorRowSize / 4 }, srcStrides, dst + vectorRowSize, dstStride, rowSize - vectorRowSize, height);
+            }
+        } else {
+            cycles = DivideRoundUp(rowSize, cycleSize);
+        }
+        const int lastCycleSize = rowSize - (cycles - 1) * cycleSize;
+        [[maybe_unused]] const uint64_t srcLastCycleMaskY = LowBitsMask(lastCycleSize / 2);
+        [[maybe_unused]] const uint64_t srcLastCycleMaskUV = LowBitsMask(lastCycleSize / 4);
+        [[maybe_unused]] const uint64_t dstLastCycleMask1 = LowBitsMask(std::min(lastCycleSize, 64));
+        [[maybe_unused]] const uint64_t dstLastCycleMask2 = LowBitsMask(std::max(lastCycleSize - 64, 0));
+
+        for (int y = 0; y < height; ++y) {
+            const BYTE *srcLineY = srcs[0];
+            const BYTE *srcLineU = srcs[1];
+            const BYTE *srcLineV = srcs[2];
             Vector *dstLine = reinterpret_cast<Vector *>(dst);
 
             for (int i = 0; i < cycles; ++i) {
                 if constexpr (intrinsicType == 1) {
-                    if constexpr (isRightShift) {
-                        *dstLine++ = _mm_srli_epi16(*srcLine++, shiftSize);
-                    } else {
-                        *dstLine++ = _mm_slli_epi16(*srcLine++, shiftSize);
+                    const __m128i yVec = LoadVector(reinterpret_cast<const __m128i *>(srcLineY));
+                    const __m128i uvVec = Unpack(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(srcLineU)), _mm_loadl_epi64(reinterpret_cast<const __m128i *>(srcLineV)), false);
+
+                    StoreVector(dstLine++, ShiftEach16BitInt<leftShiftSize, false>(Unpack(yVec, uvVec, false)), false);
+                    StoreVector(dstLine++, ShiftEach16BitInt<leftShiftSize, false>(Unpack(yVec, uvVec, true)), false);
+                } else if constexpr (intrinsicType == 2) {
+                    const __m256i yVec = LoadVector(reinterpret_cast<const __m256i *>(srcLineY));
+                    const __m128i uVec = LoadVector(reinterpret_cast<const __m128i *>(srcLineU));
+                    const __m128i vVec = LoadVector(reinterpret_cast<const __m128i *>(srcLineV));
+                    const __m256i uvVec = _mm256_inserti128_si256(_mm256_castsi128_si256(Unpack(uVec, vVec, false)), Unpack(uVec, vVec, true), 1);
+                    const __m256i lo = Unpack(yVec, uvVec, false);
+                    const __m256i hi = Unpack(yVec, uvVec, true);
+
+                    StoreVector(dstLine++, ShiftEach16BitInt<leftShiftSize, false>(_mm256_permute2x128_si256(lo, hi, 0x20)), false);
+                    StoreVector(dstLine++, ShiftEach16BitInt<leftShiftSize, false>(_mm256_permute2x128_si256(lo, hi, 0x31)), false);
+                } else if constexpr (intrinsicType == 3) {
+                    const bool isLastCycle = i == cycles - 1;
+                    const __mmask32 srcMaskUV = static_cast<__mmask32>(isLastCycle ? srcLastCycleMaskUV : ~0ULL);
+                    const __m512i yVec = _mm512_permutexvar_epi64(_INTERLEAVE_UV_PERMUTE_INDEX_M512, _mm512_maskz_loadu_epi8(isLastCycle ? srcLastCycleMaskY : ~0ULL, srcLineY));
+                    const __m512i uVec = _mm512_permutexvar_epi32(_YUY2_INTERLEAVE_UV_PERMUTE_INDEX_M512, _mm512_castsi256_si512(_mm256_maskz_loadu_epi8(srcMaskUV, srcLineU)));
+                    const __m512i vVec = _mm512_permutexvar_epi32(_YUY2_INTERLEAVE_UV_PERMUTE_INDEX_M512, _mm512_castsi256_si512(_mm256_maskz_loadu_epi8(srcMaskUV, srcLineV)));
+                    const __m512i uvVec = Unpack(uVec, vVec, false);
+
+                    _mm512_mask_storeu_epi8(dstLine++, isLastCycle ? dstLastCycleMask1 : ~0ULL, ShiftEach16BitInt<leftShiftSize, false>(Unpack(yVec, uvVec, false)));
+                    _mm512_mask_storeu_epi8(dstLine++, isLastCycle ? dstLastCycleMask2 : ~0ULL, ShiftEach16BitInt<leftShiftSize, false>(Unpack(yVec, uvVec, true)));
+                } else {
+                    Vector dstVec;
+                    memcpy(dstVec.data(), srcLineY, componentSize);
+                    memcpy(dstVec.data() + componentSize, srcLineU, componentSize);
+                    memcpy(dstVec.data() + componentSize * 2, srcLineY + componentSize, componentSize);
+                    memcpy(dstVec.data() + componentSize * 3, srcLineV, componentSize);
+                    *dstLine++ = ShiftEach16BitInt<leftShiftSize, false>(dstVec);
+                }
+
+                srcLineY += cycleSize / 2;
+                srcLineU += cycleSize / 4;
+                srcLineV += cycleSize / 4;
+            }
+
+            for (size_t p = 0; p < srcs.size(); ++p) {
+                srcs[p] += srcStrides[p];
+            }
+            dst += dstStride;
+        }
+
+        Environment::GetInstance().Log<LogLevel::Kernel>(L"InterleaveYUY2() end");
+    }
+
+    /*
+     * v210 packs 6 pixels in each block of four 32-bit integers, each holding three 10-bit components in U-Y-V-Y order
+     * rowSize of v210 is the number of bytes the components of the row take, from which the width is derived
+     * Because the blocks do not fill whole vectors of the planes, SSE and AVX2 write a few bytes past each block's pixels, which the next block overwrites.
+     * Therefore, they stop early enough to stay within the row, and leave the remaining pixels to the non-SIMD version after the main loop.
+     * intrinsicType: 1 = SSE4, 2 = AVX2, 3 = AVX-512. Anything else: non-SIMD
+     */
+    template <int intrinsicType>
+    static constexpr auto DeinterleaveV210(const BYTE *src, int srcStride, std::array<BYTE *, 3> dsts, const std::array<int, 3> &dstStrides, int rowSize, int height) -> void {
+        /*
+         * Split each 32-bit integer to the 16-bit integers of the first two components, and the third component alone, then shuffle (SSE and AVX2) or permute (AVX-512) the planes out of them.
+         * AVX2 shuffles the U and V of its upper 128-bit lane to follow the ones of the lower lane, so that the two lanes are merged by OR.
+         * AVX-512 masks the last cycle of each row.
+         */
+
+        Environment::GetInstance().Log<LogLevel::Kernel>(L"DeinterleaveV210() start");
+
+        const int width = rowSize * 3 / 8;
+        constexpr int cycleBlocks = intrinsicType == 1 ? 1 : intrinsicType == 2 ? 2 : intrinsicType == 3 ? 4 : 1;
+        constexpr int cyclePixels = cycleBlocks * 6;
+
+        int cycles;
+        if constexpr (intrinsicType == 1 || intrinsicType == 2) {
+            // the last cycle stores a whole vector of U and V, which is 4 (SSE) or 8 (AVX2) bytes more than its pixels take
+            const int overrunPixels = intrinsicType == 1 ? 8 : 16;
+            cycles = width >= overrunPixels ? (width - overrunPixels) / cyclePixels + 1 : 0;
+        } else {
+            cycles = DivideRoundUp(width, cyclePixels);
+        }
+        // the planes of each AVX-512 cycle take less than whole vectors, so every cycle is masked
+        const int lastCyclePixels = width - (cycles - 1) * cyclePixels;
+        [[maybe_unused]] const uint64_t srcLastCycleMask = LowBitsMask(rowSize - (cycles - 1) * cycleBlocks * 16);
+        [[maybe_unused]] const uint64_t dstCycleMaskY = LowBitsMask(cyclePixels * 2);
+        [[maybe_unused]] const uint64_t dstCycleMaskUV = LowBitsMask(cyclePixels);
+        [[maybe_unused]] const uint64_t dstLastCycleMaskY = LowBitsMask(lastCyclePixels * 2);
+        [[maybe_unused]] const uint64_t dstLastCycleMaskUV = LowBitsMask(lastCyclePixels);
+
+        [[maybe_unused]] std::array<std::array<__m256i, 2>, 3> shuffleMasksM256;
+        if constexpr (intrinsicType == 2) {
+            for (int p = 0; p < 3; ++p) {
+                for (int s = 0; s < 2; ++s) {
+                    shuffleMasksM256[p][s] = _mm256_inserti128_si256(_mm256_castsi128_si256(_V210_DEINTERLEAVE_SHUFFLE_MASKS[p][s][0]), _V210_DEINTERLEAVE_SHUFFLE_MASKS[p][s][p == 0 ? 0 : 1], 1);
+                }
+            }
+        }
+
+        for (int y = 0; y < height; ++y) {
+            const BYTE *srcLine = src;
+            BYTE *dstLineY = dsts[0];
+            BYTE *dstLineU = dsts[1];
+            BYTE *dstLineV = dsts[2];
+
+            for (int i = 0; i < cycles; ++i) {
+                if constexpr (intrinsicType == 1) {
+                    const __m128i srcVec = LoadVector(reinterpret_cast<const __m128i *>(srcLine));
+                    const __m128i firstTwoVec = _mm_or_si128(_mm_and_si128(srcVec, _mm_set1_epi32(0x3FF)), _mm_and_si128(_mm_slli_epi32(srcVec, 6), _mm_set1_epi32(0x3FF0000)));
+                    const __m128i thirdVec = _mm_and_si128(_mm_srli_epi32(srcVec, 20), _mm_set1_epi32(0x3FF));
+
+                    std::array<__m128i, 3> dataVecs;
+                    for (int p = 0; p < 3; ++p) {
+                        dataVecs[p] = _mm_or_si128(_mm_shuffle_epi8(firstTwoVec, _V210_DEINTERLEAVE_SHUFFLE_MASKS[p][0][0]), _mm_shuffle_epi8(thirdVec, _V210_DEINTERLEAVE_SHUFFLE_MASKS[p][1][0]));
                     }
+
+                    StoreVector(reinterpret_cast<__m128i *>(dstLineY), dataVecs[0], false);
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(dstLineU), dataVecs[1]);
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(dstLineV), dataVecs[2]);
                 } else if constexpr (intrinsicType == 2) {
-                    if constexpr (isRightShift) {
-                        *dstLine++ = _mm256_srli_epi16(*srcLine++, shiftSize);
-                    } else {
-                        *dstLine++ = _mm256_slli_epi16(*srcLine++, shiftSize);
+                    const __m256i srcVec = LoadVector(reinterpret_cast<const __m256i *>(srcLine));
+                    const __m256i firstTwoVec = _mm256_or_si256(_mm256_and_si256(srcVec, _mm256_set1_epi32(0x3FF)), _mm256_and_si256(_mm256_slli_epi32(srcVec, 6), _mm256_set1_epi32(0x3FF0000)));
+                    const __m256i thirdVec = _mm256_and_si256(_mm256_srli_epi32(srcVec, 20), _mm256_set1_epi32(0x3FF));
+
+                    std::array<__m256i, 3> dataVecs;
+                    for (int p = 0; p < 3; ++p) {
+                        dataVecs[p] = _mm256_or_si256(_mm256_shuffle_epi8(firstTwoVec, shuffleMasksM256[p][0]), _mm256_shuffle_epi8(thirdVec, shuffleMasksM256[p][1]));
                     }
+
+                    // 12 bytes of Y in each 128-bit lane
+                    StoreVector(reinterpret_cast<__m256i *>(dstLineY), _mm256_permutevar8x32_epi32(dataVecs[0], _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7)), false);
+                    StoreVector(reinterpret_cast<__m128i *>(dstLineU), _mm_or_si128(_mm256_castsi256_si128(dataVecs[1]), _mm256_extracti128_si256(dataVecs[1], 1)), false);
+                    StoreVector(reinterpret_cast<__m128i *>(dstLineV), _mm_or_si128(_mm256_castsi256_si128(dataVecs[2]), _mm256_extracti128_si256(dataVecs[2], 1)), false);
+                } else if constexpr (intrinsicType == 3) {
+                    const bool isLastCycle = i == cycles - 1;
+                    const __m512i srcVec = _mm512_maskz_loadu_epi8(isLastCycle ? srcLastCycleMask : ~0ULL, srcLine);
+                    const __m512i firstTwoVec = _mm512_or_si512(_mm512_and_si512(srcVec, _mm512_set1_epi32(0x3FF)), _mm512_and_si512(_mm512_slli_epi32(srcVec, 6), _mm512_set1_epi32(0x3FF0000)));
+                    const __m512i thirdVec = _mm512_and_si512(_mm512_srli_epi32(srcVec, 20), _mm512_set1_epi32(0x3FF));
+                    const uint64_t dstMaskUV = isLastCycle ? dstLastCycleMaskUV : dstCycleMaskUV;
+
+                    _mm512_mask_storeu_epi8(dstLineY, isLastCycle ? dstLastCycleMaskY : dstCycleMaskY, _mm512_permutex2var_epi16(firstTwoVec, _V210_DEINTERLEAVE_PERMUTE_INDICES_M512[0], thirdVec));
+                    _mm512_mask_storeu_epi8(dstLineU, dstMaskUV, _mm512_permutex2var_epi16(firstTwoVec, _V210_DEINTERLEAVE_PERMUTE_INDICES_M512[1], thirdVec));
+                    _mm512_mask_storeu_epi8(dstLineV, dstMaskUV, _mm512_permutex2var_epi16(firstTwoVec, _V210_DEINTERLEAVE_PERMUTE_INDICES_M512[2], thirdVec));
                 } else {
-                    if constexpr (isRightShift) {
-                        *dstLine++ = *srcLine++ >> shiftSize;
-                    } else {
-                        *dstLine++ = *srcLine++ << shiftSize;
+                    // the last block of the row may be partial
+                    const int blockPixels = std::min(width - i * cyclePixels, cyclePixels);
+
+                    std::array<uint32_t, 4> block {};
+                    memcpy(block.data(), srcLine, std::min(rowSize - i * 16, 16));
+
+                    std::array<uint16_t, 12> components;
+                    for (int c = 0; c < static_cast<int>(components.size()); ++c) {
+                        components[c] = static_cast<uint16_t>(block[c / 3] >> (c % 3 * 10) & 0x3FF);
+                    }
+
+                    for (int x = 0; x < blockPixels; ++x) {
+                        memcpy(dstLineY + x * 2, &components[x * 2 + 1], 2);
+                    }
+                    for (int x = 0; x < blockPixels / 2; ++x) {
+                        memcpy(dstLineU + x * 2, &components[x * 4], 2);
+                        memcpy(dstLineV + x * 2, &components[x * 4 + 2], 2);
                     }
                 }
+
+                srcLine += cycleBlocks * 16;
+                dstLineY += cyclePixels * 2;
+                dstLineU += cyclePixels;
+                dstLineV += cyclePixels;
             }
 
-            src += stride;
-            dst += stride;
+            src += srcStride;
+            for (int p = 0; p < 3; ++p) {
+                dsts[p] += dstStrides[p];
+            }
         }
 
-        Environment::GetInstance().Log(L"BitShiftEach16BitInt(%d) end", isRightShift);
+        if constexpr (intrinsicType == 1 || intrinsicType == 2) {
+            const int vectorRowPixels = cycles * cyclePixels;
+            if (vectorRowPixels < width) {
+                DeinterleaveV210<0>(src - static_cast<ptrdiff_t>(srcStride) * height + vectorRowPixels / 6 * 16, srcStride,
+                                    { dsts[0] - static_cast<ptrdiff_t>(dstStrides[0]) * height + vectorRowPixels * 2,
+                                      dsts[1] - static_cast<ptrdiff_t>(dstStrides[1]) * height + vectorRowPixels,
+                                      dsts[2] - static_cast<ptrdiff_t>(dstStrides[2]) * height + vectorRowPixels },
+                                    dstStrides, rowSize - vectorRowPixels / 6 * 16, height);
+            }
+        }
+
+        Environment::GetInstance().Log<LogLevel::Kernel>(L"DeinterleaveV210() end");
     }
 
-    static auto DeinterleaveY410(const BYTE *src, int srcStride, std::array<BYTE *, 3> dsts, const std::array<int, 3> &dstStrides, int rowSize, int height) -> void;
-    static auto InterleaveY410(std::array<const BYTE *, 3> srcs, const std::array<int, 3> &srcStrides, BYTE *dst, int dstStride, int rowSize, int height) -> void;
+    template <int intrinsicType>
+    static constexpr auto InterleaveV210(std::array<const BYTE *, 3> srcs, const std::array<int, 3> &srcStrides, BYTE *dst, int dstStride, int rowSize, int height) -> void {
+        // the reverse of DeinterleaveV210(): shuffle (SSE and AVX2) or permute (AVX-512) the planes to the first two and the third components of each 32-bit integer, then shift them into place
+        // AVX2 spreads the 6 pixels of each block to its own 128-bit lane before shuffling
+        // SSE and AVX2 read a few bytes past each block's pixels from the planes, and stop early enough to stay within the row like DeinterleaveV210()
+
+        Environment::GetInstance().Log<LogLevel::Kernel>(L"InterleaveV210() start");
+
+        const int width = rowSize * 3 / 8;
+        constexpr int cycleBlocks = intrinsicType == 1 ? 1 : intrinsicType == 2 ? 2 : intrinsicType == 3 ? 4 : 1;
+        constexpr int cyclePixels = cycleBlocks * 6;
+
+        int cycles;
+        if constexpr (intrinsicType == 1 || intrinsicType == 2) {
+            const int overrunPixels = intrinsicType == 1 ? 8 : 16;
+            cycles = width >= overrunPixels ? (width - overrunPixels) / cyclePixels + 1 : 0;
+
+            const int vectorRowPixels = cycles * cyclePixels;
+            if (vectorRowPixels < width) {
+                InterleaveV210<0>({ srcs[0] + vectorRowPixels * 2, srcs[1] + vectorRowPixels, srcs[2] + vectorRowPixels }, srcStrides, dst + vectorRowPixels / 6 * 16, dstStride, rowSize - vectorRowPixels / 6 * 16, height);
+            }
+        } else {
+            cycles = DivideRoundUp(width, cyclePixels);
+        }
+        const int lastCyclePixels = width - (cycles - 1) * cyclePixels;
+        [[maybe_unused]] const uint64_t srcCycleMaskY = LowBitsMask(cyclePixels * 2);
+        [[maybe_unused]] const uint64_t srcCycleMaskUV = LowBitsMask(cyclePixels);
+        [[maybe_unused]] const uint64_t srcLastCycleMaskY = LowBitsMask(lastCyclePixels * 2);
+        [[maybe_unused]] const uint64_t srcLastCycleMaskUV = LowBitsMask(lastCyclePixels);
+        [[maybe_unused]] const uint64_t dstLastCycleMask = LowBitsMask(rowSize - (cycles - 1) * cycleBlocks * 16);
+
+        [[maybe_unused]] std::array<std::array<__m256i, 3>, 2> shuffleMasksM256;
+        if constexpr (intrinsicType == 2) {
+            for (int d = 0; d < 2; ++d) {
+                for (int p = 0; p < 3; ++p) {
+                    shuffleMasksM256[d][p] = _mm256_inserti128_si256(_mm256_castsi128_si256(_V210_INTERLEAVE_SHUFFLE_MASKS[d][p][0]), _V210_INTERLEAVE_SHUFFLE_MASKS[d][p][p == 0 ? 0 : 1], 1);
+                }
+            }
+        }
+
+        for (int y = 0; y < height; ++y) {
+            const BYTE *srcLineY = srcs[0];
+            const BYTE *srcLineU = srcs[1];
+            const BYTE *srcLineV = srcs[2];
+            BYTE *dstLine = dst;
+
+            for (int i = 0; i < cycles; ++i) {
+                if constexpr (intrinsicType == 1) {
+                    const std::array srcVecs {
+                        LoadVector(reinterpret_cast<const __m128i *>(srcLineY)),
+                        _mm_loadl_epi64(reinterpret_cast<const __m128i *>(srcLineU)),
+                        _mm_loadl_epi64(reinterpret_cast<const __m128i *>(srcLineV)),
+                    };
+
+                    std::array<__m128i, 2> dataVecs;
+                    for (int d = 0; d < 2; ++d) {
+                        dataVecs[d] = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(srcVecs[0], _V210_INTERLEAVE_SHUFFLE_MASKS[d][0][0]),
+                                                                _mm_shuffle_epi8(srcVecs[1], _V210_INTERLEAVE_SHUFFLE_MASKS[d][1][0])),
+                                                   _mm_shuffle_epi8(srcVecs[2], _V210_INTERLEAVE_SHUFFLE_MASKS[d][2][0]));
+                    }
+
+                    const __m128i dstVec = _mm_or_si128(_mm_or_si128(_mm_and_si128(dataVecs[0], _mm_set1_epi32(0x3FF)), _mm_and_si128(_mm_srli_epi32(dataVecs[0], 6), _mm_set1_epi32(0xFFC00))), _mm_slli_epi32(_mm_and_si128(dataVecs[1], _mm_set1_epi32(0x3FF)), 20));
+                    StoreVector(reinterpret_cast<__m128i *>(dstLine), dstVec, false);
+                } else if constexpr (intrinsicType == 2) {
+                    const __m128i uVec = LoadVector(reinterpret_cast<const __m128i *>(srcLineU));
+                    const __m128i vVec = LoadVector(reinterpret_cast<const __m128i *>(srcLineV));
+                    const std::array srcVecs {
+                        _mm256_permutevar8x32_epi32(LoadVector(reinterpret_cast<const __m256i *>(srcLineY)), _mm256_setr_epi32(0, 1, 2, 2, 3, 4, 5, 5)),
+                        _mm256_broadcastsi128_si256(uVec),
+                        _mm256_broadcastsi128_si256(vVec),
+                    };
+
+                    std::array<__m256i, 2> dataVecs;
+                    for (int d = 0; d < 2; ++d) {
+                        dataVecs[d] = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(srcVecs[0], shuffleMasksM256[d][0]),
+                                                                      _mm256_shuffle_epi8(srcVecs[1], shuffleMasksM256[d][1])),
+                                                      _mm256_shuffle_epi8(srcVecs[2], shuffleMasksM256[d][2]));
+                    }
+
+                    const __m256i dstVec = _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(dataVecs[0], _mm256_set1_epi32(0x3FF)), _mm256_and_si256(_mm256_srli_epi32(dataVecs[0], 6), _mm256_set1_epi32(0xFFC00))), _mm256_slli_epi32(_mm256_and_si256(dataVecs[1], _mm256_set1_epi32(0x3FF)), 20));
+                    StoreVector(reinterpret_cast<__m256i *>(dstLine), dstVec, false);
+                } else if constexpr (intrinsicType == 3) {
+                    const bool isLastCycle = i == cycles - 1;
+                    const __mmask32 srcMaskUV = static_cast<__mmask32>(isLastCycle ? srcLastCycleMaskUV : srcCycleMaskUV);
+                    const __m512i yVec = _mm512_maskz_loadu_epi8(isLastCycle ? srcLastCycleMaskY : srcCycleMaskY, srcLineY);
+                    const __m512i uvVec = _mm512_inserti64x4(_mm512_castsi256_si512(_mm256_maskz_loadu_epi8(srcMaskUV, srcLineU)), _mm256_maskz_loadu_epi8(srcMaskUV, srcLineV), 1);
+                    const __m512i firstTwoVec = _mm512_permutex2var_epi16(yVec, _V210_INTERLEAVE_PERMUTE_INDICES_M512[0], uvVec);
+                    const __m512i thirdVec = _mm512_permutex2var_epi16(yVec, _V210_INTERLEAVE_PERMUTE_INDICES_M512[1], uvVec);
+
+                    const __m512i dstVec = _mm512_or_si512(_mm512_or_si512(_mm512_and_si512(firstTwoVec, _mm512_set1_epi32(0x3FF)), _mm512_and_si512(_mm512_srli_epi32(firstTwoVec, 6), _mm512_set1_epi32(0xFFC00))), _mm512_slli_epi32(_mm512_and_si512(thirdVec, _mm512_set1_epi32(0x3FF)), 20));
+                    _mm512_mask_storeu_epi8(dstLine, isLastCycle ? dstLastCycleMask : ~0ULL, dstVec);
+                } else {
+                    // the last block of the row may be partial, whose missing components are written as 0
+                    const int blockPixels = std::min(width - i * cyclePixels, cyclePixels);
+
+                    std::array<uint16_t, 12> components {};
+                    for (int x = 0; x < blockPixels; ++x) {
+                        memcpy(&components[x * 2 + 1], srcLineY + x * 2, 2);
+                    }
+                    for (int x = 0; x < blockPixels / 2; ++x) {
+                        memcpy(&components[x * 4], srcLineU + x * 2, 2);
+                        memcpy(&components[x * 4 + 2], srcLineV + x * 2, 2);
+                    }
+
+                    std::array<uint32_t, 4> block {};
+                    for (int c = 0; c < static_cast<int>(components.size()); ++c) {
+                        block[c / 3] |= static_cast<uint32_t>(components[c] & 0x3FF) << (c % 3 * 10);
+                    }
+                    memcpy(dstLine, block.data(), std::min(rowSize - i * 16, 16));
+                }
+
+                srcLineY += cyclePixels * 2;
+                srcLineU += cyclePixels;
+                srcLineV += cyclePixels;
+                dstLine += cycleBlocks * 16;
+            }
+
+            for (size_t p = 0; p < srcs.size(); ++p) {
+                srcs[p] += srcStrides[p];
+            }
+            dst += dstStride;
+        }
+
+        Environment::GetInstance().Log<LogLevel::Kernel>(L"InterleaveV210() end");
+    }
 
     static inline decltype(Deinterleave<0, 1, 2, 2, 1>) *_deinterleaveUVC1Func;
     static inline decltype(Deinterleave<0, 2, 2, 2, 1>) *_deinterleaveUVC2Func;
+    static inline decltype(Deinterleave<0, 2, 2, 2, 1, 6>) *_deinterleaveUVC2RightShiftFunc;
     static inline decltype(Deinterleave<0, 2, 4, 3, 1>) *_deinterleaveY416Func;
     static inline decltype(Deinterleave<0, 1, 4, 3, 2>) *_deinterleaveRGBC1Func;
     static inline decltype(InterleaveUV<0, 1>) *_interleaveUVC1Func;
     static inline decltype(InterleaveUV<0, 2>) *_interleaveUVC2Func;
-    static inline decltype(InterleaveThree<1>) *_interleaveY416Func;
-    static inline decltype(InterleaveThree<2>) *_interleaveRGBC1Func;
+    static inline decltype(InterleaveUV<0, 2, 6, true>) *_interleaveUVC2LeftShiftFunc;
+    static inline decltype(InterleaveThree<0, 1>) *_interleaveY416Func;
+    static inline decltype(InterleaveThree<0, 2>) *_interleaveRGBC1Func;
+    static inline decltype(DeinterleaveY410<0>) *_deinterleaveY410Func;
+    static inline decltype(InterleaveY410<0>) *_interleaveY410Func;
+    static inline decltype(DeinterleaveRGB<0, 1>) *_deinterleaveRGB24Func;
+    static inline decltype(DeinterleaveRGB<0, 2>) *_deinterleaveRGB48Func;
+    static inline decltype(InterleaveRGB<0, 1>) *_interleaveRGB24Func;
+    static inline decltype(InterleaveRGB<0, 2>) *_interleaveRGB48Func;
+    static inline decltype(DeinterleaveYUY2<0, 1, 0>) *_deinterleaveYUY2Func;
+    static inline decltype(DeinterleaveYUY2<0, 2, 6>) *_deinterleaveY210Func;
+    static inline decltype(DeinterleaveYUY2<0, 2, 0>) *_deinterleaveY216Func;
+    static inline decltype(InterleaveYUY2<0, 1, 0>) *_interleaveYUY2Func;
+    static inline decltype(InterleaveYUY2<0, 2, 6>) *_interleaveY210Func;
+    static inline decltype(InterleaveYUY2<0, 2, 0>) *_interleaveY216Func;
+    static inline decltype(DeinterleaveV210<0>) *_deinterleaveV210Func;
+    static inline decltype(InterleaveV210<0>) *_interleaveV210Func;
     static inline decltype(BitShiftEach16BitInt<0, 6, true>) *_rightShiftFunc;
     static inline decltype(BitShiftEach16BitInt<0, 6, false>) *_leftShiftFunc;
+    static inline decltype(CopyPlaneStreaming<1>) *_copyPlaneStreamingFunc;
 
     static inline int _vectorSize;
 };
@@ -1,8 +1,10 @@
 // License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
 
+#include "constants.h"
 #include "environment.h"
 #include "format.h"
 #include "macros.h"
+#include "thread_pool.h"
 
 
 namespace SynthFilter {
@@ -75,49 +77,283 @@ auto Format::VideoFormat::GetCodecFourCC() const -> DWORD {
 }
 
 auto Format::Initialize() -> void {
-    if (Environment::GetInstance().IsSupportAVX2()) {
+    // component c of pixel j sits at byte 3 * j + c of RGB24 and 6 * j + 2 * c of RGB48, which span three 128-bit vectors every 48 bytes
+    for (int componentSize = 1; componentSize <= 2; ++componentSize) {
+        const int pixelSize = componentSize * 3;
+
+        for (int v = 0; v < 3; ++v) {
+            for (int c = 0; c < 3; ++c) {
+                std::array<char, sizeof(__m128i)> deinterleaveMask;
+                std::array<char, sizeof(__m128i)> interleaveMask;
+                for (int b = 0; b < static_cast<int>(sizeof(__m128i)); ++b) {
+                    const int srcByte = pixelSize * (b / componentSize) + componentSize * c + b % componentSize;
+                    deinterleaveMask[b] = static_cast<char>(srcByte / 16 == v ? srcByte % 16 : 0x80);
+
+                    const int dstByte = 16 * v + b;
+                    interleaveMask[b] = static_cast<char>(dstByte % pixelSize / componentSize == c ? dstByte / pixelSize * componentSize + dstByte % componentSize : 0x80);
+                }
+
+                (componentSize == 1 ? _RGB24_DEINTERLEAVE_SHUFFLE_MASKS : _RGB48_DEINTERLEAVE_SHUFFLE_MASKS)[v][c] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(deinterleaveMask.data()));
+                (componentSize == 1 ? _RGB24_INTERLEAVE_SHUFFLE_MASKS : _RGB48_INTERLEAVE_SHUFFLE_MASKS)[v][c] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(interleaveMask.data()));
+            }
+        }
+    }
+
+    /*
+     * Component n of each v210 block is Y of pixel (n - 1) / 2 if n is odd, otherwise U (n % 4 == 0) or V (n % 4 == 2) of pixel n / 2.
+     * After splitting, components 3k and 3k+1 sit at the 16-bit integers 2k and 2k+1 of the first two components, and component 3k+2 at the 16-bit integer 2k of the third.
+     * The second block of AVX2 has U and V 3 16-bit integers further in the planes, while its Y is permuted to the start of the upper 128-bit lane.
+     */
+    constexpr auto V210ComponentOfPlane = [](int plane, int index) -> int {
+        return plane == 0 ? index * 2 + 1 : index * 4 + (plane - 1) * 2;
+    };
+    constexpr auto V210PlaneOfComponent = [](int component) -> std::pair<int, int> {
+        return component % 2 == 1 ? std::make_pair(0, (component - 1) / 2) : std::make_pair(component % 4 / 2 + 1, component / 4);
+    };
+
+    for (int p = 0; p < 3; ++p) {
+        const int planePixels = p == 0 ? 6 : 3;
+
+        for (int b = 0; b < 2; ++b) {
+            std::array<std::array<char, sizeof(__m128i)>, 2> deinterleaveMasks;
+            deinterleaveMasks[0].fill(static_cast<char>(0x80));
+            deinterleaveMasks[1].fill(static_cast<char>(0x80));
+
+            for (int w = 0; w < 8; ++w) {
+                const int index = p == 0 ? w : w - 3 * b;
+                if (index < 0 || index >= planePixels) {
+                    continue;
+                }
+
+                const int component = V210ComponentOfPlane(p, index);
+                const int src = component % 3 == 2 ? 1 : 0;
+                const int srcWord = component / 3 * 2 + (src == 0 ? component % 3 : 0);
+                deinterleaveMasks[src][w * 2] = static_cast<char>(srcWord * 2);
+                deinterleaveMasks[src][w * 2 + 1] = static_cast<char>(srcWord * 2 + 1);
+            }
+
+            for (int src = 0; src < 2; ++src) {
+                _V210_DEINTERLEAVE_SHUFFLE_MASKS[p][src][b] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(deinterleaveMasks[src].data()));
+            }
+        }
+    }
+
+    for (int d = 0; d < 2; ++d) {
+        for (int b = 0; b < 2; ++b) {
+            std::array<std::array<char, sizeof(__m128i)>, 3> interleaveMasks;
+            for (std::array<char, sizeof(__m128i)> &mask : interleaveMasks) {
+                mask.fill(static_cast<char>(0x80));
+            }
+
+            for (int w = 0; w < 8; ++w) {
+                if (d == 1 && w % 2 == 1) {
+                    continue;
+                }
+
+                const int component = w / 2 * 3 + (d == 0 ? w % 2 : 2);
+                const auto [plane, index] = V210PlaneOfComponent(component);
+                const int srcWord = plane == 0 ? index : index + 3 * b;
+                interleaveMasks[plane][w * 2] = static_cast<char>(srcWord * 2);
+                interleaveMasks[plane][w * 2 + 1] = static_cast<char>(srcWord * 2 + 1);
+            }
+
+            for (int p = 0; p < 3; ++p) {
+                _V210_INTERLEAVE_SHUFFLE_MASKS[d][p][b] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(interleaveMasks[p].data()));
+            }
+        }
+    }
+
+    if (Environment::GetInstance().IsSupportAVX512()) {
+        _UV_SHUFFLE_MASK_M512_C1            = _mm512_broadcast_i32x4(_UV_SHUFFLE_MASK_M128_C1);
+        _UV_SHUFFLE_MASK_M512_C2            = _mm512_broadcast_i32x4(_UV_SHUFFLE_MASK_M128_C2);
+        _Y416_SHUFFLE_MASK_M512             = _mm512_broadcast_i32x4(_Y416_SHUFFLE_MASK_M128);
+        _RGB_SHUFFLE_MASK_M512_C1           = _mm512_broadcast_i32x4(_RGB_SHUFFLE_MASK_M128_C1);
+        _DEINTERLEAVE_UV_PERMUTE_INDEX_M512 = _mm512_setr_epi64(0, 2, 4, 6, 1, 3, 5, 7);
+        _INTERLEAVE_UV_PERMUTE_INDEX_M512   = _mm512_setr_epi64(0, 4, 1, 5, 2, 6, 3, 7);
+        _FOUR_PERMUTE_INDEX_M512            = _mm512_setr_epi32(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+
+        _YUY2_DEINTERLEAVE_UV_PERMUTE_INDEX_M512 = _mm512_setr_epi32(0, 4, 8, 12, 2, 6, 10, 14, 1, 5, 9, 13, 3, 7, 11, 15);
+        _YUY2_INTERLEAVE_UV_PERMUTE_INDEX_M512   = _mm512_setr_epi32(0, 4, 0, 0, 1, 5, 0, 0, 2, 6, 0, 0, 3, 7, 0, 0);
+
+        // the 64-bit permutes pick from two vectors, so regrouping the 128-bit lanes of three vectors takes two of them
+        for (int v = 0; v < 3; ++v) {
+            std::array<std::array<uint64_t, 8>, 2> deinterleaveIndices;
+            std::array<std::array<uint64_t, 8>, 2> interleaveIndices;
+            for (int w = 0; w < 8; ++w) {
+                const int lane = w / 2;
+
+                // lane 3 * k + v of the loaded vectors to lane k, first from the first two vectors, then the rest from the third
+                const int srcLane = 3 * lane + v;
+                deinterleaveIndices[0][w] = srcLane < 8 ? srcLane * 2 + w % 2 : 0;
+                deinterleaveIndices[1][w] = srcLane < 8 ? w : srcLane * 2 - 8 + w % 2;
+
+                // lane 4 * v + k of the output from lane n / 3 of the shuffled vector n % 3
+                const int dstLane = 4 * v + lane;
+                const int shuffledVector = dstLane % 3;
+                const int shuffledWord = dstLane / 3 * 2 + w % 2;
+                interleaveIndices[0][w] = shuffledVector < 2 ? shuffledVector * 8 + shuffledWord : 0;
+                interleaveIndices[1][w] = shuffledVector < 2 ? w : 8 + shuffledWord;
+            }
+
+            for (int p = 0; p < 2; ++p) {
+                _RGB_DEINTERLEAVE_PERMUTE_INDICES_M512[v][p] = _mm512_loadu_si512(deinterleaveIndices[p].data());
+                _RGB_INTERLEAVE_PERMUTE_INDICES_M512[v][p] = _mm512_loadu_si512(interleaveIndices[p].data());
+            }
+        }
+
+        // each 128-bit lane holds one v210 block, whose split components are picked as the SSE masks do, from the first two components below 32 and the third above
+        for (int p = 0; p < 3; ++p) {
+            const int planePixels = p == 0 ? 6 : 3;
+
+            std::array<uint16_t, 32> deinterleaveIndices {};
+            for (int w = 0; w < planePixels * 4; ++w) {
+                const int block = w / planePixels;
+                const int component = V210ComponentOfPlane(p, w % planePixels);
+                deinterleaveIndices[w] = static_cast<uint16_t>(block * 8 + component / 3 * 2 + (component % 3 == 2 ? 32 : component % 3));
+            }
+
+            _V210_DEINTERLEAVE_PERMUTE_INDICES_M512[p] = _mm512_loadu_si512(deinterleaveIndices.data());
+        }
+
+        for (int d = 0; d < 2; ++d) {
+            std::array<uint16_t, 32> interleaveIndices {};
+            for (int w = 0; w < 32; ++w) {
+                if (d == 1 && w % 2 == 1) {
+                    continue;
+                }
+
+                const int block = w / 8;
+                const int component = w % 8 / 2 * 3 + (d == 0 ? w % 2 : 2);
+                const auto [plane, index] = V210PlaneOfComponent(component);
+                interleaveIndices[w] = static_cast<uint16_t>(plane == 0 ? block * 6 + index : 32 + (plane - 1) * 16 + block * 3 + index);
+            }
+
+            _V210_INTERLEAVE_PERMUTE_INDICES_M512[d] = _mm512_loadu_si512(interleaveIndices.data());
+        }
+
+
+        _deinterleaveUVC1Func           = Deinterleave<3, 1, 2, 2, 1>;
+        _deinterleaveUVC2Func           = Deinterleave<3, 2, 2, 2, 1>;
+        _deinterleaveUVC2RightShiftFunc = Deinterleave<3, 2, 2, 2, 1, 6>;
+        _deinterleaveY416Func           = Deinterleave<3, 2, 4, 3, 1>;
+        _deinterleaveRGBC1Func          = Deinterleave<3, 1, 4, 3, 2>;
+        _interleaveUVC1Func             = InterleaveUV<3, 1>;
+        _interleaveUVC2Func             = InterleaveUV<3, 2>;
+        _interleaveUVC2LeftShiftFunc    = InterleaveUV<3, 2, 6, true>;
+        _rightShiftFunc                 = BitShiftEach16BitInt<3, 6, true>;
+        _leftShiftFunc                  = BitShiftEach16BitInt<3, 6, false, true>;
+        _interleaveY416Func             = InterleaveThree<3, 1>;
+        _interleaveRGBC1Func            = InterleaveThree<3, 2>;
+        _deinterleaveY410Func           = DeinterleaveY410<3>;
+        _interleaveY410Func             = InterleaveY410<3>;
+        _deinterleaveRGB24Func          = DeinterleaveRGB<3, 1>;
+        _deinterleaveRGB48Func          = DeinterleaveRGB<3, 2>;
+        _interleaveRGB24Func            = InterleaveRGB<3, 1>;
+        _interleaveRGB48Func            = InterleaveRGB<3, 2>;
+        _deinterleaveYUY2Func           = DeinterleaveYUY2<3, 1, 0>;
+        _deinterleaveY210Func           = DeinterleaveYUY2<3, 2, 6>;
+        _deinterleaveY216Func           = DeinterleaveYUY2<3, 2, 0>;
+        _interleaveYUY2Func             = InterleaveYUY2<3, 1, 0>;
+        _interleaveY210Func             = InterleaveYUY2<3, 2, 6>;
+        _interleaveY216Func             = InterleaveYUY2<3, 2, 0>;
+        _deinterleaveV210Func           = DeinterleaveV210<3>;
+        _interleaveV210Func             = InterleaveV210<3>;
+        _copyPlaneStreamingFunc         = CopyPlaneStreaming<3>;
+        _vectorSize                     = sizeof(__m512i);
+    } else if (Environment::GetInstance().IsSupportAVX2()) {
         _UV_SHUFFLE_MASK_M256_C1  = _mm256_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15, 0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
         _UV_SHUFFLE_MASK_M256_C2  = _mm256_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15, 0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
         _Y416_SHUFFLE_MASK_M256   = _mm256_setr_epi8(0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15, 0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15);
         _RGB_SHUFFLE_MASK_M256_C1 = _mm256_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15, 0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
         _FOUR_PERMUTE_INDEX       = _mm256_setr_epi8(0, 0, 0, 0, 4, 0, 0, 0, 1, 0, 0, 0, 5, 0, 0, 0, 2, 0, 0, 0, 6, 0, 0, 0, 3, 0, 0, 0, 7, 0, 0, 0);
 
-        _deinterleaveUVC1Func  = Deinterleave<2, 1, 2, 2, 1>;
-        _deinterleaveUVC2Func  = Deinterleave<2, 2, 2, 2, 1>;
-        _deinterleaveY416Func  = Deinterleave<2, 2, 4, 3, 1>;
-        _deinterleaveRGBC1Func = Deinterleave<2, 1, 4, 3, 2>;
-        _interleaveUVC1Func    = InterleaveUV<2, 1>;
-        _interleaveUVC2Func    = InterleaveUV<2, 2>;
-        _rightShiftFunc        = BitShiftEach16BitInt<2, 6, true>;
-        _leftShiftFunc         = BitShiftEach16BitInt<2, 6, false>;
-        _vectorSize            = sizeof(__m256i);
+        _deinterleaveUVC1Func           = Deinterleave<2, 1, 2, 2, 1>;
+        _deinterleaveUVC2Func           = Deinterleave<2, 2, 2, 2, 1>;
+        _deinterleaveUVC2RightShiftFunc = Deinterleave<2, 2, 2, 2, 1, 6>;
+        _deinterleaveY416Func           = Deinterleave<2, 2, 4, 3, 1>;
+        _deinterleaveRGBC1Func          = Deinterleave<2, 1, 4, 3, 2>;
+        _interleaveUVC1Func             = InterleaveUV<2, 1>;
+        _interleaveUVC2Func             = InterleaveUV<2, 2>;
+        _interleaveUVC2LeftShiftFunc    = InterleaveUV<2, 2, 6, true>;
+        _rightShiftFunc                 = BitShiftEach16BitInt<2, 6, true>;
+        _leftShiftFunc                  = BitShiftEach16BitInt<2, 6, false, true>;
+        _interleaveY416Func             = InterleaveThree<2, 1>;
+        _interleaveRGBC1Func            = InterleaveThree<2, 2>;
+        _deinterleaveY410Func           = DeinterleaveY410<2>;
+        _interleaveY410Func             = InterleaveY410<2>;
+        _deinterleaveRGB24Func          = DeinterleaveRGB<2, 1>;
+        _deinterleaveRGB48Func          = DeinterleaveRGB<2, 2>;
+        _interleaveRGB24Func            = InterleaveRGB<2, 1>;
+        _interleaveRGB48Func            = InterleaveRGB<2, 2>;
+        _deinterleaveYUY2Func           = DeinterleaveYUY2<2, 1, 0>;
+        _deinterleaveY210Func           = DeinterleaveYUY2<2, 2, 6>;
+        _deinterleaveY216Func           = DeinterleaveYUY2<2, 2, 0>;
+        _interleaveYUY2Func             = InterleaveYUY2<2, 1, 0>;
+        _interleaveY210Func             = InterleaveYUY2<2, 2, 6>;
+        _interleaveY216Func             = InterleaveYUY2<2, 2, 0>;
+        _deinterleaveV210Func           = DeinterleaveV210<2>;
+        _interleaveV210Func             = InterleaveV210<2>;
+        _copyPlaneStreamingFunc         = CopyPlaneStreaming<2>;
+        _vectorSize                     = sizeof(__m256i);
     } else if (Environment::GetInstance().IsSupportSSE4()) {
-        _deinterleaveUVC1Func  = Deinterleave<1, 1, 2, 2, 1>;
-        _deinterleaveUVC2Func  = Deinterleave<1, 2, 2, 2, 1>;
-        _deinterleaveY416Func  = Deinterleave<1, 2, 4, 3, 1>;
-        _deinterleaveRGBC1Func = Deinterleave<1, 1, 4, 3, 2>;
-        _interleaveUVC1Func    = InterleaveUV<1, 1>;
-        _interleaveUVC2Func    = InterleaveUV<1, 2>;
-        _rightShiftFunc        = BitShiftEach16BitInt<1, 6, true>;
-        _leftShiftFunc         = BitShiftEach16BitInt<1, 6, false>;
-        _vectorSize            = sizeof(__m128i);
+        _deinterleaveUVC1Func           = Deinterleave<1, 1, 2, 2, 1>;
+        _deinterleaveUVC2Func           = Deinterleave<1, 2, 2, 2, 1>;
+        _deinterleaveUVC2RightShiftFunc = Deinterleave<1, 2, 2, 2, 1, 6>;
+        _deinterleaveY416Func           = Deinterleave<1, 2, 4, 3, 1>;
+        _deinterleaveRGBC1Func          = Deinterleave<1, 1, 4, 3, 2>;
+        _interleaveUVC1Func             = InterleaveUV<1, 1>;
+        _interleaveUVC2Func             = InterleaveUV<1, 2>;
+        _interleaveUVC2LeftShiftFunc    = InterleaveUV<1, 2, 6, true>;
+        _rightShiftFunc                 = BitShiftEach16BitInt<1, 6, true>;
+        _leftShiftFunc                  = BitShiftEach16BitInt<1, 6, false, true>;
+        _interleaveY416Func             = InterleaveThree<1, 1>;
+        _interleaveRGBC1Func            = InterleaveThree<1, 2>;
+        _deinterleaveY410Func           = DeinterleaveY410<1>;
+        _interleaveY410Func             = InterleaveY410<1>;
+        _deinterleaveRGB24Func          = DeinterleaveRGB<1, 1>;
+        _deinterleaveRGB48Func          = DeinterleaveRGB<1, 2>;
+        _interleaveRGB24Func            = InterleaveRGB<1, 1>;
+        _interleaveRGB48Func            = InterleaveRGB<1, 2>;
+        _deinterleaveYUY2Func           = DeinterleaveYUY2<1, 1, 0>;
+        _deinterleaveY210Func           = DeinterleaveYUY2<1, 2, 6>;
+        _deinterleaveY216Func           = DeinterleaveYUY2<1, 2, 0>;
+        _interleaveYUY2Func             = InterleaveYUY2<1, 1, 0>;
+        _interleaveY210Func             = InterleaveYUY2<1, 2, 6>;
+        _interleaveY216Func             = InterleaveYUY2<1, 2, 0>;
+        _deinterleaveV210Func           = DeinterleaveV210<1>;
+        _interleaveV210Func             = InterleaveV210<1>;
+        _copyPlaneStreamingFunc         = CopyPlaneStreaming<1>;
+        _vectorSize                     = sizeof(__m128i);
     } else {
-        _deinterleaveUVC1Func  = Deinterleave<0, 1, 2, 2, 1>;
-        _deinterleaveUVC2Func  = Deinterleave<0, 2, 2, 2, 1>;
-        _deinterleaveY416Func  = Deinterleave<0, 2, 4, 3, 1>;
-        _deinterleaveRGBC1Func = Deinterleave<0, 1, 4, 3, 2>;
-        _interleaveUVC1Func    = InterleaveUV<0, 1>;
-        _interleaveUVC2Func    = InterleaveUV<0, 2>;
-        _rightShiftFunc        = BitShiftEach16BitInt<0, 6, true>;
-        _leftShiftFunc         = BitShiftEach16BitInt<0, 6, false>;
-        _vectorSize            = 0;
+        _deinterleaveUVC1Func           = Deinterleave<0, 1, 2, 2, 1>;
+        _deinterleaveUVC2Func           = Deinterleave<0, 2, 2, 2, 1>;
+        _deinterleaveUVC2RightShiftFunc = Deinterleave<0, 2, 2, 2, 1, 6>;
+        _deinterleaveY416Func           = Deinterleave<0, 2, 4, 3, 1>;
+        _deinterleaveRGBC1Func          = Deinterleave<0, 1, 4, 3, 2>;
+        _interleaveUVC1Func             = InterleaveUV<0, 1>;
+        _interleaveUVC2Func             = InterleaveUV<0, 2>;
+        _interleaveUVC2LeftShiftFunc    = InterleaveUV<0, 2, 6, true>;
+        _rightShiftFunc                 = BitShiftEach16BitInt<0, 6, true>;
+        _leftShiftFunc                  = BitShiftEach16BitInt<0, 6, false, true>;
+        _interleaveY416Func             = InterleaveThree<0, 1>;
+        _interleaveRGBC1Func            = InterleaveThree<0, 2>;
+        _deinterleaveY410Func           = DeinterleaveY410<0>;
+        _interleaveY410Func             = InterleaveY410<0>;
+        _deinterleaveRGB24Func          = DeinterleaveRGB<0, 1>;
+        _deinterleaveRGB48Func          = DeinterleaveRGB<0, 2>;
+        _interleaveRGB24Func            = InterleaveRGB<0, 1>;
+        _interleaveRGB48Func            = InterleaveRGB<0, 2>;
+        _deinterleaveYUY2Func           = DeinterleaveYUY2<0, 1, 0>;
+        _deinterleaveY210Func           = DeinterleaveYUY2<0, 2, 6>;
+        _deinterleaveY216Func           = DeinterleaveYUY2<0, 2, 0>;
+        _interleaveYUY2Func             = InterleaveYUY2<0, 1, 0>;
+        _interleaveY210Func             = InterleaveYUY2<0, 2, 6>;
+        _interleaveY216Func             = InterleaveYUY2<0, 2, 0>;
+        _deinterleaveV210Func           = DeinterleaveV210<0>;
+        _interleaveV210Func             = InterleaveV210<0>;
+        _copyPlaneStreamingFunc         = nullptr;
+        _vectorSize                     = 0;
     }
-
-    _interleaveY416Func = InterleaveThree<1>;
-    _interleaveRGBC1Func = InterleaveThree<2>;
-
-    INPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT = _vectorSize == 0 ? 8 : _vectorSize;
-    OUTPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT = (_vectorSize == 0 ? 2 : _vectorSize) * 2;
 }
 
 auto Format::LookupMediaSubtype(const CLSID &mediaSubtype) -> const PixelFormat * {
@@ -130,78 +366,65 @@ auto Format::LookupMediaSubtype(const CLSID &mediaSubtype) -> const PixelFormat
     return nullptr;
 }
 
-auto Format::GetStrideAlignedMediaSampleSize(const AM_MEDIA_TYPE &mediaType, int strideAlignment) -> long {
-    BITMAPINFOHEADER bmi = *GetBitmapInfo(mediaType);
-    bmi.biWidth = FFALIGN(bmi.biWidth, strideAlignment);
-    return GetBitmapSize(&bmi);
-}
-
-auto Format::DeinterleaveY410(const BYTE *src, int srcStride, std::array<BYTE *, 3> dsts, const std::array<int, 3> &dstStrides, int rowSize, int height) -> void {
-    // process one plane at a time by zeroing all other planes, shuffle it from different pixels together, and fix the position by right shifting
-
-    Environment::GetInstance().Log(L"DeinterleaveY410() start");
-
-    using Input = __m128i;
-    using Output = uint64_t;
-
-    for (int y = 0; y < height; ++y) {
-        const Input *srcLine = reinterpret_cast<const Input *>(src);
-        std::array<Output *, dsts.size()> dstsLine;
-        for (size_t p = 0; p < dsts.size(); ++p) {
-            dstsLine[p] = reinterpret_cast<Output *>(dsts[p]);
-        }
+auto Format::CopyFromInput(const VideoFormat &videoFormat, const BYTE *srcBuffer, const std::array<BYTE *, 3> &dstSlices, const std::array<int, 3> &dstStrides) -> void {
+    const ConversionPlan &plan = videoFormat.conversionPlan;
 
-        for (int i = 0; i < DivideRoundUp(rowSize, sizeof(Input)); ++i) {
-            const Input srcVec = *srcLine++;
+    ForEachBand(plan, [&](int bandRow, int bandHeight) -> void {
+        plan.copyFromInputBandFunc(plan, srcBuffer, dstSlices, dstStrides, bandRow, bandHeight);
+    });
+}
 
-            const Input dataVec1 = _mm_shuffle_epi8(_mm_and_si128(srcVec, _Y410_AND_MASK_1), _Y410_SHUFFLE_MASK_1);
-            const Input dataVec2 = _mm_srli_epi32(_mm_shuffle_epi8(_mm_and_si128(srcVec, _Y410_AND_MASK_2), _Y410_SHUFFLE_MASK_2), 2);
-            const Input dataVec3 = _mm_srli_epi32(_mm_shuffle_epi8(_mm_and_si128(srcVec, _Y410_AND_MASK_3), _Y410_SHUFFLE_MASK_3), 4);
+auto Format::CopyToOutput(const VideoFormat &videoFormat, const std::array<const BYTE *, 3> &srcSlices, const std::array<int, 3> &srcStrides, BYTE *dstBuffer) -> void {
+    const ConversionPlan &plan = videoFormat.conversionPlan;
 
-            *dstsLine[0]++ = *reinterpret_cast<const Output *>(&dataVec1);
-            *dstsLine[1]++ = *reinterpret_cast<const Output *>(&dataVec2);
-            *dstsLine[2]++ = *reinterpret_cast<const Output *>(&dataVec3);
-        }
+    ForEachBand(plan, [&](int bandRow, int bandHeight) -> void {
+        plan.copyToOutputBandFunc(plan, srcSlices, srcStrides, dstBuffer, bandRow, bandHeight);
+    });
+}
 
-        src += srcStride;
-        for (size_t p = 0; p < dsts.size(); ++p) {
-            dsts[p] += dstStrides[p];
-        }
+auto Format::GetCopyPlaneFunc(int planeSize) -> ConversionPlan::CopyPlaneFunc * {
+    if (_copyPlaneStreamingFunc != nullptr && planeSize >= MIN_STREAMING_COPY_PLANE_SIZE) {
+        return _copyPlaneStreamingFunc;
     }
 
-    Environment::GetInstance().Log(L"DeinterleaveY410() end");
+    return CopyPlane;
 }
 
-auto Format::InterleaveY410(std::array<const BYTE *, 3> srcs, const std::array<int, 3> &srcStrides, BYTE *dst, int dstStride, int rowSize, int height) -> void {
-    // expand each 16-bit integer to 32-bit, left shift to right position and OR them all
-    // due the expansion, only half the size for each source vector is used, therefore we need to cast
+auto Format::GetBandHeight(const BITMAPINFOHEADER &bmi, int height, int rowAlignment) -> int {
+    const int maxNumBands = std::min(static_cast<int>(GetBitmapSize(&bmi) / MIN_CONVERSION_BAND_SIZE), height / rowAlignment);
+    const int numBands = std::min(maxNumBands, ThreadPool::GetInstance().GetNumThreads());
 
-    Environment::GetInstance().Log(L"InterleaveY410() start");
+    if (numBands <= 1) {
+        return height;
+    }
 
-    using Input = uint64_t;
-    using Output = __m128i;
+    return DivideRoundUp(height / rowAlignment, numBands) * rowAlignment;
+}
 
-    for (int y = 0; y < height; ++y) {
-        std::array<const Input *, srcs.size()> srcsLine;
-        for (size_t p = 0; p < srcs.size(); ++p) {
-            srcsLine[p] = reinterpret_cast<const Input *>(srcs[p]);
-        }
-        Output *dstLine = reinterpret_cast<Output *>(dst);
+auto Format::ForEachBand(const ConversionPlan &plan, const std::function<void(int bandRow, int bandHeight)> &bandFunc) -> void {
+    if (plan.bandHeight >= plan.height) {
+        bandFunc(0, plan.height);
+        return;
+    }
 
-        for (int i = 0; i < DivideRoundUp(rowSize, sizeof(Output)); ++i) {
-            const Output vec1 = _mm_cvtepu16_epi32(*reinterpret_cast<const Output *>(srcsLine[0]++));
-            const Output vec2 = _mm_slli_epi32(_mm_cvtepu16_epi32(*reinterpret_cast<const Output *>(srcsLine[1]++)), 10);
-            const Output vec3 = _mm_slli_epi32(_mm_cvtepu16_epi32(*reinterpret_cast<const Output *>(srcsLine[2]++)), 20);
-            *dstLine++ = _mm_or_si128(_mm_or_si128(vec1, vec2), vec3);
-        }
+    ThreadPool::GetInstance().Run(DivideRoundUp(plan.height, plan.bandHeight), [&bandFunc, &plan](int bandIndex) -> void {
+        const int bandRow = bandIndex * plan.bandHeight;
+        bandFunc(bandRow, std::min(plan.bandHeight, plan.height - bandRow));
+    });
+}
 
-        for (size_t p = 0; p < srcs.size(); ++p) {
-            srcs[p] += srcStrides[p];
-        }
-        dst += dstStride;
+auto Format::GetBitmapSize(const BITMAPINFOHEADER *bmi) -> DWORD {
+    if (bmi->biCompression == FOURCCMap(&MEDIASUBTYPE_v210).GetFOURCC()) {
+        return static_cast<DWORD>(DivideRoundUp(bmi->biWidth, 48) * 128 * abs(bmi->biHeight));
     }
 
-    Environment::GetInstance().Log(L"InterleaveY410() end");
+    return ::GetBitmapSize(bmi);
+}
+
+auto Format::GetStrideAlignedMediaSampleSize(const AM_MEDIA_TYPE &mediaType, int strideAlignment) -> long {
+    BITMAPINFOHEADER bmi = *GetBitmapInfo(mediaType);
+    bmi.biWidth = FFALIGN(bmi.biWidth, strideAlignment);
+    return GetBitmapSize(&bmi);
 }
 
 }
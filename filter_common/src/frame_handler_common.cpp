@@ -17,8 +17,11 @@ FrameHandler::~FrameHandler() {
 
         // the paired BeginFlush() is in StopStreaming()
         WaitForWorkerLatch();
+        WaitForScriptLoad();
+        CancelScriptSwap();
         EndFlush();
 
+        _conversionThread.join();
         _workerThread.join();
     }
 }
@@ -26,33 +29,94 @@ FrameHandler::~FrameHandler() {
 auto FrameHandler::StartWorker() -> void {
     if (!_workerThread.joinable()) {
         _isStopping = false;
+        _conversionThread = std::thread(&FrameHandler::ConversionProc, this);
         _workerThread = std::thread(&FrameHandler::WorkerProc, this);
     }
 }
 
 auto FrameHandler::WaitForWorkerLatch() -> void {
+    _isConversionLatched.wait(false);
     _isWorkerLatched.wait(false);
 }
 
-auto FrameHandler::UpdateExtraSrcBuffer() -> void {
-    if (const int sourceAvgFps = MainFrameServer::GetInstance().GetSourceAvgFrameRate();
-        _nextSourceFrameNb % (sourceAvgFps / FRAME_RATE_SCALE_FACTOR) == 0) {
-        const double ratio = static_cast<double>(_currentInputFrameRate) / sourceAvgFps;
-        Environment::GetInstance().Log(L"Source rate ratio %5f", ratio);
-        if (ratio < 1 - EXTRA_SRC_BUFFER_CHANGE_THRESHOLD) {
-            _extraSrcBuffer += Environment::GetInstance().GetExtraSrcBufferIncStep();
-        } else if (ratio > 1 + EXTRA_SRC_BUFFER_CHANGE_THRESHOLD) {
-            _extraSrcBuffer -= Environment::GetInstance().GetExtraSrcBufferDecStep();
-        }
+auto FrameHandler::WaitForScriptLoad() -> void {
+    if (_scriptLoadThread.joinable()) {
+        _scriptLoadThread.join();
+    }
+}
+
+/*
+ * Called by the remote control and the property page, which never wait for an evaluation. A request during an evaluation
+ * supersedes the ones before it, and is evaluated by the running swap thread afterwards.
+ */
+auto FrameHandler::StartScriptSwap(const std::filesystem::path &scriptPath) -> void {
+    const std::unique_lock scriptSwapLock(_scriptSwapMutex);
+
+    // without a running script to keep serving frames, fall back to restarting the stream
+    if (!_isScriptReady || _isFlushing) {
+        _filter._needReloadScript = true;
+        return;
+    }
+
+    if (_isScriptSwapRunning) {
+        _pendingScriptPath = scriptPath;
+        return;
+    }
+
+    // the previous swap thread has nothing left to do after its last evaluation, so the join returns right away
+    if (_scriptSwapThread.joinable()) {
+        _scriptSwapThread.join();
+    }
+
+    _isScriptSwapRunning = true;
+    _scriptSwapThread = std::thread(&FrameHandler::ScriptSwapProc, this, CMediaType(_filter.m_pInput->CurrentMediaType()), scriptPath);
+}
 
-        _extraSrcBuffer = std::clamp(_extraSrcBuffer, Environment::GetInstance().GetMinExtraSrcBuffer(), Environment::GetInstance().GetMaxExtraSrcBuffer());
+auto FrameHandler::CancelScriptSwap() -> void {
+    {
+        const std::unique_lock scriptSwapLock(_scriptSwapMutex);
+
+        _pendingScriptPath.reset();
+    }
+
+    // an evaluation in progress can't be interrupted
+    // no new swap thread is started meanwhile, since the caller flushes before the cancellation
+    if (_scriptSwapThread.joinable()) {
+        _scriptSwapThread.join();
     }
+
+    const std::unique_lock standbyFrameServerLock(_standbyFrameServerMutex);
+
+    _standbyFrameServer.reset();
+    _isStandbyScriptReady = false;
+}
+
+auto FrameHandler::WaitForInputConversion() -> void {
+    std::unique_lock inputQueueLock(_inputQueueMutex);
+
+    _inputQueueCv.wait(inputQueueLock, [this]() -> bool {
+        return _isFlushing || _queuedInputSamples.empty();
+    });
+}
+
+auto FrameHandler::UpdateExtraSrcBuffer() -> void {
+    _extraSrcBuffer = _sourceBufferController.Update(_extraSrcBuffer,
+                                                     NUM_SRC_FRAMES_PER_PROCESSING,
+                                                     MainFrameServer::GetInstance().GetSourceAvgFrameDuration(),
+                                                     Format::GetBitmapSize(&_filter._inputVideoFormat.bmi));
+}
+
+auto FrameHandler::GetNumInFlightSourceFrames() const -> int {
+    // including the received samples that are not converted yet, and the erased frames whose slots are not reclaimed yet
+    return _nextSourceFrameNb - _sourceFrames.GetReclaimedFrameNb();
 }
 
 auto FrameHandler::GetInputBufferSize() const -> int {
-    const std::shared_lock sharedSourceLock(_sourceMutex);
+    return _sourceFrames.GetSize();
+}
 
-    return static_cast<int>(_sourceFrames.size());
+auto FrameHandler::GetStageLatency(PipelineStage stage) const -> LatencyHistogram::Summary {
+    return _stageLatencies[static_cast<int>(stage)].GetSummary();
 }
 
 auto FrameHandler::RefreshFrameRatesTemplate(int sampleNb, int &checkpointSampleNb, std::chrono::steady_clock::time_point &checkpointTime, int &currentFrameRate) -> void {
@@ -71,21 +135,202 @@ auto FrameHandler::RefreshFrameRatesTemplate(int sampleNb, int &checkpointSample
     }
 }
 
-auto FrameHandler::GarbageCollect(int srcFrameNb) -> void {
-    const std::unique_lock uniqueSourceLock(_sourceMutex);
+/*
+ * Converts the received samples into source frames in order, so that the upstream can decode the next frame meanwhile.
+ * The samples are released after their conversions, which returns the buffers to the upstream allocator.
+ */
+auto FrameHandler::ConversionProc() -> void {
+    Environment::GetInstance().Log(L"Start conversion thread");
 
-    const size_t dbgPreSize = _sourceFrames.size();
+#ifdef _DEBUG
+    SetThreadDescription(GetCurrentThread(), L"CSynthFilter Conversion");
+#endif
 
-    // search for all previous frames in case of some source frames are never used
-    // this could happen by plugins that decrease frame rate
-    const auto sourceEnd = _sourceFrames.end();
-    for (auto iter = _sourceFrames.begin(); iter != sourceEnd && iter->first <= srcFrameNb; iter = _sourceFrames.begin()) {
-        _sourceFrames.erase(iter);
+    _isConversionLatched = false;
+
+    while (true) {
+        if (_isFlushing) {
+            {
+                const std::unique_lock inputQueueLock(_inputQueueMutex);
+
+                _queuedInputSamples.clear();
+            }
+            _inputQueueCv.notify_all();
+
+            _isConversionLatched = true;
+            _isConversionLatched.notify_all();
+            _isFlushing.wait(true);
+
+            if (_isStopping) {
+                break;
+            }
+
+            _isConversionLatched = false;
+        }
+
+        const QueuedInputSample *queuedSample;
+        {
+            std::unique_lock inputQueueLock(_inputQueueMutex);
+
+            _inputQueueCv.wait(inputQueueLock, [this]() -> bool {
+                return _isFlushing || !_queuedInputSamples.empty();
+            });
+
+            if (_isFlushing) {
+                continue;
+            }
+
+            // emplace_back() of std::deque does not invalidate references to the existing elements
+            queuedSample = &_queuedInputSamples.front();
+        }
+
+        ConvertInputSample(*queuedSample);
+
+        {
+            const std::unique_lock inputQueueLock(_inputQueueMutex);
+
+            _queuedInputSamples.pop_front();
+        }
+        _inputQueueCv.notify_all();
     }
 
-    _addInputSampleCv.notify_all();
+    Environment::GetInstance().Log(L"Stop conversion thread");
+}
+
+auto FrameHandler::StartScriptLoad() -> void {
+    _streamStartTime = std::chrono::steady_clock::now();
 
-    Environment::GetInstance().Log(L"GarbageCollect frames until %6d pre size %3zd post size %3zd", srcFrameNb, dbgPreSize, _sourceFrames.size());
+    // with the script stopped and the source frames cleared, nothing holds the frames of the frameservers replaced in the swaps
+    if (!MainFrameServer::GetInstance().IsScriptLoaded()) {
+        MainFrameServer::GetInstance().ReleasePredecessor();
+    }
+
+    _isScriptReady = MainFrameServer::GetInstance().IsScriptLoaded();
+
+    if (!_isScriptReady && !_isStopping) {
+        _scriptLoadThread = std::thread(&FrameHandler::ScriptLoadProc, this, CMediaType(_filter.m_pInput->CurrentMediaType()));
+    }
+}
+
+/*
+ * Evaluates the main script while the initial source frames are buffered, so that neither the upstream nor the conversion waits for it.
+ * Source frames requested by the evaluation are served as usual. If a flush starts meanwhile, they are dummy frames,
+ * and the flush waits for the evaluation to finish before releasing the script.
+ */
+auto FrameHandler::ScriptLoadProc(CMediaType mediaType) -> void {
+    Environment::GetInstance().Log(L"Start script load thread");
+
+#ifdef _DEBUG
+    SetThreadDescription(GetCurrentThread(), L"CSynthFilter Script Load");
+#endif
+
+    const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    MainFrameServer::GetInstance().ReloadScript(mediaType, FrameServerCommon::GetInstance().GetScriptPath(), true);
+    Environment::GetInstance().TraceComplete("ReloadScript", _firstSourceFrameNb, startTime);
+
+    _isScriptReady = true;
+    _sourceFrames.NotifyAll();
+
+    Environment::GetInstance().Log(L"Stop script load thread after %lld ms",
+                                   std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count());
+}
+
+/*
+ * Evaluates the new script in a standby frameserver with its own environment, while the current script keeps serving frames.
+ * The standby one replaces the main frameserver at the next frame boundary if the output format is unchanged.
+ * Otherwise the stream is restarted with the new script, which renegotiates the output media type.
+ */
+auto FrameHandler::ScriptSwapProc(CMediaType mediaType, std::filesystem::path scriptPath) -> void {
+    Environment::GetInstance().Log(L"Start script swap thread");
+
+#ifdef _DEBUG
+    SetThreadDescription(GetCurrentThread(), L"CSynthFilter Script Swap");
+#endif
+
+    const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    while (true) {
+        std::unique_ptr<MainFrameServer> standbyFrameServer = std::make_unique<MainFrameServer>();
+        standbyFrameServer->LinkSynthFilter(&_filter);
+        const bool isReloaded = standbyFrameServer->ReloadScript(mediaType, scriptPath, true);
+        Environment::GetInstance().TraceComplete("Standby ReloadScript", _maxRequestedFrameNb, startTime);
+
+        {
+            const std::unique_lock scriptSwapLock(_scriptSwapMutex);
+
+            // the result of a superseded request is discarded
+            if (!_pendingScriptPath) {
+                if (isReloaded && standbyFrameServer->HasSameOutput(MainFrameServer::GetInstance())) {
+                    const std::unique_lock standbyFrameServerLock(_standbyFrameServerMutex);
+
+                    std::swap(_standbyFrameServer, standbyFrameServer);
+                    _isStandbyScriptReady = true;
+                } else {
+                    Environment::GetInstance().Log(L"New script changes the output format, restart the stream to renegotiate");
+                    _filter._needReloadScript = true;
+                }
+            }
+        }
+
+        // either the discarded frameserver or the standby one not yet swapped in, deleted without holding the locks
+        standbyFrameServer.reset();
+
+        const std::unique_lock scriptSwapLock(_scriptSwapMutex);
+
+        if (!_pendingScriptPath) {
+            _isScriptSwapRunning = false;
+            break;
+        }
+
+        Environment::GetInstance().Log(L"Script is changed again during the evaluation, evaluate the latest one");
+        scriptPath = std::move(*_pendingScriptPath);
+        _pendingScriptPath.reset();
+    }
+
+    Environment::GetInstance().Log(L"Stop script swap thread after %lld ms",
+                                   std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count());
+}
+
+/*
+ * Called by the only thread requesting output frames, between two requests. The frames already requested from the previous script
+ * are still produced by it. The previous frameserver is kept alive by the new one until the script is stopped,
+ * since the caches of the new script could hold the source frames allocated by the previous environment.
+ */
+auto FrameHandler::SwapScript(int nextOutputFrameNb) -> void {
+    const std::unique_lock standbyFrameServerLock(_standbyFrameServerMutex);
+
+    _isStandbyScriptReady = false;
+    if (_standbyFrameServer == nullptr) {
+        return;
+    }
+
+    if (MainFrameServer::GetInstance().GetNumPredecessors() >= MAX_SCRIPT_SWAP_PREDECESSORS) {
+        Environment::GetInstance().Log(L"Too many replaced scripts are kept, restart the stream to release them");
+        _standbyFrameServer.reset();
+        _filter._needReloadScript = true;
+        return;
+    }
+
+    // the predecessors not yet released are kept along with their successor
+    MainFrameServer *newFrameServer = _standbyFrameServer.release();
+    newFrameServer->AdoptPredecessor(MainFrameServer::Replace(newFrameServer));
+
+    Environment::GetInstance().Log(L"Swap in the new script from output frame %6d", nextOutputFrameNb);
+}
+
+auto FrameHandler::GarbageCollect(int srcFrameNb) -> void {
+    const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    const bool isTraceLogEnabled = Environment::GetInstance().IsLogEnabled<LogLevel::Trace>();
+    const int dbgPreSize = isTraceLogEnabled ? _sourceFrames.GetSize() : 0;
+
+    // erase all previous frames in case of some source frames are never used
+    // this could happen by plugins that decrease frame rate
+    _sourceFrames.EraseUntil(srcFrameNb);
+
+    if (isTraceLogEnabled) {
+        Environment::GetInstance().Log<LogLevel::Trace>(L"GarbageCollect frames until %6d pre size %3d post size %3d", srcFrameNb, dbgPreSize, _sourceFrames.GetSize());
+    }
+    Environment::GetInstance().TraceComplete("GarbageCollect", srcFrameNb, startTime);
 }
 
 auto FrameHandler::ChangeOutputFormat() -> bool {
@@ -99,6 +344,9 @@ auto FrameHandler::ChangeOutputFormat() -> bool {
     _filter._isInputMediaTypeChanged = false;
     _filter._needReloadScript = false;
 
+    // the latencies are to be measured again with the new format and script
+    _sourceBufferController.Reset();
+
     AuxFrameServer::GetInstance().ReloadScript(_filter.m_pInput->CurrentMediaType(), true);
     auto potentialOutputMediaTypes = _filter.InputToOutputMediaType(&_filter.m_pInput->CurrentMediaType());
 
@@ -123,7 +371,7 @@ auto FrameHandler::ChangeOutputFormat() -> bool {
             return result;
         });
         newOutputMediaTypeIter == potentialOutputMediaTypes.end()) {
-        Environment::GetInstance().Log(L"Downstream does not accept any of the new output media types");
+        Environment::GetInstance().Log<LogLevel::Error>(L"Downstream does not accept any of the new output media types");
         _filter.AbortPlayback(VFW_E_TYPE_NOT_ACCEPTED);
         return false;
     }
@@ -133,6 +381,32 @@ auto FrameHandler::ChangeOutputFormat() -> bool {
     return true;
 }
 
+/*
+ * Called when no thread is using the script or the source frames. If the script is kept through the flush, the new source frames
+ * are numbered after every frame that the script has seen, so that none of them is served from the frame caches of the script.
+ */
+auto FrameHandler::ResetFrameNumbers() -> void {
+    _firstSourceFrameNb = 0;
+    _firstOutputFrameNb = 0;
+
+    if (!MainFrameServer::GetInstance().IsScriptLoaded()) {
+        return;
+    }
+
+    const int firstSourceFrameNb = std::max(_nextSourceFrameNb, _maxRequestedFrameNb + 1) + KEPT_SCRIPT_FRAME_NB_MARGIN;
+    if (firstSourceFrameNb > NUM_FRAMES_FOR_INFINITE_STREAM / 2) {
+        Environment::GetInstance().Log(L"Reload script to restart the frame numbers from 0");
+        MainFrameServer::GetInstance().StopScript();
+        return;
+    }
+
+    _firstSourceFrameNb = firstSourceFrameNb;
+    _firstOutputFrameNb = static_cast<int>(llMulDiv(_firstSourceFrameNb,
+                                                    MainFrameServer::GetInstance().GetSourceAvgFrameDuration(),
+                                                    MainFrameServer::GetInstance().GetScriptAvgFrameDuration(),
+                                                    0));
+}
+
 auto FrameHandler::RefreshInputFrameRates(int frameNb) -> void {
     RefreshFrameRatesTemplate(frameNb, _frameRateCheckpointInputSampleNb, _frameRateCheckpointInputSampleTime, _currentInputFrameRate);
 }
@@ -145,4 +419,13 @@ auto FrameHandler::RefreshDeliveryFrameRates(int frameNb) -> void {
     RefreshFrameRatesTemplate(frameNb, _frameRateCheckpointDeliveryFrameNb, _frameRateCheckpointDeliveryFrameTime, _currentDeliveryFrameRate);
 }
 
+auto FrameHandler::RecordStageLatency(PipelineStage stage, std::chrono::steady_clock::time_point startTime) -> void {
+    const std::chrono::steady_clock::duration latency = std::chrono::steady_clock::now() - startTime;
+    _stageLatencies[static_cast<int>(stage)].Record(latency);
+
+    if (stage == PipelineStage::GetFrame) {
+        _sourceBufferController.RecordScriptLatency(latency);
+    }
+}
+
 }
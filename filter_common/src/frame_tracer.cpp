@@ -0,0 +1,185 @@
+// License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
+
+#include "frame_tracer.h"
+
+#include "util.h"
+
+
+namespace SynthFilter {
+
+static std::atomic<uint64_t> nextTracerId = 1;
+
+FrameTracer::ThreadBuffer::ThreadBuffer(DWORD threadId)
+    : threadId(threadId) {
+    if (PWSTR threadDescription; SUCCEEDED(GetThreadDescription(GetCurrentThread(), &threadDescription))) {
+        // the name is written into a JSON string
+        for (const char c : ConvertWideToUtf8(threadDescription)) {
+            if (c == '"' || c == '\\') {
+                threadName.push_back('\\');
+            }
+            threadName.push_back(c);
+        }
+
+        LocalFree(threadDescription);
+    }
+}
+
+FrameTracer::FrameTracer(FILE *file)
+    : _file(file)
+    , _startTime(std::chrono::steady_clock::now())
+    , _processId(GetCurrentProcessId())
+    , _id(nextTracerId++) {
+    fputs("[\n", _file);
+}
+
+FrameTracer::~FrameTracer() {
+    Flush();
+
+    fputs("\n]\n", _file);
+    fflush(_file);
+}
+
+auto FrameTracer::AddCompleteEvent(const char *name, int frameNb, std::chrono::steady_clock::time_point startTime) -> void {
+    AddEvent(name, EventType::Complete, frameNb, startTime, std::chrono::steady_clock::now());
+}
+
+auto FrameTracer::AddAsyncEvent(const char *name, int frameNb, std::chrono::steady_clock::time_point startTime) -> void {
+    AddEvent(name, EventType::Async, frameNb, startTime, std::chrono::steady_clock::now());
+}
+
+auto FrameTracer::AddInstantEvent(const char *name, int frameNb) -> void {
+    const std::chrono::steady_clock::time_point currentTime = std::chrono::steady_clock::now();
+    AddEvent(name, EventType::Instant, frameNb, currentTime, currentTime);
+}
+
+auto FrameTracer::Flush() -> void {
+    const std::unique_lock flushLock(_flushMutex);
+
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        const std::unique_lock buffersLock(_buffersMutex);
+
+        // buffers only referenced by the tracer belong to exited threads, which will not add events again
+        std::erase_if(_buffers, [](const std::shared_ptr<ThreadBuffer> &buffer) -> bool {
+            return buffer.use_count() == 1 && buffer->events.empty() && buffer->numDropped == 0;
+        });
+        buffers = _buffers;
+    }
+
+    std::vector<TraceEvent> events;
+    for (const std::shared_ptr<ThreadBuffer> &bufferPtr : buffers) {
+        ThreadBuffer &buffer = *bufferPtr;
+        uint32_t numDropped;
+        {
+            const std::unique_lock bufferLock(buffer.mutex);
+
+            events.swap(buffer.events);
+            numDropped = std::exchange(buffer.numDropped, 0);
+        }
+
+        if (!buffer.isThreadNameWritten && !buffer.threadName.empty()) {
+            BeginRecord();
+            fprintf_s(_file, R"({"name":"thread_name","ph":"M","pid":%lu,"tid":%lu,"args":{"name":"%s"}})", _processId, buffer.threadId, buffer.threadName.c_str());
+            buffer.isThreadNameWritten = true;
+        }
+
+        for (const TraceEvent &event : events) {
+            WriteEvent(buffer.threadId, event);
+        }
+        events.clear();
+
+        if (numDropped > 0) {
+            BeginRecord();
+            fprintf_s(_file,
+                      R"({"name":"Dropped trace events","ph":"i","s":"t","pid":%lu,"tid":%lu,"ts":%.3f,"args":{"count":%u}})",
+                      _processId,
+                      buffer.threadId,
+                      ToTimestamp(std::chrono::steady_clock::now()),
+                      numDropped);
+        }
+    }
+
+    fflush(_file);
+}
+
+auto FrameTracer::AddEvent(const char *name, EventType type, int frameNb, std::chrono::steady_clock::time_point startTime, std::chrono::steady_clock::time_point endTime) -> void {
+    ThreadBuffer &buffer = GetThreadBuffer();
+    const std::unique_lock bufferLock(buffer.mutex);
+
+    if (buffer.events.size() >= TRACE_MAX_EVENTS_PER_THREAD) {
+        buffer.numDropped += 1;
+        return;
+    }
+
+    buffer.events.emplace_back(name, type, frameNb, startTime, endTime);
+}
+
+auto FrameTracer::GetThreadBuffer() -> ThreadBuffer & {
+    // the buffer is shared with the tracer, so that the events added right before the thread exits are still written
+    thread_local std::shared_ptr<ThreadBuffer> threadBuffer;
+    thread_local uint64_t threadBufferTracerId = 0;
+
+    if (threadBufferTracerId != _id) {
+        threadBuffer = std::make_shared<ThreadBuffer>(GetCurrentThreadId());
+        threadBufferTracerId = _id;
+
+        const std::unique_lock buffersLock(_buffersMutex);
+        _buffers.emplace_back(threadBuffer);
+    }
+
+    return *threadBuffer;
+}
+
+auto FrameTracer::WriteEvent(DWORD threadId, const TraceEvent &event) -> void {
+    const double startTimestamp = ToTimestamp(event.startTime);
+    const double endTimestamp = ToTimestamp(event.endTime);
+
+    switch (event.type) {
+    case EventType::Complete:
+        BeginRecord();
+        fprintf_s(_file,
+                  R"({"name":"%s","ph":"X","pid":%lu,"tid":%lu,"ts":%.3f,"dur":%.3f,"args":{"frame":%d}})",
+                  event.name,
+                  _processId,
+                  threadId,
+                  startTimestamp,
+                  endTimestamp - startTimestamp,
+                  event.frameNb);
+        break;
+
+    case EventType::Async:
+        // the pair of begin and end records is matched by the category, name and id
+        BeginRecord();
+        fprintf_s(_file,
+                  R"({"name":"%s","cat":"frame","ph":"b","id":%d,"pid":%lu,"tid":%lu,"ts":%.3f,"args":{"frame":%d}})",
+                  event.name,
+                  event.frameNb,
+                  _processId,
+                  threadId,
+                  startTimestamp,
+                  event.frameNb);
+        BeginRecord();
+        fprintf_s(_file, R"({"name":"%s","cat":"frame","ph":"e","id":%d,"pid":%lu,"tid":%lu,"ts":%.3f})", event.name, event.frameNb, _processId, threadId, endTimestamp);
+        break;
+
+    case EventType::Instant:
+        BeginRecord();
+        fprintf_s(_file, R"({"name":"%s","ph":"i","s":"t","pid":%lu,"tid":%lu,"ts":%.3f,"args":{"frame":%d}})", event.name, _processId, threadId, startTimestamp, event.frameNb);
+        break;
+    }
+}
+
+auto FrameTracer::BeginRecord() -> void {
+    if (_isFirstRecord) {
+        _isFirstRecord = false;
+    } else {
+        fputs(",\n", _file);
+    }
+}
+
+auto FrameTracer::ToTimestamp(std::chrono::steady_clock::time_point time) const -> double {
+    // timestamps of the trace event format are in microseconds
+    return std::chrono::duration<double, std::micro>(time - _startTime).count();
+}
+
+}
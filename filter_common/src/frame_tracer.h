@@ -0,0 +1,86 @@
+// License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
+
+#pragma once
+
+#include "constants.h"
+#include "macros.h"
+
+
+namespace SynthFilter {
+
+/*
+ * Tracer that records the lifecycle of every frame as events on a timeline, in the Chrome trace event format.
+ * The trace file can be opened in chrome://tracing or https://ui.perfetto.dev to see how the threads overlap.
+ *
+ * Each thread appends its events to its own buffer, so threads only contend with Flush().
+ * Flush() moves the buffered events to the file. Until the tracer is destroyed, the file lacks the closing bracket of the JSON array,
+ * which both viewers tolerate.
+ *
+ * When a thread has TRACE_MAX_EVENTS_PER_THREAD buffered events, further events are dropped and counted until the next flush.
+ */
+class FrameTracer {
+public:
+    explicit FrameTracer(FILE *file);
+    ~FrameTracer();
+
+    DISABLE_COPYING(FrameTracer)
+
+    /*
+     * name is stored as is and only read in Flush(), thus must be a string literal.
+     * Complete and async events last from startTime to the time of the call.
+     * Complete events are shown on the thread that adds them. Async events could start on a different thread, and are shown on their own track.
+     */
+    auto AddCompleteEvent(const char *name, int frameNb, std::chrono::steady_clock::time_point startTime) -> void;
+    auto AddAsyncEvent(const char *name, int frameNb, std::chrono::steady_clock::time_point startTime) -> void;
+    auto AddInstantEvent(const char *name, int frameNb) -> void;
+    auto Flush() -> void;
+
+private:
+    enum class EventType {
+        Complete,
+        Async,
+        Instant,
+    };
+
+    struct TraceEvent {
+        const char *name;
+        EventType type;
+        int frameNb;
+        std::chrono::steady_clock::time_point startTime;
+        std::chrono::steady_clock::time_point endTime;
+    };
+
+    struct ThreadBuffer {
+        explicit ThreadBuffer(DWORD threadId);
+
+        const DWORD threadId;
+        std::string threadName;
+        bool isThreadNameWritten = false;
+
+        // only contended when flushing
+        std::mutex mutex;
+        std::vector<TraceEvent> events;
+        uint32_t numDropped = 0;
+    };
+
+    auto AddEvent(const char *name, EventType type, int frameNb, std::chrono::steady_clock::time_point startTime, std::chrono::steady_clock::time_point endTime) -> void;
+    auto GetThreadBuffer() -> ThreadBuffer &;
+    auto WriteEvent(DWORD threadId, const TraceEvent &event) -> void;
+    auto BeginRecord() -> void;
+    auto ToTimestamp(std::chrono::steady_clock::time_point time) const -> double;
+
+    FILE *_file;
+    const std::chrono::steady_clock::time_point _startTime;
+    const DWORD _processId;
+
+    // distinguishes the buffers registered to this tracer from the ones of a previous instance in the thread_local storage
+    const uint64_t _id;
+
+    std::mutex _buffersMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> _buffers;
+
+    std::mutex _flushMutex;
+    bool _isFirstRecord = true;
+};
+
+}
@@ -6,9 +6,29 @@
 namespace SynthFilter {
 
 auto FrameServerCommon::SetScriptPath(const std::filesystem::path &scriptPath) -> void {
+    const std::unique_lock scriptPathLock(_scriptPathMutex);
+
     _scriptPath = scriptPath;
 }
 
+auto FrameServerCommon::GetScriptPath() const -> std::filesystem::path {
+    const std::unique_lock scriptPathLock(_scriptPathMutex);
+
+    return _scriptPath;
+}
+
+auto MainFrameServer::ReleasePredecessor() -> void {
+    if (_predecessor != nullptr) {
+        // the destructor releases the predecessors of the predecessor after its own environment
+        _predecessor->StopScript();
+        _predecessor.reset();
+    }
+}
+
+auto MainFrameServer::GetNumPredecessors() const -> int {
+    return _predecessor == nullptr ? 0 : _predecessor->GetNumPredecessors() + 1;
+}
+
 auto MainFrameServer::GetErrorString() const -> std::optional<std::string> {
     return _errorString.empty() ? std::nullopt : std::make_optional(_errorString);
 }
@@ -34,10 +54,9 @@ auto AuxFrameServer::GenerateMediaType(const Format::PixelFormat &pixelFormat, c
 
         // if the script changes the video dimension, we need to adjust the DAR
         // assuming the pixel aspect ratio remains the same, new DAR = PAR / new (script) SAR
-        const auto &sourceVideoInfo = FrameServerCommon::GetInstance()._sourceVideoInfo;
-        if (_scriptVideoInfo.width != sourceVideoInfo.width || _scriptVideoInfo.height != sourceVideoInfo.height) {
-            unsigned long long darX = static_cast<unsigned long long>(newVih2->dwPictAspectRatioX) * sourceVideoInfo.height * _scriptVideoInfo.width;
-            unsigned long long darY = static_cast<unsigned long long>(newVih2->dwPictAspectRatioY) * sourceVideoInfo.width * _scriptVideoInfo.height;
+        if (_scriptVideoInfo.width != _sourceVideoInfo.width || _scriptVideoInfo.height != _sourceVideoInfo.height) {
+            unsigned long long darX = static_cast<unsigned long long>(newVih2->dwPictAspectRatioX) * _sourceVideoInfo.height * _scriptVideoInfo.width;
+            unsigned long long darY = static_cast<unsigned long long>(newVih2->dwPictAspectRatioY) * _sourceVideoInfo.width * _scriptVideoInfo.height;
             CoprimeIntegers(darX, darY);
             newVih2->dwPictAspectRatioX = static_cast<DWORD>(darX);
             newVih2->dwPictAspectRatioY = static_cast<DWORD>(darY);
@@ -56,8 +75,6 @@ auto AuxFrameServer::GenerateMediaType(const Format::PixelFormat &pixelFormat, c
     newBmi->biWidth = _scriptVideoInfo.width;
     newBmi->biHeight = _scriptVideoInfo.height;
     newBmi->biBitCount = pixelFormat.bitCount;
-    newBmi->biSizeImage = GetBitmapSize(newBmi);
-    newMediaType.SetSampleSize(newBmi->biSizeImage);
 
     if (fourCC == pixelFormat.mediaSubtype) {
         // uncompressed formats (such as RGB32) have different GUIDs
@@ -66,7 +83,120 @@ auto AuxFrameServer::GenerateMediaType(const Format::PixelFormat &pixelFormat, c
         newBmi->biCompression = BI_RGB;
     }
 
+    // the size of v210 depends on biCompression
+    newBmi->biSizeImage = Format::GetBitmapSize(newBmi);
+    newMediaType.SetSampleSize(newBmi->biSizeImage);
+
     return newMediaType;
 }
 
+auto AuxFrameServer::GetProbeCacheEntry(const AM_MEDIA_TYPE &mediaType, const std::filesystem::path &scriptPath) -> std::optional<ProbeCacheEntry> {
+    const Format::PixelFormat *pixelFormat = Format::LookupMediaSubtype(mediaType.subtype);
+
+    if (!Environment::GetInstance().IsScriptProbeCached() || scriptPath.empty() || pixelFormat == nullptr) {
+        return std::nullopt;
+    }
+
+    std::error_code ec;
+    const std::filesystem::file_time_type scriptWriteTime = std::filesystem::last_write_time(scriptPath, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+
+    const uintmax_t scriptSize = std::filesystem::file_size(scriptPath, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+
+    // the same fields that the source clip is created from in Format::GetVideoFormat()
+    const VIDEOINFOHEADER *vih = reinterpret_cast<const VIDEOINFOHEADER *>(mediaType.pbFormat);
+    std::wstring key = std::format(L"{}_{}x{}_{} {} {} {}",
+                                   pixelFormat->name,
+                                   vih->rcSource.right - vih->rcSource.left,
+                                   vih->rcSource.bottom - vih->rcSource.top,
+                                   vih->AvgTimePerFrame,
+                                   scriptWriteTime.time_since_epoch().count(),
+                                   scriptSize,
+                                   scriptPath.native());
+
+    // FNV-1a, since the slot of a key must be the same across builds and runs, which std::hash does not guarantee
+    uint64_t keyHash = 0xcbf29ce484222325;
+    for (const WCHAR c : key) {
+        keyHash = (keyHash ^ c) * 0x100000001b3;
+    }
+
+    return ProbeCacheEntry {
+        .slotName = std::format(L"{}", keyHash % PROBE_CACHE_NUM_SLOTS),
+        .key = std::move(key),
+    };
+}
+
+auto AuxFrameServer::LoadProbeResult(const AM_MEDIA_TYPE &mediaType, const std::filesystem::path &scriptPath) -> bool {
+    const std::optional<ProbeCacheEntry> optEntry = GetProbeCacheEntry(mediaType, scriptPath);
+    if (!optEntry) {
+        return false;
+    }
+
+    // the value is the result followed by the key, since the key ends with the script path, which could contain spaces
+    const std::wstring value = Environment::GetInstance().ReadProbeCacheEntry(optEntry->slotName);
+    int width;
+    int height;
+    int64_t fpsNum;
+    int64_t fpsDen;
+    int scriptPixelType;
+    int keyOffset = 0;
+    if (swscanf_s(value.c_str(), L"%d %d %lld %lld %d %n", &width, &height, &fpsNum, &fpsDen, &scriptPixelType, &keyOffset) != 5 || fpsNum <= 0 || fpsDen <= 0) {
+        return false;
+    }
+
+    // the slot is either empty or taken by another key
+    if (keyOffset == 0 || std::wstring_view(value).substr(keyOffset) != optEntry->key) {
+        return false;
+    }
+
+    _sourceVideoInfo = Format::GetVideoFormat(mediaType, this).videoInfo;
+
+    _scriptVideoInfo = {};
+    _scriptVideoInfo.width = width;
+    _scriptVideoInfo.height = height;
+#ifdef AVSF_AVISYNTH
+    _scriptVideoInfo.fps_numerator = static_cast<unsigned int>(fpsNum);
+    _scriptVideoInfo.fps_denominator = static_cast<unsigned int>(fpsDen);
+    _scriptVideoInfo.pixel_type = scriptPixelType;
+#else
+    _scriptVideoInfo.fpsNum = fpsNum;
+    _scriptVideoInfo.fpsDen = fpsDen;
+    if (AVSF_VPS_API->getVideoFormatByID(&_scriptVideoInfo.format, static_cast<uint32_t>(scriptPixelType), GetVsCore()) == 0) {
+        return false;
+    }
+#endif
+    _scriptAvgFrameDuration = llMulDiv(fpsDen, UNITS, fpsNum, 0);
+
+    Environment::GetInstance().Log(L"Reuse cached script probe result: %ls", optEntry->key.c_str());
+    return true;
+}
+
+auto AuxFrameServer::SaveProbeResult(const AM_MEDIA_TYPE &mediaType, const std::filesystem::path &scriptPath) const -> void {
+    // the error script and the source clip of the disconnecting script are not the outcome of a normal evaluation
+    if (!_errorString.empty() || _isDisconnectRequested) {
+        return;
+    }
+
+    const std::optional<ProbeCacheEntry> optEntry = GetProbeCacheEntry(mediaType, scriptPath);
+    if (!optEntry) {
+        return;
+    }
+
+#ifdef AVSF_AVISYNTH
+    const int64_t fpsNum = _scriptVideoInfo.fps_numerator;
+    const int64_t fpsDen = _scriptVideoInfo.fps_denominator;
+#else
+    const int64_t fpsNum = _scriptVideoInfo.fpsNum;
+    const int64_t fpsDen = _scriptVideoInfo.fpsDen;
+#endif
+    Environment::GetInstance().WriteProbeCacheEntry(
+        optEntry->slotName,
+        std::format(L"{} {} {} {} {} {}", _scriptVideoInfo.width, _scriptVideoInfo.height, fpsNum, fpsDen, static_cast<int>(GetScriptPixelType()), optEntry->key));
+}
+
 }
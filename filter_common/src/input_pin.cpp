@@ -4,6 +4,7 @@
 
 #include "allocator.h"
 #include "constants.h"
+#include "environment.h"
 #include "format.h"
 #include "macros.h"
 
@@ -26,7 +27,8 @@ auto STDMETHODCALLTYPE CSynthFilterInputPin::ReceiveConnection(IPin *pConnector,
             ALLOCATOR_PROPERTIES props, actual;
             CheckHr(m_pAllocator->GetProperties(&props));
 
-            const int strideAlignment = std::max(MEDIA_SAMPLE_STRIDE_ALGINMENT, Format::INPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT);
+            // the conversion kernels work with any stride, so only pad the buffer if the input is asked to be aligned
+            const int strideAlignment = Environment::GetInstance().IsInputStrideAligned() ? MEDIA_SAMPLE_STRIDE_ALGINMENT : 1;
             const long newMediaSampleSize = Format::GetStrideAlignedMediaSampleSize(*pmt, strideAlignment);
 
             // if the new media sample size is larger than current, we need to re-allocate buffers with larger sample size
@@ -72,4 +74,15 @@ auto STDMETHODCALLTYPE CSynthFilterInputPin::GetAllocator(__deref_out IMemAlloca
     return S_OK;
 }
 
+/**
+ * the upstream allocates at least this many buffers, so that it can decode ahead while the samples are queued for conversion
+ */
+auto STDMETHODCALLTYPE CSynthFilterInputPin::GetAllocatorRequirements(__out ALLOCATOR_PROPERTIES *pProps) -> HRESULT {
+    CheckPointer(pProps, E_POINTER);
+
+    pProps->cBuffers = MIN_INPUT_SAMPLE_BUFFERS;
+
+    return S_OK;
+}
+
 }
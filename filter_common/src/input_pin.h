@@ -15,6 +15,7 @@ public:
 
     auto STDMETHODCALLTYPE ReceiveConnection(IPin *pConnector, const AM_MEDIA_TYPE *pmt) -> HRESULT override;
     auto STDMETHODCALLTYPE GetAllocator(__deref_out IMemAllocator **ppAllocator) -> HRESULT override;
+    auto STDMETHODCALLTYPE GetAllocatorRequirements(__out ALLOCATOR_PROPERTIES *pProps) -> HRESULT override;
 };
 
 }
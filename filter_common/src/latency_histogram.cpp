@@ -0,0 +1,82 @@
+// License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
+
+#include "latency_histogram.h"
+
+
+namespace SynthFilter {
+
+auto LatencyHistogram::Record(std::chrono::steady_clock::duration latency) -> void {
+    const uint64_t value = std::max<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(latency).count(), 0);
+
+    _buckets[GetBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+
+    // on failure, compare_exchange_weak() reloads currentMax for the next comparison
+    uint64_t currentMax = _max.load(std::memory_order_relaxed);
+    while (value > currentMax && !_max.compare_exchange_weak(currentMax, value, std::memory_order_relaxed)) {
+    }
+}
+
+auto LatencyHistogram::GetSummary() const -> Summary {
+    std::array<uint64_t, NUM_BUCKETS> counts;
+    uint64_t totalCount = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+        counts[i] = _buckets[i].load(std::memory_order_relaxed);
+        totalCount += counts[i];
+    }
+
+    Summary summary {
+        .count = totalCount,
+        .max = static_cast<int64_t>(_max.load(std::memory_order_relaxed)),
+    };
+
+    const auto GetPercentile = [&counts, &summary](int percentile) -> int64_t {
+        // the smallest value that at least the percentile of all records are less than or equal to
+        const uint64_t targetCount = std::max<uint64_t>((summary.count * percentile + 99) / 100, 1);
+        uint64_t cumulativeCount = 0;
+
+        for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+            cumulativeCount += counts[i];
+            if (cumulativeCount >= targetCount) {
+                return std::min(static_cast<int64_t>(GetBucketHighestValue(i)), summary.max);
+            }
+        }
+
+        return summary.max;
+    };
+
+    if (summary.count > 0) {
+        summary.p50 = GetPercentile(50);
+        summary.p95 = GetPercentile(95);
+        summary.p99 = GetPercentile(99);
+    }
+
+    return summary;
+}
+
+/*
+ * Values below 2 * SUB_BUCKET_COUNT have a bucket each.
+ * Larger values are shifted right until only the highest LATENCY_HISTOGRAM_SUB_BUCKET_BITS + 1 bits remain,
+ * and every additional bit of shift adds another SUB_BUCKET_COUNT buckets.
+ */
+auto LatencyHistogram::GetBucketIndex(uint64_t value) -> size_t {
+    value = std::min(value, MAX_TRACKABLE_VALUE);
+
+    if (value < 2 * SUB_BUCKET_COUNT) {
+        return static_cast<size_t>(value);
+    }
+
+    const int shift = std::bit_width(value) - (LATENCY_HISTOGRAM_SUB_BUCKET_BITS + 1);
+    return static_cast<size_t>(shift * SUB_BUCKET_COUNT + (value >> shift));
+}
+
+auto LatencyHistogram::GetBucketHighestValue(size_t index) -> uint64_t {
+    if (index < 2 * SUB_BUCKET_COUNT) {
+        return index;
+    }
+
+    const int shift = static_cast<int>(index / SUB_BUCKET_COUNT) - 1;
+    const uint64_t subBucket = index - shift * SUB_BUCKET_COUNT;
+    return ((subBucket + 1) << shift) - 1;
+}
+
+}
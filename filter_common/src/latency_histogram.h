@@ -0,0 +1,47 @@
+// License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
+
+#pragma once
+
+#include "constants.h"
+#include "macros.h"
+
+
+namespace SynthFilter {
+
+/*
+ * Histogram of latencies in the style of HdrHistogram, with fixed memory and relative precision.
+ *
+ * Recording is a few relaxed atomic operations without lock, so it can be done by any thread on the frame path.
+ * Reading sums up the buckets at the time of the call. Records happening during the read may or may not be included.
+ */
+class LatencyHistogram {
+public:
+    // all values are in microseconds
+    struct Summary {
+        uint64_t count;
+        int64_t p50;
+        int64_t p95;
+        int64_t p99;
+        int64_t max;
+    };
+
+    LatencyHistogram() = default;
+
+    DISABLE_COPYING(LatencyHistogram)
+
+    auto Record(std::chrono::steady_clock::duration latency) -> void;
+    auto GetSummary() const -> Summary;
+
+private:
+    static constexpr const uint64_t SUB_BUCKET_COUNT = 1ull << LATENCY_HISTOGRAM_SUB_BUCKET_BITS;
+    static constexpr const uint64_t MAX_TRACKABLE_VALUE = (1ull << LATENCY_HISTOGRAM_MAX_MAGNITUDE) - 1;
+    static constexpr const size_t NUM_BUCKETS = (LATENCY_HISTOGRAM_MAX_MAGNITUDE - LATENCY_HISTOGRAM_SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+    static auto GetBucketIndex(uint64_t value) -> size_t;
+    static auto GetBucketHighestValue(size_t index) -> uint64_t;
+
+    std::array<std::atomic<uint64_t>, NUM_BUCKETS> _buckets {};
+    std::atomic<uint64_t> _max = 0;
+};
+
+}
@@ -76,7 +76,7 @@ auto RegisterFilter() -> HRESULT {
     const HRESULT hr = AMovieDllRegisterServer2(TRUE);
     if (FAILED(hr)) {
         Environment::Create();
-        Environment::GetInstance().Log(L"Registeration failed: %ld", hr);
+        Environment::GetInstance().Log<LogLevel::Error>(L"Registeration failed: %ld", hr);
         Environment::Destroy();
     }
 
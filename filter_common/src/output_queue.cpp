@@ -0,0 +1,46 @@
+// License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
+
+#include "output_queue.h"
+
+
+namespace SynthFilter {
+
+/*
+ * The queue is always used, regardless of ReceiveCanBlock() of the downstream, since the point is to never block the worker.
+ * Batches are not exact, thus the delivery thread sends whatever is queued instead of waiting for a full batch.
+ */
+CSynthFilterOutputQueue::CSynthFilterOutputQueue(IPin *pInputPin, HRESULT *phr, int depth)
+    : COutputQueue(pInputPin, phr, FALSE, TRUE, GetBatchSize(depth), FALSE)
+    , _depth(depth) {
+    SetPopEvent(_popEvent);
+}
+
+CSynthFilterOutputQueue::~CSynthFilterOutputQueue() {
+    // the base destructor stops the delivery thread, which still signals the event when freeing the remaining samples
+    const std::unique_lock lock(*this);
+    SetPopEvent(nullptr);
+}
+
+auto CSynthFilterOutputQueue::Deliver(IMediaSample *pSample) -> HRESULT {
+    while (GetNumQueuedSamples() >= _depth) {
+        // the event is auto reset, so a pop after the check is not missed
+        _popEvent.Wait();
+    }
+
+    return Receive(pSample);
+}
+
+auto CSynthFilterOutputQueue::WaitForDelivery() -> void {
+    // the delivery thread signals the event every time it checks the queue, including right before it becomes idle
+    while (!IsIdle()) {
+        _popEvent.Wait();
+    }
+}
+
+auto CSynthFilterOutputQueue::GetNumQueuedSamples() -> int {
+    const std::unique_lock lock(*this);
+
+    return m_List->GetCount();
+}
+
+}
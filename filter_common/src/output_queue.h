@@ -0,0 +1,41 @@
+// License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
+
+#pragma once
+
+#include "constants.h"
+#include "macros.h"
+
+
+namespace SynthFilter {
+
+/*
+ * Queue of output samples that are delivered downstream by its own thread, so that the worker does not wait for the downstream's Receive().
+ * Consecutive queued samples are sent with one ReceiveMultiple() call.
+ *
+ * The number of queued samples is bounded. Deliver() blocks the caller until the queue has room.
+ * Besides the queued samples, the delivery thread holds at most one batch, which CSynthFilter::DecideBufferSize() reserves buffers for.
+ */
+class CSynthFilterOutputQueue : public COutputQueue {
+public:
+    CSynthFilterOutputQueue(IPin *pInputPin, HRESULT *phr, int depth);
+    ~CSynthFilterOutputQueue();
+
+    DISABLE_COPYING(CSynthFilterOutputQueue)
+
+    // unlike IMemInputPin::Receive(), the reference of the sample is taken over by the queue
+    auto Deliver(IMediaSample *pSample) -> HRESULT;
+    // blocks until the delivery thread sends all queued samples, or discards them due to flushing or a failed delivery
+    auto WaitForDelivery() -> void;
+    auto GetNumQueuedSamples() -> int;
+    constexpr auto GetDepth() const -> int { return _depth; }
+
+    static constexpr auto GetBatchSize(int depth) -> int { return std::min(depth, MAX_OUTPUT_QUEUE_BATCH_SIZE); }
+
+private:
+    const int _depth;
+
+    // signaled by the delivery thread every time it takes something off the queue, including when flushing
+    CAMEvent _popEvent;
+};
+
+}
@@ -8,9 +8,11 @@
 
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <chrono>
 #include <clocale>
 #include <condition_variable>
+#include <deque>
 #include <filesystem>
 #include <format>
 #include <functional>
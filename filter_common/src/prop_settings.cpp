@@ -44,11 +44,6 @@ auto CSynthFilterPropSettings::OnActivate() -> HRESULT {
         CheckDlgButton(m_Dlg, pixelFormat.resourceId, Environment::GetInstance().IsInputFormatEnabled(pixelFormat.name));
     });
 
-#ifdef AVSF_VAPOURSYNTH
-    EnableWindow(GetDlgItem(m_Dlg, IDC_INPUT_FORMAT_YUY2), FALSE);
-    EnableWindow(GetDlgItem(m_Dlg, IDC_INPUT_FORMAT_RGB24), FALSE);
-#endif
-
     const std::string title = std::format("<a>{} v{}</a>\nwith {}", FILTER_NAME_BASE, FILTER_VERSION_STRING, FrameServerCommon::GetInstance().GetVersionString());
     SetDlgItemTextA(m_hwnd, IDC_SYSLINK_TITLE, title.c_str());
 
@@ -3,6 +3,7 @@
 #include "prop_status.h"
 
 #include "constants.h"
+#include "environment.h"
 
 
 namespace SynthFilter {
@@ -76,6 +77,12 @@ auto CSynthFilterPropStatus::OnReceiveMessage(HWND hwnd, UINT uMsg, WPARAM wPara
         SetDlgItemTextW(hwnd, IDC_TEXT_FRAME_RATE_VALUE, std::format(L"{} -> {} -> {}", inputFrameRateStr, outputFrameRateStr, deliveryFrameRateStr).c_str());
         SetDlgItemTextW(hwnd, IDC_TEXT_PAR_VALUE, outputParStr.c_str());
 
+        if (const std::optional<int> numQueuedOutputSamples = _filter->GetNumQueuedOutputSamples()) {
+            SetDlgItemTextW(hwnd, IDC_TEXT_OUTPUT_QUEUE_VALUE, std::format(L"{} / {}", *numQueuedOutputSamples, Environment::GetInstance().GetOutputQueueDepth()).c_str());
+        } else {
+            SetDlgItemTextW(hwnd, IDC_TEXT_OUTPUT_QUEUE_VALUE, L"-");
+        }
+
         if (!_isSourcePathSet) {
             std::wstring_view videoSourcePath = _filter->GetVideoSourcePath().c_str();
             if (videoSourcePath.empty()) {
@@ -88,6 +95,28 @@ auto CSynthFilterPropStatus::OnReceiveMessage(HWND hwnd, UINT uMsg, WPARAM wPara
         const std::wstring infoStr = std::format(L"{} x {} {}", videoFormat.bmi.biWidth, abs(videoFormat.bmi.biHeight), videoFormat.pixelFormat->name);
         SetDlgItemTextW(hwnd, IDC_TEXT_FORMAT_VALUE, infoStr.c_str());
 
+        const auto SetLatencyText = [this, hwnd](int dlgItem, PipelineStage stage) -> void {
+            const LatencyHistogram::Summary summary = _filter->frameHandler->GetStageLatency(stage);
+            if (summary.count == 0) {
+                SetDlgItemTextW(hwnd, dlgItem, L"-");
+                return;
+            }
+
+            const auto ToMsString = [](int64_t latencyUs) -> std::wstring {
+                return DoubleToString(latencyUs / 1000.0, 2);
+            };
+            SetDlgItemTextW(hwnd,
+                            dlgItem,
+                            std::format(L"{} / {} / {} / {}", ToMsString(summary.p50), ToMsString(summary.p95), ToMsString(summary.p99), ToMsString(summary.max)).c_str());
+        };
+        SetLatencyText(IDC_TEXT_LATENCY_UPSTREAM_WAIT_VALUE, PipelineStage::UpstreamWait);
+        SetLatencyText(IDC_TEXT_LATENCY_CREATE_FRAME_VALUE, PipelineStage::CreateFrame);
+        SetLatencyText(IDC_TEXT_LATENCY_GET_FRAME_VALUE, PipelineStage::GetFrame);
+        SetLatencyText(IDC_TEXT_LATENCY_WRITE_SAMPLE_VALUE, PipelineStage::WriteSample);
+        SetLatencyText(IDC_TEXT_LATENCY_DELIVERY_BUFFER_VALUE, PipelineStage::GetDeliveryBuffer);
+        SetLatencyText(IDC_TEXT_LATENCY_DELIVER_VALUE, PipelineStage::Deliver);
+        SetLatencyText(IDC_TEXT_LATENCY_FIRST_FRAME_VALUE, PipelineStage::FirstFrame);
+
         return 0;
     }
 
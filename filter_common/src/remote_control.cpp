@@ -54,13 +54,13 @@ auto RemoteControl::Run() -> void {
     wc.hInstance = g_hInst;
     wc.lpszClassName = API_WND_CLASS_NAME;
     if (RegisterClassA(&wc) == 0) {
-        Environment::GetInstance().Log(L"Remote control failed to register window class: %5ld", GetLastError());
+        Environment::GetInstance().Log<LogLevel::Error>(L"Remote control failed to register window class: %5ld", GetLastError());
         return;
     }
 
     _hWnd = CreateWindowExA(0, wc.lpszClassName, nullptr, 0, 0, 0, 0, 0, nullptr, nullptr, wc.hInstance, nullptr);
     if (_hWnd == nullptr) {
-        Environment::GetInstance().Log(L"Remote control Failed to create window: %5ld", GetLastError());
+        Environment::GetInstance().Log<LogLevel::Error>(L"Remote control Failed to create window: %5ld", GetLastError());
         return;
     }
     SetWindowLongPtrW(_hWnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this));
@@ -71,7 +71,7 @@ auto RemoteControl::Run() -> void {
     BOOL msgRet;
     while ((msgRet = GetMessageW(&msg, nullptr, 0, 0)) != 0) {
         if (msgRet == -1) {
-            Environment::GetInstance().Log(L"Remote control message loop error: %5ld", GetLastError());
+            Environment::GetInstance().Log<LogLevel::Error>(L"Remote control message loop error: %5ld", GetLastError());
             break;
         }
 
@@ -80,12 +80,12 @@ auto RemoteControl::Run() -> void {
     }
 
     if (!DestroyWindow(_hWnd)) {
-        Environment::GetInstance().Log(L"Remote control failed to destroy window: %5ld", GetLastError());
+        Environment::GetInstance().Log<LogLevel::Error>(L"Remote control failed to destroy window: %5ld", GetLastError());
         return;
     }
 
     if (!UnregisterClassA(API_WND_CLASS_NAME, wc.hInstance)) {
-        Environment::GetInstance().Log(L"Remote control failed to unregister window class: %5ld", GetLastError());
+        Environment::GetInstance().Log<LogLevel::Error>(L"Remote control failed to unregister window class: %5ld", GetLastError());
         return;
     }
 
@@ -132,6 +132,19 @@ auto RemoteControl::HandleCopyData(HWND hSenderWindow, const COPYDATASTRUCT *cop
         SendString(hSenderWindow, copyData->dwData, JoinStrings(_filter.GetVideoFilterNames(), API_CSV_DELIMITER_STR));
         return TRUE;
 
+    case API_MSG_GET_STAGE_LATENCIES: {
+        std::vector<std::wstring> latencies;
+        for (int stage = 0; stage < NUM_PIPELINE_STAGES; ++stage) {
+            const LatencyHistogram::Summary summary = _filter.frameHandler->GetStageLatency(static_cast<PipelineStage>(stage));
+            for (const int64_t latency : { summary.p50, summary.p95, summary.p99, summary.max }) {
+                latencies.emplace_back(std::to_wstring(latency));
+            }
+        }
+
+        SendString(hSenderWindow, copyData->dwData, JoinStrings(latencies, API_CSV_DELIMITER_STR));
+        return TRUE;
+    }
+
     case API_MSG_GET_INPUT_WIDTH:
         return _filter.GetInputFormat().videoInfo.width;
 
@@ -175,7 +188,7 @@ auto RemoteControl::HandleCopyData(HWND hSenderWindow, const COPYDATASTRUCT *cop
         return FALSE;
 
     case API_MSG_GET_AVS_SOURCE_FILE: {
-        const std::filesystem::path &effectiveScriptPath = FrameServerCommon::GetInstance().GetScriptPath();
+        const std::filesystem::path effectiveScriptPath = FrameServerCommon::GetInstance().GetScriptPath();
         if (effectiveScriptPath.empty()) {
             return FALSE;
         }
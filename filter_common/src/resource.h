@@ -40,7 +40,12 @@
 #define IDC_INPUT_FORMAT_Y416            1212
 #define IDC_INPUT_FORMAT_RGB24           1213
 #define IDC_INPUT_FORMAT_RGB32           1214
-#define IDC_INPUT_FORMAT_END             1215
+#define IDC_INPUT_FORMAT_RGB48           1215
+#define IDC_INPUT_FORMAT_RGB64           1216
+#define IDC_INPUT_FORMAT_Y210            1217
+#define IDC_INPUT_FORMAT_Y216            1218
+#define IDC_INPUT_FORMAT_V210            1219
+#define IDC_INPUT_FORMAT_END             1220
 
 #define IDT_TIMER_STATUS                 2000
 #define IDC_TEXT_FRAME_NUMBER            2001
@@ -51,10 +56,26 @@
 #define IDC_TEXT_FRAME_RATE_VALUE        2006
 #define IDC_TEXT_PAR                     2007
 #define IDC_TEXT_PAR_VALUE               2008
+#define IDC_TEXT_OUTPUT_QUEUE            2009
+#define IDC_TEXT_OUTPUT_QUEUE_VALUE      2010
 #define IDC_TEXT_PATH                    2100
 #define IDC_EDIT_PATH_VALUE              2101
 #define IDC_TEXT_FORMAT                  2102
 #define IDC_TEXT_FORMAT_VALUE            2103
+#define IDC_TEXT_LATENCY_UPSTREAM_WAIT   2200
+#define IDC_TEXT_LATENCY_UPSTREAM_WAIT_VALUE 2201
+#define IDC_TEXT_LATENCY_CREATE_FRAME    2202
+#define IDC_TEXT_LATENCY_CREATE_FRAME_VALUE 2203
+#define IDC_TEXT_LATENCY_GET_FRAME       2204
+#define IDC_TEXT_LATENCY_GET_FRAME_VALUE 2205
+#define IDC_TEXT_LATENCY_WRITE_SAMPLE    2206
+#define IDC_TEXT_LATENCY_WRITE_SAMPLE_VALUE 2207
+#define IDC_TEXT_LATENCY_DELIVERY_BUFFER 2208
+#define IDC_TEXT_LATENCY_DELIVERY_BUFFER_VALUE 2209
+#define IDC_TEXT_LATENCY_DELIVER         2210
+#define IDC_TEXT_LATENCY_DELIVER_VALUE   2211
+#define IDC_TEXT_LATENCY_FIRST_FRAME     2212
+#define IDC_TEXT_LATENCY_FIRST_FRAME_VALUE 2213
 
 // Next default values for new objects
 //
@@ -12,6 +12,7 @@ namespace SynthFilter {
  * This class is thread-safe, if:
  *   1. all Create() happen before all GetInstance();
  *   2. all Destroy() happen after all GetInstance();
+ *   3. the instance replaced by Replace() is kept alive until no caller of GetInstance() could still be using it.
  */
 template <typename T>
 class OnDemandSingleton {
@@ -30,6 +31,11 @@ public:
         return *_instance;
     }
 
+    // returns the previous instance, whose ownership is transferred to the caller
+    static constexpr auto Replace(T *newInstance) -> T * {
+        return _instance.exchange(newInstance);
+    }
+
     static constexpr auto Destroy() -> void {
         delete _instance;
         _instance = nullptr;
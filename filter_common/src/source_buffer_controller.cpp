@@ -0,0 +1,84 @@
+// License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
+
+#include "source_buffer_controller.h"
+
+#include "constants.h"
+#include "environment.h"
+
+
+namespace SynthFilter {
+
+auto SourceBufferController::Reset() -> void {
+    const std::unique_lock lock(_mutex);
+
+    _scriptLatency = {};
+    _decoderLatency = {};
+    _lastChangeTime = {};
+}
+
+auto SourceBufferController::RecordScriptLatency(std::chrono::steady_clock::duration latency) -> void {
+    const std::unique_lock lock(_mutex);
+
+    _scriptLatency.Add(latency);
+}
+
+auto SourceBufferController::RecordDecoderLatency(std::chrono::steady_clock::duration latency) -> void {
+    const std::unique_lock lock(_mutex);
+
+    _decoderLatency.Add(latency);
+}
+
+auto SourceBufferController::Update(int currentExtraSrcBuffer, int numBaseSrcFrames, REFERENCE_TIME sourceFrameDuration, int64_t sourceFrameSize) -> int {
+    Environment &env = Environment::GetInstance();
+    const std::chrono::steady_clock::time_point currentTime = std::chrono::steady_clock::now();
+    const std::unique_lock lock(_mutex);
+
+    const double leadTime = env.GetSrcBufferLeadTime() * 1000.0 + _scriptLatency.mean + SRC_BUFFER_JITTER_MULTIPLIER * (_scriptLatency.deviation + _decoderLatency.deviation);
+
+    int maxExtraSrcBuffer = env.GetMaxExtraSrcBuffer();
+    if (const int64_t memoryBudget = static_cast<int64_t>(env.GetMaxSrcBufferMemory()) * 1024 * 1024; memoryBudget > 0 && sourceFrameSize > 0) {
+        maxExtraSrcBuffer = std::clamp(static_cast<int>(memoryBudget / sourceFrameSize) - numBaseSrcFrames, env.GetMinExtraSrcBuffer(), maxExtraSrcBuffer);
+    }
+
+    // REFERENCE_TIME is in 100 nanoseconds
+    const int targetExtraSrcBuffer = std::clamp(static_cast<int>(std::ceil(leadTime * 10 / std::max(sourceFrameDuration, 1LL))) - numBaseSrcFrames,
+                                                env.GetMinExtraSrcBuffer(),
+                                                maxExtraSrcBuffer);
+
+    // the memory budget is a hard limit
+    if (currentExtraSrcBuffer > maxExtraSrcBuffer) {
+        _lastChangeTime = currentTime;
+        return maxExtraSrcBuffer;
+    }
+
+    if (targetExtraSrcBuffer > currentExtraSrcBuffer) {
+        env.Log<LogLevel::Trace>(L"Grow extra source buffer to %2d for lead time %10.3f ms", targetExtraSrcBuffer, leadTime / 1000);
+        _lastChangeTime = currentTime;
+        return targetExtraSrcBuffer;
+    }
+
+    if (targetExtraSrcBuffer < currentExtraSrcBuffer && currentTime - _lastChangeTime >= SRC_BUFFER_SHRINK_INTERVAL) {
+        env.Log<LogLevel::Trace>(L"Shrink extra source buffer to %2d for lead time %10.3f ms", currentExtraSrcBuffer - 1, leadTime / 1000);
+        _lastChangeTime = currentTime;
+        return currentExtraSrcBuffer - 1;
+    }
+
+    return currentExtraSrcBuffer;
+}
+
+auto SourceBufferController::LatencyEstimator::Add(std::chrono::steady_clock::duration latency) -> void {
+    const double value = std::chrono::duration<double, std::micro>(latency).count();
+
+    // same initialization and gains as the RTT estimation of TCP in RFC 6298
+    if (!hasSample) {
+        mean = value;
+        deviation = value / 2;
+        hasSample = true;
+        return;
+    }
+
+    deviation += (std::abs(value - mean) - deviation) / 4;
+    mean += (value - mean) / 8;
+}
+
+}
@@ -0,0 +1,53 @@
+// License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
+
+#pragma once
+
+#include "macros.h"
+
+
+namespace SynthFilter {
+
+/*
+ * Decides how many extra source frames to buffer, so that the buffered frames cover a lead time ahead of the script.
+ *
+ * The lead time is the configured target, plus the average time for the script to return a frame, plus a margin for the jitter
+ * of the script and the decoder. Like the retransmission timeout of TCP, each latency is tracked by the exponentially weighted
+ * moving averages of its mean and mean deviation, and the margin is a multiple of the deviations.
+ *
+ * To avoid oscillation, the buffer grows at once, but only shrinks by one frame per SRC_BUFFER_SHRINK_INTERVAL.
+ * The result is limited by the memory budget of the buffered frames, then bounded by the min and max extra source buffer settings.
+ */
+class SourceBufferController {
+public:
+    SourceBufferController() = default;
+
+    DISABLE_COPYING(SourceBufferController)
+
+    auto Reset() -> void;
+
+    // called by any thread that gets a frame from the script
+    auto RecordScriptLatency(std::chrono::steady_clock::duration latency) -> void;
+
+    // called by the receiving thread, with the time the upstream takes from the return of the previous sample to the next one
+    auto RecordDecoderLatency(std::chrono::steady_clock::duration latency) -> void;
+
+    // returns the new number of extra source frames. numBaseSrcFrames are always buffered on top of them
+    auto Update(int currentExtraSrcBuffer, int numBaseSrcFrames, REFERENCE_TIME sourceFrameDuration, int64_t sourceFrameSize) -> int;
+
+private:
+    struct LatencyEstimator {
+        auto Add(std::chrono::steady_clock::duration latency) -> void;
+
+        // in microseconds
+        double mean = 0;
+        double deviation = 0;
+        bool hasSample = false;
+    };
+
+    std::mutex _mutex;
+    LatencyEstimator _scriptLatency;
+    LatencyEstimator _decoderLatency;
+    std::chrono::steady_clock::time_point _lastChangeTime;
+};
+
+}
@@ -0,0 +1,197 @@
+// License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
+
+#pragma once
+
+#include "constants.h"
+#include "macros.h"
+
+
+namespace SynthFilter {
+
+/*
+ * Fixed capacity queue of source frames, indexed by the consecutive frame numbers.
+ *
+ * There is one producer that pushes the frames in order, one collector that erases them in order, and any number of readers.
+ * Frames in [head, tail) are stored. Pushing and erasing only move the atomic tail and head, without allocation or lock.
+ *
+ * A reader pins the slot of the frame while reading, so that the collector waits for it before destroying the entry.
+ * The producer and the collector may access their own frames without pinning, since only the collector destroys entries.
+ *
+ * The head moves before the erased slot is drained of its readers and reset. The reclaimed frame number only moves after that,
+ * so the producer checks the capacity against it, never reusing a slot that is still being erased.
+ *
+ * Waiting uses an event count. Every change to the queue, as well as NotifyAll(), bumps the count and wakes up the waiters,
+ * who then re-evaluate their conditions.
+ */
+template <typename T>
+class SourceFrameRing {
+public:
+    SourceFrameRing() = default;
+
+    DISABLE_COPYING(SourceFrameRing)
+
+    auto GetHeadFrameNb() const -> int { return _headFrameNb.load(std::memory_order_acquire); }
+    auto GetTailFrameNb() const -> int { return _tailFrameNb.load(std::memory_order_acquire); }
+    // all slots of the frames before it are reset and can be reused by the producer
+    auto GetReclaimedFrameNb() const -> int { return _reclaimedFrameNb.load(std::memory_order_acquire); }
+
+    auto GetSize() const -> int {
+        // the head never passes the tail, so loading the head first keeps the size non-negative
+        const int headFrameNb = GetHeadFrameNb();
+        return GetTailFrameNb() - headFrameNb;
+    }
+
+    // only called by the producer, after making sure the queue is not full
+    template <typename... Args>
+    auto Push(Args &&...args) -> int {
+        const int frameNb = _tailFrameNb.load(std::memory_order_relaxed);
+        ASSERT(frameNb - GetReclaimedFrameNb() < static_cast<int>(SOURCE_FRAME_RING_CAPACITY));
+
+        Slot &slot = GetSlot(frameNb);
+        slot.entry.emplace(std::forward<Args>(args)...);
+        slot.frameNb.store(frameNb, std::memory_order_release);
+        _tailFrameNb.store(frameNb + 1, std::memory_order_seq_cst);
+
+        NotifyAll();
+        return frameNb;
+    }
+
+    // only called by the producer or the collector, for a frame in [head, tail) that the collector will not erase meanwhile
+    auto At(int frameNb) -> T & {
+        ASSERT(GetSlot(frameNb).frameNb == frameNb);
+
+        return *GetSlot(frameNb).entry;
+    }
+
+    /*
+     * Calls reader with the first stored frame at or after frameNb, which is how std::map::lower_bound() finds it.
+     * The frame stays alive during the call even if it is erased concurrently.
+     * Returns the result of reader, or false if there is no such frame.
+     */
+    template <typename Reader>
+    auto ReadLowerBound(int frameNb, Reader reader) -> bool {
+        while (true) {
+            const int targetFrameNb = std::max(frameNb, _headFrameNb.load(std::memory_order_seq_cst));
+            if (targetFrameNb >= _tailFrameNb.load(std::memory_order_seq_cst)) {
+                return false;
+            }
+
+            Slot &slot = GetSlot(targetFrameNb);
+            slot.numReaders.fetch_add(1, std::memory_order_seq_cst);
+
+            // the collector unpublishes a frame by moving the head before checking the readers of its slot
+            // thus if the head still covers the frame, the collector will see the pin and wait
+            const bool isPinned = slot.frameNb.load(std::memory_order_seq_cst) == targetFrameNb && targetFrameNb >= _headFrameNb.load(std::memory_order_seq_cst);
+            const bool ret = isPinned && reader(targetFrameNb, static_cast<const T &>(*slot.entry));
+
+            if (slot.numReaders.fetch_sub(1, std::memory_order_seq_cst) == 1) {
+                slot.numReaders.notify_all();
+            }
+
+            if (isPinned) {
+                return ret;
+            }
+
+            // the frame is erased after the head is loaded. Retry with the new head
+        }
+    }
+
+    // only called by the collector. Erases all frames up to and including frameNb
+    auto EraseUntil(int frameNb) -> void {
+        const int headFrameNb = _headFrameNb.load(std::memory_order_relaxed);
+        const int newHeadFrameNb = std::min(frameNb + 1, _tailFrameNb.load(std::memory_order_acquire));
+
+        for (int erasingFrameNb = headFrameNb; erasingFrameNb < newHeadFrameNb; ++erasingFrameNb) {
+            _headFrameNb.store(erasingFrameNb + 1, std::memory_order_seq_cst);
+
+            Slot &slot = GetSlot(erasingFrameNb);
+            for (int numReaders = slot.numReaders.load(std::memory_order_seq_cst); numReaders != 0; numReaders = slot.numReaders.load(std::memory_order_seq_cst)) {
+                slot.numReaders.wait(numReaders);
+            }
+
+            slot.frameNb.store(-1, std::memory_order_relaxed);
+            slot.entry.reset();
+            _reclaimedFrameNb.store(erasingFrameNb + 1, std::memory_order_release);
+        }
+
+        if (newHeadFrameNb > headFrameNb) {
+            NotifyAll();
+        }
+    }
+
+    // only called when no other thread is accessing the queue. The next pushed frame is numbered firstFrameNb
+    auto Clear(int firstFrameNb = 0) -> void {
+        for (Slot &slot : _slots) {
+            slot.frameNb.store(-1, std::memory_order_relaxed);
+            slot.entry.reset();
+        }
+
+        _headFrameNb = firstFrameNb;
+        _tailFrameNb = firstFrameNb;
+        _reclaimedFrameNb = firstFrameNb;
+        NotifyAll();
+    }
+
+    // blocks until predicate returns true. predicate is re-evaluated after every change to the queue and every NotifyAll()
+    template <typename Predicate>
+    auto WaitUntil(Predicate predicate) const -> void {
+        while (true) {
+            const uint32_t eventCount = LoadEventCount();
+            if (predicate()) {
+                break;
+            }
+
+            WaitForEvent(eventCount);
+        }
+    }
+
+    // same as above, except that heldLock is released while blocking, like std::condition_variable_any::wait() does
+    template <typename Predicate>
+    auto WaitUntil(CCritSec &heldLock, Predicate predicate) const -> void {
+        while (true) {
+            const uint32_t eventCount = LoadEventCount();
+            if (predicate()) {
+                break;
+            }
+
+            heldLock.Unlock();
+            WaitForEvent(eventCount);
+            heldLock.Lock();
+        }
+    }
+
+    auto NotifyAll() -> void {
+        _eventCount.fetch_add(1, std::memory_order_seq_cst);
+        _eventCount.notify_all();
+    }
+
+private:
+    static_assert(std::has_single_bit(SOURCE_FRAME_RING_CAPACITY), "Capacity must be power of 2 for cheap indexing");
+
+    struct Slot {
+        std::atomic<int> frameNb = -1;
+        std::atomic<int> numReaders = 0;
+        std::optional<T> entry;
+    };
+
+    auto LoadEventCount() const -> uint32_t {
+        return _eventCount.load(std::memory_order_seq_cst);
+    }
+
+    auto WaitForEvent(uint32_t eventCount) const -> void {
+        _eventCount.wait(eventCount, std::memory_order_seq_cst);
+    }
+
+    constexpr auto GetSlot(int frameNb) -> Slot & {
+        return _slots[static_cast<size_t>(frameNb) & (SOURCE_FRAME_RING_CAPACITY - 1)];
+    }
+
+    std::array<Slot, SOURCE_FRAME_RING_CAPACITY> _slots;
+
+    alignas(std::hardware_destructive_interference_size) std::atomic<int> _headFrameNb = 0;
+    alignas(std::hardware_destructive_interference_size) std::atomic<int> _tailFrameNb = 0;
+    alignas(std::hardware_destructive_interference_size) std::atomic<int> _reclaimedFrameNb = 0;
+    alignas(std::hardware_destructive_interference_size) std::atomic<uint32_t> _eventCount = 0;
+};
+
+}
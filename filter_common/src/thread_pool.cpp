@@ -0,0 +1,109 @@
+// License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
+
+#include "thread_pool.h"
+
+#include "environment.h"
+
+
+namespace SynthFilter {
+
+ThreadPool::ThreadPool() {
+    const int numThreads = Environment::GetInstance().GetConversionThreads();
+
+    for (int i = 1; i < numThreads; ++i) {
+        _workerThreads.emplace_back(&ThreadPool::WorkerProc, this);
+    }
+
+    Environment::GetInstance().Log(L"Thread pool size: %d", numThreads);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        const std::unique_lock batchLock(_batchMutex);
+        _isStopping = true;
+    }
+    _newBatchCv.notify_all();
+
+    for (std::thread &workerThread : _workerThreads) {
+        workerThread.join();
+    }
+}
+
+auto ThreadPool::Run(int numJobs, const std::function<void(int)> &jobFunc) -> void {
+    const std::unique_lock runLock(_runMutex, std::try_to_lock);
+
+    if (!runLock.owns_lock() || _workerThreads.empty() || numJobs <= 1) {
+        for (int i = 0; i < numJobs; ++i) {
+            jobFunc(i);
+        }
+        return;
+    }
+
+    {
+        std::unique_lock batchLock(_batchMutex);
+
+        // workers that woke up late for the previous batch may still be holding its states
+        _workersIdleCv.wait(batchLock, [this]() -> bool {
+            return _numActiveWorkers == 0;
+        });
+
+        _jobFunc = &jobFunc;
+        _numJobs = numJobs;
+        _nextJobIndex = 0;
+        _batchId += 1;
+    }
+    _newBatchCv.notify_all();
+
+    RunJobs(jobFunc, numJobs);
+
+    // every job has been claimed at this point. Each worker finishes its claimed jobs before leaving the batch
+    std::unique_lock batchLock(_batchMutex);
+    _workersIdleCv.wait(batchLock, [this]() -> bool {
+        return _numActiveWorkers == 0;
+    });
+}
+
+auto ThreadPool::WorkerProc() -> void {
+#ifdef _DEBUG
+    SetThreadDescription(GetCurrentThread(), L"CSynthFilter Thread Pool Worker");
+#endif
+
+    uint64_t lastBatchId = 0;
+
+    while (true) {
+        const std::function<void(int)> *jobFunc;
+        int numJobs;
+
+        {
+            std::unique_lock batchLock(_batchMutex);
+            _newBatchCv.wait(batchLock, [this, lastBatchId]() -> bool {
+                return _isStopping || _batchId != lastBatchId;
+            });
+
+            if (_isStopping) {
+                break;
+            }
+
+            lastBatchId = _batchId;
+            jobFunc = _jobFunc;
+            numJobs = _numJobs;
+            _numActiveWorkers += 1;
+        }
+
+        RunJobs(*jobFunc, numJobs);
+
+        {
+            const std::unique_lock batchLock(_batchMutex);
+            _numActiveWorkers -= 1;
+        }
+        _workersIdleCv.notify_all();
+    }
+}
+
+auto ThreadPool::RunJobs(const std::function<void(int)> &jobFunc, int numJobs) -> void {
+    for (int jobIndex = _nextJobIndex++; jobIndex < numJobs; jobIndex = _nextJobIndex++) {
+        jobFunc(jobIndex);
+    }
+}
+
+}
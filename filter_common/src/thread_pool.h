@@ -0,0 +1,55 @@
+// License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
+
+#pragma once
+
+#include "macros.h"
+#include "singleton.h"
+
+
+namespace SynthFilter {
+
+/*
+ * Persistent worker threads to split CPU heavy work, such as the frame conversions, across cores.
+ * Threads are created once and sleep between jobs, so that dispatching a frame does not pay for the thread creation.
+ */
+class ThreadPool : public OnDemandSingleton<ThreadPool> {
+public:
+    ThreadPool();
+    ~ThreadPool();
+
+    DISABLE_COPYING(ThreadPool)
+
+    // number of threads working on a batch of jobs, including the calling thread
+    constexpr auto GetNumThreads() const -> int { return static_cast<int>(_workerThreads.size()) + 1; }
+
+    /*
+     * Call jobFunc(jobIndex) for each jobIndex in [0, numJobs) and wait for all of them to finish.
+     * The calling thread works on the jobs too.
+     *
+     * If another thread is already running a batch in the pool, the jobs are run on the calling thread instead of waiting for the pool.
+     * This keeps the input and output conversions from blocking each other.
+     */
+    auto Run(int numJobs, const std::function<void(int)> &jobFunc) -> void;
+
+private:
+    auto WorkerProc() -> void;
+    auto RunJobs(const std::function<void(int)> &jobFunc, int numJobs) -> void;
+
+    std::vector<std::thread> _workerThreads;
+
+    std::mutex _runMutex;
+    std::mutex _batchMutex;
+    std::condition_variable _newBatchCv;
+    std::condition_variable _workersIdleCv;
+
+    // batch states below are protected by _batchMutex, and only change when no worker is active
+    const std::function<void(int)> *_jobFunc = nullptr;
+    int _numJobs = 0;
+    uint64_t _batchId = 0;
+    int _numActiveWorkers = 0;
+    bool _isStopping = false;
+
+    std::atomic<int> _nextJobIndex = 0;
+};
+
+}
@@ -10,7 +10,7 @@
 namespace SynthFilter {
 
 // for each group of formats with the same format ID, they should appear with the most preferred -> least preferred order
-// VapourSynth does not support any interleaved format such as YUY2 or RGB
+// VapourSynth does not support any interleaved format such as YUY2 or RGB, so they are unpacked into separate planes
 const std::vector<Format::PixelFormat> Format::PIXEL_FORMATS {
     // 4:2:0
     { .name = L"NV12",  .mediaSubtype = MEDIASUBTYPE_NV12,  .frameServerFormatId = pfYUV420P8,  .bitCount = 12, .componentsPerPixel = 1, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 2,  .srcPlanesLayout = PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED, .resourceId = IDC_INPUT_FORMAT_NV12 },
@@ -24,8 +24,14 @@ const std::vector<Format::PixelFormat> Format::PIXEL_FORMATS {
     { .name = L"P016",  .mediaSubtype = MEDIASUBTYPE_P016,  .frameServerFormatId = pfYUV420P16, .bitCount = 24, .componentsPerPixel = 1, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 2,  .srcPlanesLayout = PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED, .resourceId = IDC_INPUT_FORMAT_P016 },
 
     // 4:2:2
+    { .name = L"YUY2",  .mediaSubtype = MEDIASUBTYPE_YUY2,  .frameServerFormatId = pfYUV422P8,  .bitCount = 16, .componentsPerPixel = 2, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_YUY2 },
     { .name = L"P210",  .mediaSubtype = MEDIASUBTYPE_P210,  .frameServerFormatId = pfYUV422P10, .bitCount = 32, .componentsPerPixel = 1, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED, .resourceId = IDC_INPUT_FORMAT_P210 },
     { .name = L"P216",  .mediaSubtype = MEDIASUBTYPE_P216,  .frameServerFormatId = pfYUV422P16, .bitCount = 32, .componentsPerPixel = 1, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED, .resourceId = IDC_INPUT_FORMAT_P216 },
+    // Y210 and Y216 interleave Y and UV planes together like YUY2. Y210 has the least significant 6 bits zero-padded like P010
+    { .name = L"Y210",  .mediaSubtype = MEDIASUBTYPE_Y210,  .frameServerFormatId = pfYUV422P10, .bitCount = 32, .componentsPerPixel = 2, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_Y210 },
+    { .name = L"Y216",  .mediaSubtype = MEDIASUBTYPE_Y216,  .frameServerFormatId = pfYUV422P16, .bitCount = 32, .componentsPerPixel = 2, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_Y216 },
+    // v210 packs three 10-bit components in each 32-bit integer, with each row padded to 48 pixels. bitCount is 20 by convention, not the actual size
+    { .name = L"v210",  .mediaSubtype = MEDIASUBTYPE_v210,  .frameServerFormatId = pfYUV422P10, .bitCount = 20, .componentsPerPixel = 2, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_V210 },
 
     // 4:4:4
     { .name = L"YV24",  .mediaSubtype = MEDIASUBTYPE_YV24,  .frameServerFormatId = pfYUV444P8,  .bitCount = 24, .componentsPerPixel = 1, .subsampleWidthRatio = 1,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_SEPARATE,           .resourceId = IDC_INPUT_FORMAT_YV24 },
@@ -33,7 +39,12 @@ const std::vector<Format::PixelFormat> Format::PIXEL_FORMATS {
     { .name = L"Y410",  .mediaSubtype = MEDIASUBTYPE_Y410,  .frameServerFormatId = pfYUV444P10, .bitCount = 32, .componentsPerPixel = 4, .subsampleWidthRatio = 1,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_Y410 },
     { .name = L"Y416",  .mediaSubtype = MEDIASUBTYPE_Y416,  .frameServerFormatId = pfYUV444P16, .bitCount = 64, .componentsPerPixel = 4, .subsampleWidthRatio = 1,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_Y416 },
 
+    // RGB24 and RGB32 are in B-G-R pixel order, the reverse of the planes of VapourSynth
+    { .name = L"RGB24", .mediaSubtype = MEDIASUBTYPE_RGB24, .frameServerFormatId = pfRGB24,     .bitCount = 24, .componentsPerPixel = 3, .subsampleWidthRatio = -1, .subsampleHeightRatio = -1, .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_RGB24 },
     { .name = L"RGB32", .mediaSubtype = MEDIASUBTYPE_RGB32, .frameServerFormatId = pfRGB24,     .bitCount = 32, .componentsPerPixel = 4, .subsampleWidthRatio = -1, .subsampleHeightRatio = -1, .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_RGB32 },
+    // RGB48 and RGB64 from LAV Filters are in R-G-B pixel order, the same as the planes of VapourSynth. Like Y41x, the alpha of RGB64 is ignored
+    { .name = L"RGB48", .mediaSubtype = MEDIASUBTYPE_RGB48, .frameServerFormatId = pfRGB48,     .bitCount = 48, .componentsPerPixel = 3, .subsampleWidthRatio = -1, .subsampleHeightRatio = -1, .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_RGB48 },
+    { .name = L"RGB64", .mediaSubtype = MEDIASUBTYPE_RGB64, .frameServerFormatId = pfRGB48,     .bitCount = 64, .componentsPerPixel = 4, .subsampleWidthRatio = -1, .subsampleHeightRatio = -1, .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_RGB64 },
 };
 
 auto Format::GetVideoFormat(const AM_MEDIA_TYPE &mediaType, const FrameServerBase *frameServerInstance) -> VideoFormat {
@@ -55,7 +66,6 @@ auto Format::GetVideoFormat(const AM_MEDIA_TYPE &mediaType, const FrameServerBas
         .frameServerCore = frameServerInstance->GetVsCore(),
     };
     AVSF_VPS_API->getVideoFormatByID(&ret.videoInfo.format, ret.pixelFormat->frameServerFormatId, ret.frameServerCore);
-    ret.outputBufferTemporalFlags = ret.pixelFormat->srcPlanesLayout == PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED && ret.videoInfo.format.bitsPerSample == 10;
 
     if (SUCCEEDED(CheckVideoInfo2Type(&mediaType))) {
         const VIDEOINFOHEADER2 *vih2 = reinterpret_cast<VIDEOINFOHEADER2 *>(mediaType.pbFormat);
@@ -76,6 +86,8 @@ auto Format::GetVideoFormat(const AM_MEDIA_TYPE &mediaType, const FrameServerBas
         }
     }
 
+    ret.conversionPlan = CreateConversionPlan(ret);
+
     return ret;
 }
 
@@ -87,7 +99,9 @@ auto Format::WriteSample(const VideoFormat &videoFormat, const VSFrame *srcFrame
         srcStrides[i] = static_cast<int>(AVSF_VPS_API->getStride(srcFrame, i));
     }
 
-    CopyToOutput(videoFormat, srcSlices, srcStrides, dstBuffer, AVSF_VPS_API->getFrameWidth(srcFrame, 0), AVSF_VPS_API->getFrameHeight(srcFrame, 0));
+    ASSERT(AVSF_VPS_API->getFrameHeight(srcFrame, 0) == videoFormat.conversionPlan.height);
+
+    CopyToOutput(videoFormat, srcSlices, srcStrides, dstBuffer);
 }
 
 auto Format::CreateFrame(const VideoFormat &videoFormat, const BYTE *srcBuffer) -> VSFrame * {
@@ -100,179 +114,139 @@ auto Format::CreateFrame(const VideoFormat &videoFormat, const BYTE *srcBuffer)
         dstStrides[i] = static_cast<int>(AVSF_VPS_API->getStride(newFrame, i));
     }
 
-    CopyFromInput(videoFormat, srcBuffer, dstSlices, dstStrides, AVSF_VPS_API->getFrameWidth(newFrame, 0), AVSF_VPS_API->getFrameHeight(newFrame, 0));
+    CopyFromInput(videoFormat, srcBuffer, dstSlices, dstStrides);
 
     return newFrame;
 }
 
-auto Format::CopyFromInput(const VideoFormat &videoFormat, const BYTE *srcBuffer, const std::array<BYTE *, 3> &dstSlices, const std::array<int, 3> &dstStrides, int frameWidth, int height) -> void {
-    int srcMainPlaneRowSize = frameWidth * videoFormat.videoInfo.format.bytesPerSample;
-    if (videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::ALL_PLANES_INTERLEAVED) {
-        srcMainPlaneRowSize *= videoFormat.pixelFormat->componentsPerPixel;
-    }
+auto Format::CreateConversionPlan(const VideoFormat &videoFormat) -> ConversionPlan {
+    const PixelFormat &pixelFormat = *videoFormat.pixelFormat;
+    const int bytesPerSample = videoFormat.videoInfo.format.bytesPerSample;
 
-    // bmi.biWidth should be "set equal to the surface stride in pixels" according to the doc of BITMAPINFOHEADER
-    int srcMainPlaneStride = videoFormat.bmi.biWidth * videoFormat.videoInfo.format.bytesPerSample * videoFormat.pixelFormat->componentsPerPixel;
-    ASSERT(srcMainPlaneRowSize <= srcMainPlaneStride);
-    ASSERT(height == abs(videoFormat.bmi.biHeight));
-    const int srcMainPlaneSize = srcMainPlaneStride * height;
-    const BYTE *srcMainPlane = srcBuffer;
-    const int srcUVHeight = height / videoFormat.pixelFormat->subsampleHeightRatio;
+    ConversionPlan plan {
+        .height = videoFormat.videoInfo.height,
+        .secPlaneHeightRatio = std::max(pixelFormat.subsampleHeightRatio, 1),
+    };
+    plan.bandHeight = GetBandHeight(videoFormat.bmi, plan.height, plan.secPlaneHeightRatio);
+
+    // interleaved formats store all components of a pixel in the main plane
+    const int mainPlaneBytesPerPixel = pixelFormat.srcPlanesLayout == PlanesLayout::ALL_PLANES_INTERLEAVED ? pixelFormat.bitCount / 8 : bytesPerSample;
+    if (pixelFormat.mediaSubtype == MEDIASUBTYPE_v210) {
+        // v210 takes 16 bytes for every 6 pixels, and pads each row to 48 pixels
+        plan.mainPlaneStride = DivideRoundUp(videoFormat.bmi.biWidth, 48) * 128;
+        plan.mainPlaneRowSize = DivideRoundUp(videoFormat.videoInfo.width * 8, 3);
+    } else {
+        // bmi.biWidth should be "set equal to the surface stride in pixels" according to the doc of BITMAPINFOHEADER
+        plan.mainPlaneStride = videoFormat.bmi.biWidth * mainPlaneBytesPerPixel;
+        plan.mainPlaneRowSize = videoFormat.videoInfo.width * mainPlaneBytesPerPixel;
+    }
+    ASSERT(plan.mainPlaneRowSize <= plan.mainPlaneStride);
+    const int mainPlaneSize = plan.mainPlaneStride * plan.height;
 
     // for RGB DIB in Windows (biCompression == BI_RGB), positive biHeight is bottom-up, negative is top-down
     // VapourSynth's zimg assumes the input DIB being top-down, so we invert the DIB if needed
     if (videoFormat.bmi.biCompression == BI_RGB && videoFormat.bmi.biHeight > 0) {
-        srcMainPlane += srcMainPlaneSize - srcMainPlaneStride;
-        srcMainPlaneStride = -srcMainPlaneStride;
+        plan.mainPlaneOffset = static_cast<ptrdiff_t>(mainPlaneSize) - plan.mainPlaneStride;
+        plan.mainPlaneStride = -plan.mainPlaneStride;
     }
 
-    if (videoFormat.pixelFormat->srcPlanesLayout != PlanesLayout::ALL_PLANES_INTERLEAVED) {
-        vsh::bitblt(dstSlices[0], dstStrides[0], srcMainPlane, srcMainPlaneStride, srcMainPlaneRowSize, height);
-    }
+    // P010 and P210 have their bits shifted while being copied
+    const bool isBitShiftNeeded = pixelFormat.srcPlanesLayout == PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED && videoFormat.videoInfo.format.bitsPerSample == 10;
+    plan.mainPlaneInputFunc = isBitShiftNeeded ? _rightShiftFunc : GetCopyPlaneFunc(mainPlaneSize);
+    plan.mainPlaneOutputFunc = isBitShiftNeeded ? _leftShiftFunc : GetCopyPlaneFunc(mainPlaneSize);
 
-    switch (videoFormat.pixelFormat->srcPlanesLayout) {
+    switch (pixelFormat.srcPlanesLayout) {
     case PlanesLayout::ALL_PLANES_INTERLEAVED:
-        if (videoFormat.videoInfo.format.colorFamily == cfYUV) {
-            const std::array yuvaSlices { dstSlices[1], dstSlices[0], dstSlices[2] };
-            const std::array yuvaStrides { dstStrides[1], dstStrides[0], dstStrides[2] };
+        // VapourSynth has no interleaved format, so every component is unpacked into its own plane
+        if (pixelFormat.mediaSubtype == MEDIASUBTYPE_YUY2) {
+            plan.deinterleaveFunc = _deinterleaveYUY2Func;
+            plan.interleaveThreeFunc = _interleaveYUY2Func;
+        } else if (pixelFormat.mediaSubtype == MEDIASUBTYPE_Y210) {
+            plan.deinterleaveFunc = _deinterleaveY210Func;
+            plan.interleaveThreeFunc = _interleaveY210Func;
+        } else if (pixelFormat.mediaSubtype == MEDIASUBTYPE_Y216) {
+            plan.deinterleaveFunc = _deinterleaveY216Func;
+            plan.interleaveThreeFunc = _interleaveY216Func;
+        } else if (pixelFormat.mediaSubtype == MEDIASUBTYPE_v210) {
+            plan.deinterleaveFunc = _deinterleaveV210Func;
+            plan.interleaveThreeFunc = _interleaveV210Func;
+        } else if (videoFormat.videoInfo.format.colorFamily == cfYUV) {
+            plan.componentPlanes = { 1, 0, 2 };
 
             if (videoFormat.videoInfo.format.bitsPerSample == 10) {
-                DeinterleaveY410(srcMainPlane, srcMainPlaneStride / 2, yuvaSlices, yuvaStrides, srcMainPlaneRowSize / 2, height);
+                plan.deinterleaveFunc = _deinterleaveY410Func;
+                plan.interleaveThreeFunc = _interleaveY410Func;
             } else {
-                _deinterleaveY416Func(srcMainPlane, srcMainPlaneStride, yuvaSlices, yuvaStrides, srcMainPlaneRowSize, height);
+                plan.deinterleaveFunc = _deinterleaveY416Func;
+                plan.interleaveThreeFunc = _interleaveY416Func;
             }
-        } else {
-            _deinterleaveRGBC1Func(srcMainPlane, srcMainPlaneStride, dstSlices, dstStrides, srcMainPlaneRowSize, height);
-        }
-        break;
-
-    case PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED: {
-        const BYTE *srcUVStart = srcMainPlane + srcMainPlaneSize;
-        const int srcUVStride = srcMainPlaneStride * 2 / videoFormat.pixelFormat->subsampleWidthRatio;
-        const int srcUVRowSize = srcMainPlaneRowSize * 2 / videoFormat.pixelFormat->subsampleWidthRatio;
-
-        decltype(Deinterleave<0, 1, 2, 2, 1>) *deinterleaveUVFunc;
-        if (videoFormat.videoInfo.format.bytesPerSample == 1) {
-            deinterleaveUVFunc = _deinterleaveUVC1Func;
-        } else {
-            deinterleaveUVFunc = _deinterleaveUVC2Func;
-        }
-        deinterleaveUVFunc(srcUVStart, srcUVStride, { dstSlices[1], dstSlices[2] }, { dstStrides[1], dstStrides[2] }, srcUVRowSize, srcUVHeight);
-
-        if (videoFormat.videoInfo.format.bitsPerSample == 10) {
-            _rightShiftFunc(dstSlices[0], dstSlices[0], dstStrides[0], srcMainPlaneRowSize, height);
-            _rightShiftFunc(dstSlices[1], dstSlices[1], dstStrides[1], srcUVRowSize / 2, srcUVHeight);
-            _rightShiftFunc(dstSlices[2], dstSlices[2], dstStrides[2], srcUVRowSize / 2, srcUVHeight);
-        }
-    } break;
-
-    case PlanesLayout::ALL_PLANES_SEPARATE: {
-        const int srcUVStride = srcMainPlaneStride / videoFormat.pixelFormat->subsampleWidthRatio;
-        const int srcUVRowSize = srcMainPlaneRowSize / videoFormat.pixelFormat->subsampleWidthRatio;
-        const BYTE *srcUVPlane1 = srcMainPlane + srcMainPlaneSize;
-        const BYTE *srcUVPlane2 = srcUVPlane1 + srcMainPlaneSize / (videoFormat.pixelFormat->subsampleWidthRatio * videoFormat.pixelFormat->subsampleHeightRatio);
-
-        const BYTE *srcU;
-        const BYTE *srcV;
-        if (videoFormat.pixelFormat->mediaSubtype == MEDIASUBTYPE_YV12 || videoFormat.pixelFormat->mediaSubtype == MEDIASUBTYPE_YV24) {
-            // YVxx has V plane first
-            srcU = srcUVPlane2;
-            srcV = srcUVPlane1;
-        } else {
-            srcU = srcUVPlane1;
-            srcV = srcUVPlane2;
-        }
-
-        vsh::bitblt(dstSlices[1], dstStrides[1], srcU, srcUVStride, srcUVRowSize, srcUVHeight);
-        vsh::bitblt(dstSlices[2], dstStrides[2], srcV, srcUVStride, srcUVRowSize, srcUVHeight);
-    } break;
-    }
-}
+        } else if (videoFormat.videoInfo.format.bitsPerSample == 8) {
+            plan.componentPlanes = { 2, 1, 0 };
 
-auto Format::CopyToOutput(const VideoFormat &videoFormat, const std::array<const BYTE *, 3> &srcSlices, const std::array<int, 3> &srcStrides, BYTE *dstBuffer, int frameWidth, int height) -> void {
-    int dstMainPlaneRowSize = frameWidth * videoFormat.videoInfo.format.bytesPerSample;
-    if (videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::ALL_PLANES_INTERLEAVED) {
-        dstMainPlaneRowSize *= videoFormat.pixelFormat->componentsPerPixel;
-    }
-
-    int dstMainPlaneStride = videoFormat.bmi.biWidth * videoFormat.videoInfo.format.bytesPerSample * videoFormat.pixelFormat->componentsPerPixel;
-    ASSERT(dstMainPlaneRowSize <= dstMainPlaneStride);
-    ASSERT(height >= abs(videoFormat.bmi.biHeight));
-    const int dstMainPlaneSize = dstMainPlaneStride * height;
-    const int dstUVHeight = height / videoFormat.pixelFormat->subsampleHeightRatio;
-
-    BYTE *intermediateDstBufferBase = dstBuffer;
-    if (videoFormat.outputBufferTemporalFlags == 0b111) {
-        intermediateDstBufferBase = reinterpret_cast<BYTE *>(CoTaskMemAlloc(videoFormat.bmi.biSizeImage));
-    }
-    BYTE *dstMainPlane = intermediateDstBufferBase;
-
-    if (videoFormat.bmi.biCompression == BI_RGB && videoFormat.bmi.biHeight > 0) {
-        dstMainPlane += dstMainPlaneSize - dstMainPlaneStride;
-        dstMainPlaneStride = -dstMainPlaneStride;
-    }
-
-    if (videoFormat.pixelFormat->srcPlanesLayout != PlanesLayout::ALL_PLANES_INTERLEAVED) {
-        vsh::bitblt(dstMainPlane, dstMainPlaneStride, srcSlices[0], srcStrides[0], dstMainPlaneRowSize, height);
-    }
-
-    switch (videoFormat.pixelFormat->srcPlanesLayout) {
-    case PlanesLayout::ALL_PLANES_INTERLEAVED:
-        if (videoFormat.videoInfo.format.colorFamily == cfYUV) {
-            const std::array yuvaSlices { srcSlices[1], srcSlices[0], srcSlices[2] };
-            const std::array yuvaStrides { srcStrides[1], srcStrides[0], srcStrides[2] };
-
-            if (videoFormat.videoInfo.format.bitsPerSample == 10) {
-                InterleaveY410(yuvaSlices, yuvaStrides, dstMainPlane, dstMainPlaneStride / 2, dstMainPlaneRowSize / 2, height);
+            if (pixelFormat.componentsPerPixel == 3) {
+                plan.deinterleaveFunc = _deinterleaveRGB24Func;
+                plan.interleaveThreeFunc = _interleaveRGB24Func;
             } else {
-                _interleaveY416Func(yuvaSlices, yuvaStrides, dstMainPlane, dstMainPlaneStride, dstMainPlaneRowSize, height);
+                plan.deinterleaveFunc = _deinterleaveRGBC1Func;
+                plan.interleaveThreeFunc = _interleaveRGBC1Func;
             }
+        } else if (pixelFormat.componentsPerPixel == 3) {
+            plan.deinterleaveFunc = _deinterleaveRGB48Func;
+            plan.interleaveThreeFunc = _interleaveRGB48Func;
         } else {
-            _interleaveRGBC1Func(srcSlices, srcStrides, dstMainPlane, dstMainPlaneStride, dstMainPlaneRowSize, height);
+            // the 16-bit components of RGB64 are unpacked like Y416
+            plan.deinterleaveFunc = _deinterleaveY416Func;
+            plan.interleaveThreeFunc = _interleaveY416Func;
         }
-        break;
 
-    case PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED: {
-        BYTE *dstUVStart = dstMainPlane + dstMainPlaneSize;
-        const int dstUVStride = dstMainPlaneStride * 2 / videoFormat.pixelFormat->subsampleWidthRatio;
-        const int dstUVRowSize = dstMainPlaneRowSize * 2 / videoFormat.pixelFormat->subsampleWidthRatio;
+        plan.copyFromInputBandFunc = CopyFromInputBand<PlanesLayout::ALL_PLANES_INTERLEAVED>;
+        plan.copyToOutputBandFunc = CopyToOutputBand<PlanesLayout::ALL_PLANES_INTERLEAVED>;
+        break;
 
-        decltype(InterleaveUV<0, 1>) *interleaveUVFunc;
-        if (videoFormat.videoInfo.format.bytesPerSample == 1) {
-            interleaveUVFunc = _interleaveUVC1Func;
+    case PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED:
+        plan.secPlaneStride = plan.mainPlaneStride * 2 / pixelFormat.subsampleWidthRatio;
+        plan.secPlaneRowSize = plan.mainPlaneRowSize * 2 / pixelFormat.subsampleWidthRatio;
+        plan.secPlaneOffsets = { mainPlaneSize, 0 };
+
+        if (bytesPerSample == 1) {
+            plan.deinterleaveFunc = _deinterleaveUVC1Func;
+            plan.interleaveUVFunc = _interleaveUVC1Func;
+        } else if (isBitShiftNeeded) {
+            plan.deinterleaveFunc = _deinterleaveUVC2RightShiftFunc;
+            plan.interleaveUVFunc = _interleaveUVC2LeftShiftFunc;
         } else {
-            interleaveUVFunc = _interleaveUVC2Func;
+            plan.deinterleaveFunc = _deinterleaveUVC2Func;
+            plan.interleaveUVFunc = _interleaveUVC2Func;
         }
-        interleaveUVFunc(srcSlices[1], srcSlices[2], srcStrides[1], srcStrides[2], dstUVStart, dstUVStride, dstUVRowSize, dstUVHeight);
 
-        if (videoFormat.videoInfo.format.bitsPerSample == 10) {
-            _leftShiftFunc(dstMainPlane, dstBuffer, dstMainPlaneStride, dstMainPlaneRowSize, height + dstUVHeight);
-            if (videoFormat.outputBufferTemporalFlags == 0b111) {
-                CoTaskMemFree(intermediateDstBufferBase);
-            }
-        }
-    } break;
+        plan.copyFromInputBandFunc = CopyFromInputBand<PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED>;
+        plan.copyToOutputBandFunc = CopyToOutputBand<PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED>;
+        break;
 
     case PlanesLayout::ALL_PLANES_SEPARATE: {
-        const int dstUVStride = dstMainPlaneStride / videoFormat.pixelFormat->subsampleWidthRatio;
-        const int dstUVRowSize = dstMainPlaneRowSize / videoFormat.pixelFormat->subsampleWidthRatio;
-        BYTE *dstUVPlane1 = dstMainPlane + dstMainPlaneSize;
-        BYTE *dstUVPlane2 = dstUVPlane1 + dstMainPlaneSize / (videoFormat.pixelFormat->subsampleWidthRatio * videoFormat.pixelFormat->subsampleHeightRatio);
-
-        BYTE *dstU;
-        BYTE *dstV;
-        if (videoFormat.pixelFormat->mediaSubtype == MEDIASUBTYPE_YV12 || videoFormat.pixelFormat->mediaSubtype == MEDIASUBTYPE_YV24) {
-            dstU = dstUVPlane2;
-            dstV = dstUVPlane1;
+        plan.secPlaneStride = plan.mainPlaneStride / pixelFormat.subsampleWidthRatio;
+        plan.secPlaneRowSize = plan.mainPlaneRowSize / pixelFormat.subsampleWidthRatio;
+
+        const ptrdiff_t secPlane1Offset = mainPlaneSize;
+        const ptrdiff_t secPlane2Offset = secPlane1Offset + mainPlaneSize / (pixelFormat.subsampleWidthRatio * pixelFormat.subsampleHeightRatio);
+        if (pixelFormat.mediaSubtype == MEDIASUBTYPE_YV12 || pixelFormat.mediaSubtype == MEDIASUBTYPE_YV24) {
+            // YVxx has V plane first
+            plan.secPlaneOffsets = { secPlane2Offset, secPlane1Offset };
         } else {
-            dstU = dstUVPlane1;
-            dstV = dstUVPlane2;
+            plan.secPlaneOffsets = { secPlane1Offset, secPlane2Offset };
         }
+        plan.secPlaneCopyFunc = GetCopyPlaneFunc(plan.secPlaneStride * (plan.height / pixelFormat.subsampleHeightRatio));
 
-        vsh::bitblt(dstU, dstUVStride, srcSlices[1], srcStrides[1], dstUVRowSize, dstUVHeight);
-        vsh::bitblt(dstV, dstUVStride, srcSlices[2], srcStrides[2], dstUVRowSize, dstUVHeight);
+        plan.copyFromInputBandFunc = CopyFromInputBand<PlanesLayout::ALL_PLANES_SEPARATE>;
+        plan.copyToOutputBandFunc = CopyToOutputBand<PlanesLayout::ALL_PLANES_SEPARATE>;
     } break;
     }
+
+    return plan;
+}
+
+auto Format::CopyPlane(const BYTE *src, BYTE *dst, int srcStride, int dstStride, int rowSize, int height) -> void {
+    vsh::bitblt(dst, dstStride, src, srcStride, rowSize, height);
 }
 
 }
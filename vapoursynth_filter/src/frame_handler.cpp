@@ -11,50 +11,59 @@ namespace SynthFilter {
 auto FrameHandler::AddInputSample(IMediaSample *inputSample) -> HRESULT {
     HRESULT hr;
 
-    _addInputSampleCv.wait(_filter.m_csReceive, [this]() -> bool {
+    const std::chrono::steady_clock::time_point waitStartTime = std::chrono::steady_clock::now();
+    if (_lastInputSampleReturnTime.time_since_epoch().count() != 0) {
+        _sourceBufferController.RecordDecoderLatency(waitStartTime - _lastInputSampleReturnTime);
+    }
+
+    _sourceFrames.WaitUntil(_filter.m_csReceive, [this]() -> bool {
         if (_isFlushing) {
             return true;
         }
 
-        if (_nextSourceFrameNb <= Environment::GetInstance().GetInitialSrcBuffer()) {
+        if (GetNumInFlightSourceFrames() >= static_cast<int>(SOURCE_FRAME_RING_CAPACITY)) {
+            return false;
+        }
+
+        if (_nextSourceFrameNb - _firstSourceFrameNb <= Environment::GetInstance().GetInitialSrcBuffer()) {
             return true;
         }
 
         UpdateExtraSrcBuffer();
 
         // at least NUM_SRC_FRAMES_PER_PROCESSING source frames are needed in queue for stop time calculation
-        if (static_cast<int>(_sourceFrames.size()) < NUM_SRC_FRAMES_PER_PROCESSING + _extraSrcBuffer) {
+        if (GetNumInFlightSourceFrames() < NUM_SRC_FRAMES_PER_PROCESSING + _extraSrcBuffer) {
             return true;
         }
 
         return _nextSourceFrameNb <= _lastUsedSourceFrameNb + Environment::GetInstance().GetInitialSrcBuffer() + NUM_SRC_FRAMES_PER_PROCESSING;
     });
+    RecordStageLatency(PipelineStage::UpstreamWait, waitStartTime);
 
     if (_isFlushing || _isStopping) {
-        Environment::GetInstance().Log(L"Reject input sample due to flush or stop");
+        Environment::GetInstance().Log<LogLevel::Trace>(L"Reject input sample due to flush or stop");
         return S_FALSE;
     }
 
-    if ((_filter._isInputMediaTypeChanged || _filter._needReloadScript) && !ChangeOutputFormat()) {
-        return S_FALSE;
+    if (_filter._isInputMediaTypeChanged || _filter._needReloadScript) {
+        // the queued samples are converted with the current format and script
+        WaitForInputConversion();
+
+        if (!ChangeOutputFormat()) {
+            return S_FALSE;
+        }
     }
 
     REFERENCE_TIME inputSampleStartTime;
     REFERENCE_TIME inputSampleStopTime = 0;
     if (inputSample->GetTime(&inputSampleStartTime, &inputSampleStopTime) == VFW_E_SAMPLE_TIME_NOT_SET) {
         // for samples without start time, always treat as fixed frame rate
-        inputSampleStartTime = _nextSourceFrameNb * MainFrameServer::GetInstance().GetSourceAvgFrameDuration();
+        inputSampleStartTime = (_nextSourceFrameNb - _firstSourceFrameNb) * MainFrameServer::GetInstance().GetSourceAvgFrameDuration();
     }
 
-    {
-        const std::shared_lock sharedSourceLock(_sourceMutex);
-
-        // since the key of _sourceFrames is frame number, which only strictly increases, rbegin() returns the last emplaced frame
-        if (const REFERENCE_TIME lastSampleStartTime = _sourceFrames.empty() ? -1 : _sourceFrames.rbegin()->second.startTime;
-            inputSampleStartTime <= lastSampleStartTime) {
-            Environment::GetInstance().Log(L"Reject input sample due to start time going backward: curr %10lld last %10lld", inputSampleStartTime, lastSampleStartTime);
-            return S_FALSE;
-        }
+    if (inputSampleStartTime <= _lastInputSampleStartTime) {
+        Environment::GetInstance().Log<LogLevel::Error>(L"Reject input sample due to start time going backward: curr %10lld last %10lld", inputSampleStartTime, _lastInputSampleStartTime);
+        return S_FALSE;
     }
 
     RefreshInputFrameRates(_nextSourceFrameNb);
@@ -65,13 +74,41 @@ auto FrameHandler::AddInputSample(IMediaSample *inputSample) -> HRESULT {
         return S_FALSE;
     }
 
-    VSFrame *frame = Format::CreateFrame(_filter._inputVideoFormat, sampleBuffer);
+    {
+        const std::unique_lock inputQueueLock(_inputQueueMutex);
+
+        // the queue holds a reference to the sample, so that the upstream does not reuse its buffer until it is converted
+        _queuedInputSamples.emplace_back(inputSample,
+                                         sampleBuffer,
+                                         _nextSourceFrameNb,
+                                         inputSampleStartTime,
+                                         inputSampleStopTime,
+                                         _filter.m_pInput->SampleProps()->dwTypeSpecificFlags,
+                                         std::chrono::steady_clock::now());
+    }
+    _inputQueueCv.notify_all();
+
+    _lastInputSampleStartTime = inputSampleStartTime;
+    _nextSourceFrameNb += 1;
+    _lastInputSampleReturnTime = std::chrono::steady_clock::now();
+
+    return S_OK;
+}
+
+auto FrameHandler::ConvertInputSample(const QueuedInputSample &queuedSample) -> void {
+    Environment::GetInstance().TraceAsync("Conversion queue", queuedSample.frameNb, queuedSample.receiveTime);
+
+    const std::chrono::steady_clock::time_point createFrameStartTime = std::chrono::steady_clock::now();
+    VSFrame *frame = Format::CreateFrame(_filter._inputVideoFormat, queuedSample.buffer);
+    RecordStageLatency(PipelineStage::CreateFrame, createFrameStartTime);
+    Environment::GetInstance().TraceComplete("CreateFrame", queuedSample.frameNb, createFrameStartTime);
+
     VSMap *frameProps = AVSF_VPS_API->getFramePropertiesRW(frame);
 
-    AVSF_VPS_API->mapSetFloat(frameProps, FRAME_PROP_NAME_ABS_TIME, inputSampleStartTime / static_cast<double>(UNITS), maReplace);
+    AVSF_VPS_API->mapSetFloat(frameProps, FRAME_PROP_NAME_ABS_TIME, queuedSample.startTime / static_cast<double>(UNITS), maReplace);
     AVSF_VPS_API->mapSetInt(frameProps, "_SARNum", _filter._inputVideoFormat.pixelAspectRatioNum, maReplace);
     AVSF_VPS_API->mapSetInt(frameProps, "_SARDen", _filter._inputVideoFormat.pixelAspectRatioDen, maReplace);
-    AVSF_VPS_API->mapSetInt(frameProps, FRAME_PROP_NAME_SOURCE_FRAME_NB, _nextSourceFrameNb, maReplace);
+    AVSF_VPS_API->mapSetInt(frameProps, FRAME_PROP_NAME_SOURCE_FRAME_NB, queuedSample.frameNb, maReplace);
 
     if (const std::optional<int> &optColorRange = _filter._inputVideoFormat.colorSpaceInfo.colorRange) {
         AVSF_VPS_API->mapSetInt(frameProps, "_ColorRange", *optColorRange, maReplace);
@@ -80,22 +117,21 @@ auto FrameHandler::AddInputSample(IMediaSample *inputSample) -> HRESULT {
     AVSF_VPS_API->mapSetInt(frameProps, "_Matrix", _filter._inputVideoFormat.colorSpaceInfo.matrix, maReplace);
     AVSF_VPS_API->mapSetInt(frameProps, "_Transfer", _filter._inputVideoFormat.colorSpaceInfo.transfer, maReplace);
 
-    const DWORD typeSpecificFlags = _filter.m_pInput->SampleProps()->dwTypeSpecificFlags;
     const int rfpFieldBased = [&]() {
-        if (typeSpecificFlags & AM_VIDEO_FLAG_WEAVE) {
+        if (queuedSample.typeSpecificFlags & AM_VIDEO_FLAG_WEAVE) {
             return VSFieldBased::VSC_FIELD_PROGRESSIVE;
-        } else if (typeSpecificFlags & AM_VIDEO_FLAG_FIELD1FIRST) {
+        } else if (queuedSample.typeSpecificFlags & AM_VIDEO_FLAG_FIELD1FIRST) {
             return VSFieldBased::VSC_FIELD_TOP;
         } else {
             return VSFieldBased::VSC_FIELD_BOTTOM;
         }
     }();
     AVSF_VPS_API->mapSetInt(frameProps, FRAME_PROP_NAME_FIELD_BASED, rfpFieldBased, maReplace);
-    AVSF_VPS_API->mapSetInt(frameProps, FRAME_PROP_NAME_TYPE_SPECIFIC_FLAGS, typeSpecificFlags, maReplace);
+    AVSF_VPS_API->mapSetInt(frameProps, FRAME_PROP_NAME_TYPE_SPECIFIC_FLAGS, queuedSample.typeSpecificFlags, maReplace);
 
     std::unique_ptr<HDRSideData> hdrSideData = std::make_unique<HDRSideData>();
     {
-        if (const ATL::CComQIPtr<IMediaSideData> inputSampleSideData(inputSample); inputSampleSideData != nullptr) {
+        if (const ATL::CComQIPtr<IMediaSideData> inputSampleSideData(queuedSample.sample); inputSampleSideData != nullptr) {
             hdrSideData->ReadFrom(inputSampleSideData);
 
             if (const std::optional<const BYTE *> optHdr = hdrSideData->GetHDRData()) {
@@ -110,21 +146,16 @@ auto FrameHandler::AddInputSample(IMediaSample *inputSample) -> HRESULT {
         }
     }
 
-    {
-        const std::unique_lock uniqueSourceLock(_sourceMutex);
-
-        _sourceFrames.emplace(std::piecewise_construct,
-                              std::forward_as_tuple(_nextSourceFrameNb),
-                              std::forward_as_tuple(frame, inputSampleStartTime, std::move(hdrSideData)));
-        Environment::GetInstance().Log(L"Store source frame: %6d at %10lld ~ %10lld duration(literal) %10lld, last_used %6d, extra_buffer %6d",
-                                       _nextSourceFrameNb,
-                                       inputSampleStartTime,
-                                       inputSampleStopTime,
-                                       inputSampleStopTime - inputSampleStartTime,
-                                       _lastUsedSourceFrameNb.load(),
-                                       _extraSrcBuffer);
-
-        _nextSourceFrameNb += 1;
+    ASSERT(_sourceFrames.GetTailFrameNb() == queuedSample.frameNb);
+    _sourceFrames.Push(frame, queuedSample.startTime, std::move(hdrSideData));
+    if (Environment::GetInstance().IsLogEnabled<LogLevel::Trace>()) {
+        Environment::GetInstance().Log<LogLevel::Trace>(L"Store source frame: %6d at %10lld ~ %10lld duration(literal) %10lld, last_used %6d, extra_buffer %6d",
+                                                        queuedSample.frameNb,
+                                                        queuedSample.startTime,
+                                                        queuedSample.stopTime,
+                                                        queuedSample.stopTime - queuedSample.startTime,
+                                                        _lastUsedSourceFrameNb.load(),
+                                                        _extraSrcBuffer);
     }
 
     /*
@@ -132,41 +163,42 @@ auto FrameHandler::AddInputSample(IMediaSample *inputSample) -> HRESULT {
      * Therefore instead of directly using the stop time from the current sample, we use the start time of the next sample.
      */
 
-    // use map.lower_bound() in case the exact frame is removed by the script
-    std::array<decltype(_sourceFrames)::const_iterator, NUM_SRC_FRAMES_PER_PROCESSING> processSourceFrameIters { _sourceFrames.lower_bound(_nextProcessSourceFrameNb) };
-
-    {
-        const std::shared_lock sharedSourceLock(_sourceMutex);
-
-        for (int i = 0; i < NUM_SRC_FRAMES_PER_PROCESSING; ++i) {
-            if (processSourceFrameIters[i] == _sourceFrames.end()) {
-                return S_OK;
-            }
-
-            if (i < NUM_SRC_FRAMES_PER_PROCESSING - 1) {
-                processSourceFrameIters[i + 1] = processSourceFrameIters[i];
-                ++processSourceFrameIters[i + 1];
-            }
-        }
+    // start from the head in case the exact frame is already erased
+    // frames in the queue are consecutive, and the producer can access them since they are erased only after their durations are set
+    const int processSourceFrameNb = std::max(_nextProcessSourceFrameNb, _sourceFrames.GetHeadFrameNb());
+    if (processSourceFrameNb + NUM_SRC_FRAMES_PER_PROCESSING > _sourceFrames.GetTailFrameNb()) {
+        return;
     }
-    _nextProcessSourceFrameNb = processSourceFrameIters[1]->first;
+    _nextProcessSourceFrameNb = processSourceFrameNb + 1;
 
-    frameProps = AVSF_VPS_API->getFramePropertiesRW(processSourceFrameIters[0]->second.autoFrame.frame);
-    REFERENCE_TIME frameDurationNum = processSourceFrameIters[1]->second.startTime - processSourceFrameIters[0]->second.startTime;
+    const SourceFrameInfo &processSourceFrame = _sourceFrames.At(processSourceFrameNb);
+    const SourceFrameInfo &nextSourceFrame = _sourceFrames.At(processSourceFrameNb + 1);
+
+    frameProps = AVSF_VPS_API->getFramePropertiesRW(processSourceFrame.autoFrame.frame);
+    REFERENCE_TIME frameDurationNum = nextSourceFrame.startTime - processSourceFrame.startTime;
     REFERENCE_TIME frameDurationDen = UNITS;
     CoprimeIntegers(frameDurationNum, frameDurationDen);
     AVSF_VPS_API->mapSetInt(frameProps, FRAME_PROP_NAME_DURATION_NUM, frameDurationNum, maReplace);
     AVSF_VPS_API->mapSetInt(frameProps, FRAME_PROP_NAME_DURATION_DEN, frameDurationDen, maReplace);
-    _newSourceFrameCv.notify_all();
+    _sourceFrames.NotifyAll();
+
+    // delay requesting output frames until we have enough pre-buffered frames in store and the script is loaded in the background
+    if (queuedSample.frameNb + 1 - _firstSourceFrameNb < Environment::GetInstance().GetInitialSrcBuffer()) {
+        return;
+    }
+
+    _sourceFrames.WaitUntil([this]() -> bool {
+        return _isFlushing || _isScriptReady;
+    });
+    if (_isFlushing) {
+        return;
+    }
 
-    // delay activating the main frameserver until we have enough pre-buffered frames in store
-    if (_nextSourceFrameNb < Environment::GetInstance().GetInitialSrcBuffer()) {
-        return S_OK;
-    } else if (_nextSourceFrameNb == Environment::GetInstance().GetInitialSrcBuffer()) {
-        MainFrameServer::GetInstance().ReloadScript(_filter.m_pInput->CurrentMediaType(), true);
+    if (_isStandbyScriptReady) {
+        SwapScript(_nextOutputFrameNb);
     }
 
-    const int maxRequestOutputFrameNb = static_cast<int>(llMulDiv(processSourceFrameIters[0]->first,
+    const int maxRequestOutputFrameNb = static_cast<int>(llMulDiv(processSourceFrameNb,
                                                                   MainFrameServer::GetInstance().GetSourceAvgFrameDuration(),
                                                                   MainFrameServer::GetInstance().GetScriptAvgFrameDuration(),
                                                                   0));
@@ -178,43 +210,50 @@ auto FrameHandler::AddInputSample(IMediaSample *inputSample) -> HRESULT {
             const std::unique_lock uniqueOutputLock(_outputMutex);
 
             _outputFrames.emplace(_nextOutputFrameNb, nullptr);
+            _outputFrameRequestTimes.emplace(_nextOutputFrameNb, std::chrono::steady_clock::now());
         }
         AVSF_VPS_API->getFrameAsync(_nextOutputFrameNb, MainFrameServer::GetInstance().GetScriptClip(), VpsGetFrameCallback, this);
 
         _nextOutputFrameNb += 1;
     }
-
-    return S_OK;
 }
 
 auto FrameHandler::GetSourceFrame(int frameNb) -> const VSFrame * {
-    Environment::GetInstance().Log(L"Wait for source frame: frameNb %6d input queue size %2zd", frameNb, _sourceFrames.size());
+    if (Environment::GetInstance().IsLogEnabled<LogLevel::Trace>()) {
+        Environment::GetInstance().Log<LogLevel::Trace>(L"Wait for source frame: frameNb %6d input queue size %2d", frameNb, _sourceFrames.GetSize());
+    }
 
-    std::shared_lock sharedSourceLock(_sourceMutex);
+    _maxRequestedFrameNb = std::max(frameNb, _maxRequestedFrameNb.load());
 
-    decltype(_sourceFrames)::const_iterator iter;
-    _newSourceFrameCv.wait(sharedSourceLock, [this, &iter, frameNb]() -> bool {
+    const std::chrono::steady_clock::time_point waitStartTime = std::chrono::steady_clock::now();
+    const VSFrame *sourceFrame = nullptr;
+    _sourceFrames.WaitUntil([this, &sourceFrame, frameNb]() -> bool {
         if (_isFlushing) {
             return true;
         }
 
-        // use map.lower_bound() in case the exact frame is removed by the script
-        iter = _sourceFrames.lower_bound(frameNb);
-        if (iter == _sourceFrames.end()) {
-            return false;
-        }
+        // use lower bound in case the exact frame is removed by the script
+        // the reference is added while the frame is pinned, since the collector could erase it right after
+        return _sourceFrames.ReadLowerBound(frameNb, [&sourceFrame](int, const SourceFrameInfo &foundFrame) -> bool {
+            const VSMap *frameProps = AVSF_VPS_API->getFramePropertiesRO(foundFrame.autoFrame.frame);
+            if (AVSF_VPS_API->mapNumElements(frameProps, FRAME_PROP_NAME_DURATION_NUM) == 0 || AVSF_VPS_API->mapNumElements(frameProps, FRAME_PROP_NAME_DURATION_DEN) == 0) {
+                return false;
+            }
 
-        const VSMap *frameProps = AVSF_VPS_API->getFramePropertiesRO(iter->second.autoFrame.frame);
-        return AVSF_VPS_API->mapNumElements(frameProps, FRAME_PROP_NAME_DURATION_NUM) > 0 && AVSF_VPS_API->mapNumElements(frameProps, FRAME_PROP_NAME_DURATION_DEN) > 0;
+            sourceFrame = AVSF_VPS_API->addFrameRef(foundFrame.autoFrame.frame);
+            return true;
+        });
     });
+    Environment::GetInstance().TraceComplete("GetSourceFrame wait", frameNb, waitStartTime);
 
-    if (_isFlushing) {
-        Environment::GetInstance().Log(L"Drain for frame %6d", frameNb);
-        return FrameServerCommon::GetInstance().CreateSourceDummyFrame(MainFrameServer::GetInstance().GetVsCore());
+    // a frame found right before flushing is still returned, so that its reference is not leaked
+    if (sourceFrame == nullptr) {
+        Environment::GetInstance().Log<LogLevel::Trace>(L"Drain for frame %6d", frameNb);
+        return MainFrameServer::GetInstance().CreateSourceDummyFrame(MainFrameServer::GetInstance().GetVsCore());
     }
 
-    Environment::GetInstance().Log(L"Return source frame %6d", frameNb);
-    return AVSF_VPS_API->addFrameRef(iter->second.autoFrame.frame);
+    Environment::GetInstance().Log<LogLevel::Trace>(L"Return source frame %6d", frameNb);
+    return sourceFrame;
 }
 
 auto FrameHandler::BeginFlush() -> void {
@@ -226,10 +265,15 @@ auto FrameHandler::BeginFlush() -> void {
     _isFlushing.wait(true);
     _isFlushing = true;
 
-    _addInputSampleCv.notify_all();
-    _newSourceFrameCv.notify_all();
+    _sourceFrames.NotifyAll();
     _deliverSampleCv.notify_all();
 
+    {
+        // pairs with the predicate checks of the waiters, so that they either see the flag or receive the notification
+        const std::unique_lock inputQueueLock(_inputQueueMutex);
+    }
+    _inputQueueCv.notify_all();
+
     Environment::GetInstance().Log(L"FrameHandler finish BeginFlush()");
 }
 
@@ -246,8 +290,11 @@ auto FrameHandler::EndFlush() -> void {
         });
     }
     _outputFrames.clear();
+    _outputFrameRequestTimes.clear();
 
+    ResetFrameNumbers();
     ResetInput();
+    StartScriptLoad();
 
     _isFlushing = false;
     _isFlushing.notify_all();
@@ -256,19 +303,21 @@ auto FrameHandler::EndFlush() -> void {
 }
 
 auto VS_CC FrameHandler::VpsGetFrameCallback(void *userData, const VSFrame *f, int n, VSNode *node, const char *errorMsg) -> void {
+    Environment::GetInstance().TraceInstant("VpsGetFrameCallback", n);
+
     if (f == nullptr) {
-        Environment::GetInstance().Log(L"Fail to generate output frame %6d with message: %hs", n, errorMsg);
+        Environment::GetInstance().Log<LogLevel::Error>(L"Fail to generate output frame %6d with message: %hs", n, errorMsg);
         return;
     }
 
     FrameHandler *frameHandler = static_cast<FrameHandler *>(userData);
-    Environment::GetInstance().Log(L"Output frame %6d is ready, output queue size %2zd", n, frameHandler->_outputFrames.size());
 
     if (frameHandler->_isFlushing) {
         {
             const std::unique_lock uniqueOutputLock(frameHandler->_outputMutex);
 
             frameHandler->_outputFrames.erase(n);
+            frameHandler->_outputFrameRequestTimes.erase(n);
         }
         AVSF_VPS_API->freeFrame(f);
     } else {
@@ -276,6 +325,14 @@ auto VS_CC FrameHandler::VpsGetFrameCallback(void *userData, const VSFrame *f, i
             const std::unique_lock uniqueOutputLock(frameHandler->_outputMutex);
 
             frameHandler->_outputFrames[n] = const_cast<VSFrame *>(f);
+            if (const auto requestTimeNode = frameHandler->_outputFrameRequestTimes.extract(n)) {
+                frameHandler->RecordStageLatency(PipelineStage::GetFrame, requestTimeNode.mapped());
+                Environment::GetInstance().TraceAsync("GetFrame", n, requestTimeNode.mapped());
+            }
+
+            if (Environment::GetInstance().IsLogEnabled<LogLevel::Trace>()) {
+                Environment::GetInstance().Log<LogLevel::Trace>(L"Output frame %6d is ready, output queue size %2zd", n, frameHandler->_outputFrames.size());
+            }
         }
         frameHandler->_deliverSampleCv.notify_all();
     }
@@ -284,15 +341,24 @@ auto VS_CC FrameHandler::VpsGetFrameCallback(void *userData, const VSFrame *f, i
 }
 
 auto FrameHandler::ResetInput() -> void {
-    _sourceFrames.clear();
+    {
+        const std::unique_lock inputQueueLock(_inputQueueMutex);
 
-    _nextSourceFrameNb = 0;
-    _nextProcessSourceFrameNb = 0;
-    _nextOutputFrameNb = 0;
-    _lastUsedSourceFrameNb = 0;
+        _queuedInputSamples.clear();
+    }
+    _sourceFrames.Clear(_firstSourceFrameNb);
+
+    _nextSourceFrameNb = _firstSourceFrameNb;
+    _lastInputSampleStartTime = -1;
+    _lastInputSampleReturnTime = {};
+    _nextProcessSourceFrameNb = _firstSourceFrameNb;
+    _nextOutputFrameNb = _firstOutputFrameNb;
+    _lastUsedSourceFrameNb = _firstSourceFrameNb;
+    _maxRequestedFrameNb = _firstSourceFrameNb;
     _notifyChangedOutputMediaType = false;
+    _extraSrcBuffer = 0;
 
-    _frameRateCheckpointInputSampleNb = 0;
+    _frameRateCheckpointInputSampleNb = _firstSourceFrameNb;
     _currentInputFrameRate = 0;
 }
 
@@ -317,9 +383,13 @@ auto FrameHandler::PrepareOutputSample(ATL::CComPtr<IMediaSample> &outSample, in
     REFERENCE_TIME frameStopTime = frameStartTime + frameDuration;
     _nextOutputFrameStartTime = frameStopTime;
 
-    Environment::GetInstance().Log(L"Output frame: frameNb %6d startTime %10lld stopTime %10lld duration %10lld", outputFrameNb, frameStartTime, frameStopTime, frameDuration);
+    Environment::GetInstance().Log<LogLevel::Trace>(L"Output frame: frameNb %6d startTime %10lld stopTime %10lld duration %10lld", outputFrameNb, frameStartTime, frameStopTime, frameDuration);
+
+    const std::chrono::steady_clock::time_point getDeliveryBufferStartTime = std::chrono::steady_clock::now();
+    const HRESULT hr = _filter.m_pOutput->GetDeliveryBuffer(&outSample, &frameStartTime, &frameStopTime, 0);
+    RecordStageLatency(PipelineStage::GetDeliveryBuffer, getDeliveryBufferStartTime);
 
-    if (FAILED(_filter.m_pOutput->GetDeliveryBuffer(&outSample, &frameStartTime, &frameStopTime, 0))) {
+    if (FAILED(hr)) {
         // avoid releasing the invalid pointer in case the function change it to some random invalid address
         outSample.Detach();
         return false;
@@ -349,7 +419,7 @@ auto FrameHandler::PrepareOutputSample(ATL::CComPtr<IMediaSample> &outSample, in
         return false;
     }
 
-    if (outputFrameNb == 0 && FAILED(outSample->SetDiscontinuity(TRUE))) {
+    if (outputFrameNb == _firstOutputFrameNb && FAILED(outSample->SetDiscontinuity(TRUE))) {
         return false;
     }
 
@@ -358,12 +428,6 @@ auto FrameHandler::PrepareOutputSample(ATL::CComPtr<IMediaSample> &outSample, in
         return false;
     }
 
-    if ((_filter._outputVideoFormat.outputBufferTemporalFlags & 0b11) == 0b01) {
-        MEMORY_BASIC_INFORMATION dstBufferInfo;
-        VirtualQuery(outputBuffer, &dstBufferInfo, sizeof(dstBufferInfo));
-        _filter._outputVideoFormat.outputBufferTemporalFlags |= (((dstBufferInfo.Protect & PAGE_WRITECOMBINE) != 0) << 2) + 0b10;
-    }
-
     if (const ATL::CComQIPtr<IMediaSample2> outSample2(outSample); outSample2 != nullptr) {
         if (AM_SAMPLE2_PROPERTIES sampleProps; SUCCEEDED(outSample2->GetProperties(SAMPLE2_TYPE_SPECIFIC_FLAGS_SIZE, reinterpret_cast<BYTE *>(&sampleProps)))) {
             if (const int64_t rfpFieldBased = AVSF_VPS_API->mapGetInt(frameProps, FRAME_PROP_NAME_FIELD_BASED, 0, &propGetError);
@@ -384,13 +448,14 @@ auto FrameHandler::PrepareOutputSample(ATL::CComPtr<IMediaSample> &outSample, in
         }
     }
 
+    const std::chrono::steady_clock::time_point writeSampleStartTime = std::chrono::steady_clock::now();
     Format::WriteSample(_filter._outputVideoFormat, outputFrame, outputBuffer);
+    RecordStageLatency(PipelineStage::WriteSample, writeSampleStartTime);
+    Environment::GetInstance().TraceComplete("WriteSample", outputFrameNb, writeSampleStartTime);
 
-    const auto iter = _sourceFrames.find(sourceFrameNb);
-    ASSERT(iter != _sourceFrames.end());
-
+    // the worker is the only thread erasing source frames, and only does so after this
     if (const ATL::CComQIPtr<IMediaSideData> sideData(outSample); sideData != nullptr) {
-        iter->second.hdrSideData->WriteTo(sideData);
+        _sourceFrames.At(sourceFrameNb).hdrSideData->WriteTo(sideData);
     }
 
     RefreshOutputFrameRates(outputFrameNb);
@@ -401,11 +466,11 @@ auto FrameHandler::PrepareOutputSample(ATL::CComPtr<IMediaSample> &outSample, in
 auto FrameHandler::WorkerProc() -> void {
     const auto ResetOutput = [this]() -> void {
         _nextOutputFrameStartTime = 0;
-        _nextDeliveryFrameNb = 0;
+        _nextDeliveryFrameNb = _firstOutputFrameNb;
 
-        _frameRateCheckpointOutputFrameNb = 0;
+        _frameRateCheckpointOutputFrameNb = _firstOutputFrameNb;
         _currentOutputFrameRate = 0;
-        _frameRateCheckpointDeliveryFrameNb = 0;
+        _frameRateCheckpointDeliveryFrameNb = _firstOutputFrameNb;
         _currentDeliveryFrameRate = 0;
     };
 
@@ -459,13 +524,20 @@ auto FrameHandler::WorkerProc() -> void {
         const int sourceFrameNb = static_cast<int>(AVSF_VPS_API->mapGetInt(frameProps, FRAME_PROP_NAME_SOURCE_FRAME_NB, 0, &propGetError));
 
         _lastUsedSourceFrameNb = sourceFrameNb;
-        _addInputSampleCv.notify_all();
+        _sourceFrames.NotifyAll();
 
         if (ATL::CComPtr<IMediaSample> outSample; PrepareOutputSample(outSample, iter->first, iter->second.frame, sourceFrameNb)) {
-            _filter.m_pOutput->Deliver(outSample);
+            const std::chrono::steady_clock::time_point deliverStartTime = std::chrono::steady_clock::now();
+            _filter.DeliverOutputSample(outSample);
+            RecordStageLatency(PipelineStage::Deliver, deliverStartTime);
+            Environment::GetInstance().TraceComplete("Deliver", iter->first, deliverStartTime);
             RefreshDeliveryFrameRates(iter->first);
 
-            Environment::GetInstance().Log(L"Deliver output sample %6d from source frame %6d", iter->first, sourceFrameNb);
+            if (iter->first == _firstOutputFrameNb) {
+                RecordStageLatency(PipelineStage::FirstFrame, _streamStartTime);
+            }
+
+            Environment::GetInstance().Log<LogLevel::Trace>(L"Deliver output sample %6d from source frame %6d", iter->first, sourceFrameNb);
         }
 
         {
@@ -4,6 +4,9 @@
 
 #include "frameserver.h"
 #include "hdr.h"
+#include "latency_histogram.h"
+#include "source_buffer_controller.h"
+#include "source_frame_ring.h"
 
 
 namespace SynthFilter {
@@ -23,6 +26,10 @@ public:
     auto EndFlush() -> void;
     auto StartWorker() -> void;
     auto WaitForWorkerLatch() -> void;
+    auto WaitForScriptLoad() -> void;
+    auto StartScriptSwap(const std::filesystem::path &scriptPath) -> void;
+    auto CancelScriptSwap() -> void;
+    auto WaitForInputConversion() -> void;
     auto GetInputBufferSize() const -> int;
     constexpr auto GetSourceFrameNb() const -> int { return _nextSourceFrameNb; }
     constexpr auto GetOutputFrameNb() const -> int { return _nextOutputFrameNb; }
@@ -30,8 +37,19 @@ public:
     constexpr auto GetCurrentInputFrameRate() const -> int { return _currentInputFrameRate; }
     constexpr auto GetCurrentOutputFrameRate() const -> int { return _currentOutputFrameRate; }
     constexpr auto GetCurrentDeliveryFrameRate() const -> int { return _currentDeliveryFrameRate; }
+    auto GetStageLatency(PipelineStage stage) const -> LatencyHistogram::Summary;
 
 private:
+    struct QueuedInputSample {
+        ATL::CComPtr<IMediaSample> sample;
+        BYTE *buffer;
+        int frameNb;
+        REFERENCE_TIME startTime;
+        REFERENCE_TIME stopTime;
+        DWORD typeSpecificFlags;
+        std::chrono::steady_clock::time_point receiveTime;
+    };
+
     struct SourceFrameInfo {
         AutoReleaseVSFrame autoFrame;
         REFERENCE_TIME startTime;
@@ -41,45 +59,83 @@ private:
     static auto VS_CC VpsGetFrameCallback(void *userData, const VSFrame *f, int n, VSNode *node, const char *errorMsg) -> void;
     static auto RefreshFrameRatesTemplate(int sampleNb, int &checkpointSampleNb, std::chrono::steady_clock::time_point &checkpointTime, int &currentFrameRate) -> void;
 
+    auto ResetFrameNumbers() -> void;
     auto ResetInput() -> void;
+    auto ConvertInputSample(const QueuedInputSample &queuedSample) -> void;
+    auto ConversionProc() -> void;
+    auto StartScriptLoad() -> void;
+    auto ScriptLoadProc(CMediaType mediaType) -> void;
+    auto ScriptSwapProc(CMediaType mediaType, std::filesystem::path scriptPath) -> void;
+    auto SwapScript(int nextOutputFrameNb) -> void;
     auto PrepareOutputSample(ATL::CComPtr<IMediaSample> &outSample, int outputFrameNb, const VSFrame *outputFrame, int sourceFrameNb) -> bool;
     auto WorkerProc() -> void;
     auto GarbageCollect(int srcFrameNb) -> void;
     auto ChangeOutputFormat() -> bool;
     auto UpdateExtraSrcBuffer() -> void;
+    auto GetNumInFlightSourceFrames() const -> int;
     auto RefreshInputFrameRates(int frameNb) -> void;
     auto RefreshOutputFrameRates(int frameNb) -> void;
     auto RefreshDeliveryFrameRates(int frameNb) -> void;
+    auto RecordStageLatency(PipelineStage stage, std::chrono::steady_clock::time_point startTime) -> void;
 
     static constexpr const int NUM_SRC_FRAMES_PER_PROCESSING = 2;
 
     CSynthFilter &_filter;
 
-    std::map<int, SourceFrameInfo> _sourceFrames;
+    // received samples waiting for the conversion thread. The front one is removed after it is converted
+    std::deque<QueuedInputSample> _queuedInputSamples;
+    SourceFrameRing<SourceFrameInfo> _sourceFrames;
     std::map<int, AutoReleaseVSFrame> _outputFrames;
+    // when each pending output frame is requested from the script, guarded by _outputMutex
+    std::map<int, std::chrono::steady_clock::time_point> _outputFrameRequestTimes;
 
-    mutable std::shared_mutex _sourceMutex;
+    std::mutex _inputQueueMutex;
     std::shared_mutex _outputMutex;
 
-    std::condition_variable_any _addInputSampleCv;
-    std::condition_variable_any _newSourceFrameCv;
+    std::condition_variable _inputQueueCv;
     std::condition_variable_any _deliverSampleCv;
     std::condition_variable_any _flushOutputSampleCv;
 
+    // numbers of the first source and output frames since the last flush. Non-zero when the script is kept through the flush
+    int _firstSourceFrameNb = 0;
+    int _firstOutputFrameNb = 0;
     int _nextSourceFrameNb;
+    REFERENCE_TIME _lastInputSampleStartTime;
     int _nextProcessSourceFrameNb;
     int _nextOutputFrameNb;
     REFERENCE_TIME _nextOutputFrameStartTime;
     std::atomic<int> _lastUsedSourceFrameNb;
+    std::atomic<int> _maxRequestedFrameNb;
     bool _notifyChangedOutputMediaType;
     int _nextDeliveryFrameNb;
     int _extraSrcBuffer;
+    SourceBufferController _sourceBufferController;
+    // when the previous AddInputSample() returns to the upstream, for measuring how long the upstream takes to produce the next sample
+    std::chrono::steady_clock::time_point _lastInputSampleReturnTime;
+
+    // when the stream starts or the last flush ends, for measuring the time to the first output frame
+    std::chrono::steady_clock::time_point _streamStartTime;
 
+    std::thread _conversionThread;
     std::thread _workerThread;
+    std::thread _scriptLoadThread;
+    std::thread _scriptSwapThread;
+    std::mutex _scriptSwapMutex;
+
+    // the latest script requested while the swap thread is evaluating another one, picked up after that evaluation
+    std::optional<std::filesystem::path> _pendingScriptPath;
+    bool _isScriptSwapRunning = false;
+
+    // frameserver with the new script, waiting to replace the main one at the next frame boundary
+    std::unique_ptr<MainFrameServer> _standbyFrameServer;
+    std::mutex _standbyFrameServerMutex;
 
     std::atomic<bool> _isFlushing = false;
     std::atomic<bool> _isStopping = false;
+    std::atomic<bool> _isConversionLatched = false;
     std::atomic<bool> _isWorkerLatched = false;
+    std::atomic<bool> _isScriptReady = false;
+    std::atomic<bool> _isStandbyScriptReady = false;
 
     int _frameRateCheckpointInputSampleNb;
     std::chrono::steady_clock::time_point _frameRateCheckpointInputSampleTime;
@@ -90,6 +146,8 @@ private:
     int _currentInputFrameRate;
     int _currentOutputFrameRate;
     int _currentDeliveryFrameRate;
+
+    std::array<LatencyHistogram, NUM_PIPELINE_STAGES> _stageLatencies;
 };
 
 }
@@ -16,11 +16,12 @@ constexpr const char *VPS_VAR_NAME_DISCONNECT  = "VpsFilterDisconnect";
 constexpr const char *VPS_VAR_NAME_SOURCE_PATH = "VpsFilterSourcePath";
 
 auto VS_CC SourceGetFrame(int n, int activationReason, void *instanceData, void **frameData, VSFrameContext *frameCtx, VSCore *core, const VSAPI *vsapi) -> const VSFrame * {
-    const CSynthFilter *filter = reinterpret_cast<const CSynthFilter *>(instanceData);
+    // the dummy frame has the source format of the frameserver that owns the node, which may differ between concurrent probes
+    const FrameServerBase *frameServer = static_cast<const FrameServerBase *>(instanceData);
 
-    if (filter == nullptr) {
-        Environment::GetInstance().Log(L"Source frame %6d is requested without the frame handler being linked", n);
-        return FrameServerCommon::GetInstance().CreateSourceDummyFrame(core);
+    if (const CSynthFilter *filter = frameServer->GetLinkedFilter(); filter == nullptr) {
+        Environment::GetInstance().Log<LogLevel::Error>(L"Source frame %6d is requested without the frame handler being linked", n);
+        return frameServer->CreateSourceDummyFrame(core);
     } else {
         return filter->frameHandler->GetSourceFrame(n);
     }
@@ -84,7 +85,7 @@ FrameServerCommon::FrameServerCommon() {
         std::wstring errorMessageWide(sizeNeeded, 0);
         MultiByteToWideChar(CP_UTF8, 0, errorMessage.data(), static_cast<int>(errorMessage.size()), errorMessageWide.data(), sizeNeeded);
 
-        Environment::GetInstance().Log(errorMessageWide);
+        Environment::GetInstance().Log<LogLevel::Error>(L"%ls", errorMessageWide.c_str());
         MessageBoxW(nullptr, errorMessageWide.c_str(), FILTER_NAME_FULL, MB_ICONERROR);
 
         throw;
@@ -100,10 +101,6 @@ FrameServerCommon::FrameServerCommon() {
     Environment::GetInstance().Log(L"VapourSynth version: %hs", GetVersionString().data());
 }
 
-auto FrameServerCommon::CreateSourceDummyFrame(VSCore *core) const -> const VSFrame * {
-    return _vsApi->newVideoFrame(&_sourceVideoInfo.format, _sourceVideoInfo.width, _sourceVideoInfo.height, nullptr, core);
-}
-
 auto FrameServerBase::StopScript() -> void {
     if (_scriptClip != nullptr) {
         Environment::GetInstance().Log(L"Release script clip: %p", _scriptClip);
@@ -117,6 +114,10 @@ FrameServerBase::FrameServerBase() {
     _vsCore = AVSF_VPS_SCRIPT_API->getCore(_vsScript);
 }
 
+auto FrameServerBase::CreateSourceDummyFrame(VSCore *core) const -> const VSFrame * {
+    return AVSF_VPS_API->newVideoFrame(&_sourceVideoInfo.format, _sourceVideoInfo.width, _sourceVideoInfo.height, nullptr, core);
+}
+
 FrameServerBase::~FrameServerBase() {
     StopScript();
     AVSF_VPS_API->freeNode(_sourceClip);
@@ -126,13 +127,14 @@ FrameServerBase::~FrameServerBase() {
 /**
  * Create new script clip with specified media type.
  */
-auto FrameServerBase::ReloadScript(const AM_MEDIA_TYPE &mediaType, bool ignoreDisconnect, const CSynthFilter *filter) -> bool {
+auto FrameServerBase::ReloadScript(const AM_MEDIA_TYPE &mediaType, const std::filesystem::path &scriptPath, bool ignoreDisconnect, const CSynthFilter *filter) -> bool {
     StopScript();
     AVSF_VPS_API->freeNode(_sourceClip);
 
-    const VSVideoInfo &sourceVideoInfo = Format::GetVideoFormat(mediaType, this).videoInfo;
-    FrameServerCommon::GetInstance()._sourceVideoInfo = sourceVideoInfo;
-    _sourceClip = AVSF_VPS_API->createVideoFilter2("VpsFilter_Source", &sourceVideoInfo, SourceGetFrame, nullptr, fmParallel, nullptr, 0, const_cast<CSynthFilter *>(filter), GetVsCore());
+    // each frameserver has its own source node, so that scripts of different source formats can be evaluated concurrently
+    _sourceVideoInfo = Format::GetVideoFormat(mediaType, this).videoInfo;
+    _linkedFilter = filter;
+    _sourceClip = AVSF_VPS_API->createVideoFilter2("VpsFilter_Source", &_sourceVideoInfo, SourceGetFrame, nullptr, fmParallel, nullptr, 0, this, GetVsCore());
     AVSF_VPS_API->setCacheMode(_sourceClip, cmForceDisable);
 
     VSMap *sourceInputs = AVSF_VPS_API->createMap();
@@ -149,11 +151,10 @@ auto FrameServerBase::ReloadScript(const AM_MEDIA_TYPE &mediaType, bool ignoreDi
     AVSF_VPS_API->freeMap(sourceInputs);
 
     _errorString.clear();
+    _isDisconnectRequested = false;
 
-    bool toDisconnect = false;
-
-    if (!FrameServerCommon::GetInstance()._scriptPath.empty()) {
-        const std::string utf8Filename = ConvertWideToUtf8(FrameServerCommon::GetInstance()._scriptPath.native());
+    if (!scriptPath.empty()) {
+        const std::string utf8Filename = ConvertWideToUtf8(scriptPath.native());
 
         if (AVSF_VPS_SCRIPT_API->evaluateFile(_vsScript, utf8Filename.c_str()) == 0) {
             _scriptClip = AVSF_VPS_SCRIPT_API->getOutputNode(_vsScript, 0);
@@ -161,7 +162,7 @@ auto FrameServerBase::ReloadScript(const AM_MEDIA_TYPE &mediaType, bool ignoreDi
             VSMap *scriptOutputs = AVSF_VPS_API->createMap();
             AVSF_VPS_SCRIPT_API->getVariable(_vsScript, VPS_VAR_NAME_DISCONNECT, scriptOutputs);
             if (AVSF_VPS_API->mapNumElements(scriptOutputs, VPS_VAR_NAME_DISCONNECT) == 1) {
-                toDisconnect = AVSF_VPS_API->mapGetInt(scriptOutputs, VPS_VAR_NAME_DISCONNECT, 0, nullptr) != 0;
+                _isDisconnectRequested = AVSF_VPS_API->mapGetInt(scriptOutputs, VPS_VAR_NAME_DISCONNECT, 0, nullptr) != 0;
             }
             AVSF_VPS_API->freeMap(scriptOutputs);
         } else {
@@ -187,7 +188,7 @@ core.text.Text({}, r'''{}''').set_output()",
         }
     }
 
-    if (toDisconnect && !ignoreDisconnect) {
+    if (_isDisconnectRequested && !ignoreDisconnect) {
         return false;
     }
 
@@ -198,24 +199,44 @@ core.text.Text({}, r'''{}''').set_output()",
     return true;
 }
 
-auto MainFrameServer::ReloadScript(const AM_MEDIA_TYPE &mediaType, bool ignoreDisconnect) -> bool {
+auto MainFrameServer::ReloadScript(const AM_MEDIA_TYPE &mediaType, const std::filesystem::path &scriptPath, bool ignoreDisconnect) -> bool {
     Environment::GetInstance().Log(L"ReloadScript from main frameserver");
 
-    if (__super::ReloadScript(mediaType, ignoreDisconnect, _filter)) {
-        const VSVideoInfo &sourceVideoInfo = FrameServerCommon::GetInstance()._sourceVideoInfo;
-        _sourceAvgFrameRate = static_cast<int>(llMulDiv(sourceVideoInfo.fpsNum, FRAME_RATE_SCALE_FACTOR, sourceVideoInfo.fpsDen, 0));
-        _sourceAvgFrameDuration = llMulDiv(sourceVideoInfo.fpsDen, UNITS, sourceVideoInfo.fpsNum, 0);
+    if (__super::ReloadScript(mediaType, scriptPath, ignoreDisconnect, _filter)) {
+        _sourceAvgFrameRate = static_cast<int>(llMulDiv(_sourceVideoInfo.fpsNum, FRAME_RATE_SCALE_FACTOR, _sourceVideoInfo.fpsDen, 0));
+        _sourceAvgFrameDuration = llMulDiv(_sourceVideoInfo.fpsDen, UNITS, _sourceVideoInfo.fpsNum, 0);
         return true;
     }
 
     return false;
 }
 
+auto MainFrameServer::HasSameOutput(const MainFrameServer &other) const -> bool {
+    const VSVideoInfo *videoInfo = AVSF_VPS_API->getVideoInfo(_scriptClip);
+    const VSVideoInfo *otherVideoInfo = AVSF_VPS_API->getVideoInfo(other._scriptClip);
+
+    return videoInfo->width == otherVideoInfo->width
+        && videoInfo->height == otherVideoInfo->height
+        && videoInfo->format.colorFamily == otherVideoInfo->format.colorFamily
+        && videoInfo->format.sampleType == otherVideoInfo->format.sampleType
+        && videoInfo->format.bitsPerSample == otherVideoInfo->format.bitsPerSample
+        && videoInfo->format.subSamplingW == otherVideoInfo->format.subSamplingW
+        && videoInfo->format.subSamplingH == otherVideoInfo->format.subSamplingH
+        && _scriptAvgFrameDuration == other._scriptAvgFrameDuration;
+}
+
 auto AuxFrameServer::ReloadScript(const AM_MEDIA_TYPE &mediaType, bool ignoreDisconnect) -> bool {
     Environment::GetInstance().Log(L"ReloadScript from auxiliary frameserver");
 
-    if (__super::ReloadScript(mediaType, ignoreDisconnect, nullptr)) {
+    const std::filesystem::path scriptPath = FrameServerCommon::GetInstance().GetScriptPath();
+
+    if (LoadProbeResult(mediaType, scriptPath)) {
+        return true;
+    }
+
+    if (__super::ReloadScript(mediaType, scriptPath, ignoreDisconnect, nullptr)) {
         _scriptVideoInfo = *AVSF_VPS_API->getVideoInfo(_scriptClip);
+        SaveProbeResult(mediaType, scriptPath);
         StopScript();
         return true;
     }
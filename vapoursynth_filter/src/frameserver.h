@@ -35,19 +35,19 @@ public:
 
     DISABLE_COPYING(FrameServerCommon)
 
-    auto CreateSourceDummyFrame(VSCore *core) const -> const VSFrame *;
     auto SetScriptPath(const std::filesystem::path &scriptPath) -> void;
     constexpr auto GetVersionString() const -> std::string_view { return _versionString; }
-    constexpr auto GetScriptPath() const -> const std::filesystem::path & { return _scriptPath; }
+    auto GetScriptPath() const -> std::filesystem::path;
     constexpr auto GetVsApi() const -> const VSAPI * { return _vsApi; }
     constexpr auto GetVsScriptApi() const -> const VSSCRIPTAPI * { return _vsScriptApi; }
 
 private:
+    // set by the remote control and the property page while the streaming threads read it
     std::filesystem::path _scriptPath = Environment::GetInstance().GetScriptPath();
+    mutable std::mutex _scriptPathMutex;
     std::string _versionString;
     const VSAPI *_vsApi;
     const VSSCRIPTAPI *_vsScriptApi;
-    VSVideoInfo _sourceVideoInfo {};
 };
 
 #define AVSF_VPS_API        FrameServerCommon::GetInstance().GetVsApi()
@@ -58,6 +58,8 @@ class CSynthFilter;
 class FrameServerBase {
 public:
     constexpr auto GetVsCore() const -> VSCore * { return _vsCore; }
+    constexpr auto GetLinkedFilter() const -> const CSynthFilter * { return _linkedFilter; }
+    auto CreateSourceDummyFrame(VSCore *core) const -> const VSFrame *;
 
 protected:
     FrameServerBase();
@@ -65,15 +67,18 @@ protected:
 
     DISABLE_COPYING(FrameServerBase)
 
-    auto ReloadScript(const AM_MEDIA_TYPE &mediaType, bool ignoreDisconnect, const CSynthFilter *filter) -> bool;
+    auto ReloadScript(const AM_MEDIA_TYPE &mediaType, const std::filesystem::path &scriptPath, bool ignoreDisconnect, const CSynthFilter *filter) -> bool;
     auto StopScript() -> void;
 
     VSScript *_vsScript = nullptr;
     VSCore *_vsCore = nullptr;
     VSNode *_sourceClip = nullptr;
     VSNode *_scriptClip = nullptr;
+    VSVideoInfo _sourceVideoInfo {};
+    const CSynthFilter *_linkedFilter = nullptr;
     REFERENCE_TIME _scriptAvgFrameDuration = 0;
     std::string _errorString;
+    bool _isDisconnectRequested = false;
 };
 
 class MainFrameServer
@@ -82,9 +87,14 @@ class MainFrameServer
 public:
     CTOR_WITHOUT_COPYING(MainFrameServer)
 
-    auto ReloadScript(const AM_MEDIA_TYPE &mediaType, bool ignoreDisconnect) -> bool;
+    auto ReloadScript(const AM_MEDIA_TYPE &mediaType, const std::filesystem::path &scriptPath, bool ignoreDisconnect) -> bool;
     using FrameServerBase::StopScript;
+    constexpr auto IsScriptLoaded() const -> bool { return _scriptClip != nullptr; }
     constexpr auto LinkSynthFilter(const CSynthFilter *filter) -> void { _filter = filter; }
+    auto HasSameOutput(const MainFrameServer &other) const -> bool;
+    auto AdoptPredecessor(MainFrameServer *predecessor) -> void { _predecessor.reset(predecessor); }
+    auto ReleasePredecessor() -> void;
+    auto GetNumPredecessors() const -> int;
     constexpr auto GetScriptClip() const -> VSNode * { return _scriptClip; }
     constexpr auto GetSourceAvgFrameDuration() const -> REFERENCE_TIME { return _sourceAvgFrameDuration; }
     constexpr auto GetSourceAvgFrameRate() const -> int { return _sourceAvgFrameRate; }
@@ -95,6 +105,9 @@ private:
     REFERENCE_TIME _sourceAvgFrameDuration = 0;
     int _sourceAvgFrameRate = 0;
     const CSynthFilter *_filter = nullptr;
+
+    // the instance replaced by this one in a script swap, kept until this script is stopped, since its caches could hold the frames allocated by the replaced one
+    std::unique_ptr<MainFrameServer> _predecessor;
 };
 
 class AuxFrameServer
@@ -108,6 +121,17 @@ public:
     auto GetScriptPixelType() const -> uint32_t;
 
 private:
+    struct ProbeCacheEntry {
+        std::wstring slotName;
+        // the script path, its version and the source format that the result is valid for
+        std::wstring key;
+    };
+
+    static auto GetProbeCacheEntry(const AM_MEDIA_TYPE &mediaType, const std::filesystem::path &scriptPath) -> std::optional<ProbeCacheEntry>;
+
+    auto LoadProbeResult(const AM_MEDIA_TYPE &mediaType, const std::filesystem::path &scriptPath) -> bool;
+    auto SaveProbeResult(const AM_MEDIA_TYPE &mediaType, const std::filesystem::path &scriptPath) const -> void;
+
     VSVideoInfo _scriptVideoInfo;
 };
 